@@ -171,6 +171,16 @@ public:
   virtual void saveRetentionPeriodColor(int period) = 0;
   virtual int getRetentionPeriodColor() = 0;
 
+  // The maximum number of different bits in the perceptual hashes of the
+  // similar images. A negative value disables the similar images detection.
+  virtual void saveSimilarImageThreshold(int threshold) = 0;
+  virtual int getSimilarImageThreshold() = 0;
+
+  // The size in bytes of the text stored in a file instead of being sent to
+  // the UI whole. A non-positive value disables it.
+  virtual void saveLargeTextThreshold(int threshold) = 0;
+  virtual int getLargeTextThreshold() = 0;
+
   // Shortcuts.
 
   virtual void saveOpenAppShortcut(std::string shortcut) = 0;
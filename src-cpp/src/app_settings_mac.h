@@ -153,6 +153,12 @@ class AppSettingsMac : public AppSettings {
   void saveRetentionPeriodColor(int period) override;
   int getRetentionPeriodColor() override;
 
+  void saveSimilarImageThreshold(int threshold) override;
+  int getSimilarImageThreshold() override;
+
+  void saveLargeTextThreshold(int threshold) override;
+  int getLargeTextThreshold() override;
+
   // Shortcuts.
 
   void saveOpenAppShortcut(std::string shortcut) override;
@@ -51,6 +51,8 @@ NSString *prefRetentionPeriodFile = @"retention_period_file";
 NSString *prefRetentionPeriodLink = @"retention_period_link";
 NSString *prefRetentionPeriodEmail = @"retention_period_email";
 NSString *prefRetentionPeriodColor = @"retention_period_color";
+NSString *prefSimilarImageThreshold = @"similar_image_threshold";
+NSString *prefLargeTextThreshold = @"large_text_threshold";
 
 NSString *prefLastSystemBootTime = @"last_system_boot_time";
 NSString *prefLicenseKey = @"license_key";
@@ -1462,4 +1464,32 @@ int AppSettingsMac::getRetentionPeriodColor() {
     return [defaults integerForKey:prefRetentionPeriodColor];
   }
   return kRetentionPeriods.size() - 1;
-}
\ No newline at end of file
+}
+
+void AppSettingsMac::saveSimilarImageThreshold(int threshold) {
+  NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+  [defaults setInteger:threshold forKey:prefSimilarImageThreshold];
+  [defaults synchronize];
+}
+
+int AppSettingsMac::getSimilarImageThreshold() {
+  NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+  if ([defaults objectForKey:prefSimilarImageThreshold] != nil) {
+    return [defaults integerForKey:prefSimilarImageThreshold];
+  }
+  return -1;
+}
+
+void AppSettingsMac::saveLargeTextThreshold(int threshold) {
+  NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+  [defaults setInteger:threshold forKey:prefLargeTextThreshold];
+  [defaults synchronize];
+}
+
+int AppSettingsMac::getLargeTextThreshold() {
+  NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+  if ([defaults objectForKey:prefLargeTextThreshold] != nil) {
+    return [defaults integerForKey:prefLargeTextThreshold];
+  }
+  return 1024 * 1024;
+}
@@ -0,0 +1,287 @@
+#include "blob_store.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::string_view kBlobsDir = "blobs";
+constexpr std::string_view kRefsFileName = "refs";
+constexpr std::string_view kJournalFileName = "refs.journal";
+// The journal is compacted when it has more entries than both this number
+// and the referenced blobs, so a change costs an amortized constant time.
+constexpr uint64_t kMinJournalEntriesToCompact = 1024;
+
+bool isValidKey(std::string_view key) {
+  if (key.size() < 2) {
+    return false;
+  }
+  for (char c : key) {
+    bool valid = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                 c == '_' || c == '-';
+    if (!valid) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Reads the "# <generation> [lost]" header and the "<name> <count>" lines of
+// the refs or journal file. The later lines override the earlier ones and a
+// zero count stands for the released blob. The file without the header is
+// of the first generation. Returns false if the file cannot be read.
+bool readRefs(const std::string &path,
+              uint64_t &generation,
+              bool &lost,
+              std::unordered_map<std::string, uint32_t> &refs) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream stream(line);
+    if (line.starts_with('#')) {
+      std::string hash;
+      std::string flag;
+      stream >> hash >> generation >> flag;
+      lost = flag == "lost";
+      continue;
+    }
+    std::string name;
+    uint32_t count = 0;
+    if (stream >> name >> count && FileBlobStore::isBlobName(name)) {
+      refs[name] = count;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+FileBlobStore::FileBlobStore(std::string root_dir, std::string extension) :
+    root_dir_(std::move(root_dir)),
+    extension_(std::move(extension)) {}
+
+std::string FileBlobStore::find(std::string_view key) {
+  if (!isValidKey(key)) {
+    return "";
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto name = getBlobName(key);
+  std::error_code error;
+  if (refs_.contains(name) || fs::is_regular_file(getBlobPath(name), error)) {
+    return name;
+  }
+  return "";
+}
+
+std::string FileBlobStore::add(std::string_view key, std::string_view data) {
+  if (!isValidKey(key)) {
+    return "";
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  loadRefs();
+  auto name = getBlobName(key);
+  auto path = getBlobPath(name);
+  std::error_code error;
+  if (!fs::is_regular_file(path, error)) {
+    fs::create_directories(fs::path(path).parent_path(), error);
+    if (!writeFile(path, data)) {
+      return "";
+    }
+    // The blob might have been removed while its reference count was stored.
+    refs_.erase(name);
+  }
+  setRefs(name, refs_[name] + 1);
+  return name;
+}
+
+bool FileBlobStore::retain(const std::string &name) {
+  if (!isBlobName(name)) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  loadRefs();
+  std::error_code error;
+  if (!fs::is_regular_file(getBlobPath(name), error)) {
+    return false;
+  }
+  setRefs(name, refs_[name] + 1);
+  return true;
+}
+
+bool FileBlobStore::release(const std::string &name) {
+  if (!isBlobName(name)) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  loadRefs();
+  // A blob without the stored reference count has a single reference,
+  // unless the refs were lost and it might be used by several clips.
+  auto it = refs_.find(name);
+  if (it == refs_.end() && refs_lost_) {
+    return true;
+  }
+  uint32_t count = it != refs_.end() ? it->second - 1 : 0;
+  setRefs(name, count);
+  if (count == 0) {
+    std::error_code error;
+    fs::remove(getBlobPath(name), error);
+  }
+  return true;
+}
+
+bool FileBlobStore::replace(const std::string &name, std::string_view data) {
+  if (!isBlobName(name)) {
+    return false;
+  }
+  // The blob is removed with its last reference under the same lock, so
+  // a removed blob is never brought back.
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto path = getBlobPath(name);
+  std::error_code error;
+  if (!fs::is_regular_file(path, error)) {
+    return false;
+  }
+  return writeFile(path, data);
+}
+
+bool FileBlobStore::isBlobName(std::string_view name) {
+  // "blobs/<shard>/<file name>", where the shard is two characters long.
+  auto shard = kBlobsDir.size() + 1;
+  if (!name.starts_with(kBlobsDir) || name.size() <= shard + 3 ||
+      name[kBlobsDir.size()] != '/' || name[shard + 2] != '/') {
+    return false;
+  }
+  auto file_name = name.substr(shard + 3);
+  return file_name.find('/') == std::string_view::npos && file_name.find("..") == std::string_view::npos &&
+         name.find('\\') == std::string_view::npos;
+}
+
+std::string FileBlobStore::getBlobName(std::string_view key) const {
+  std::string name;
+  name.reserve(kBlobsDir.size() + key.size() + extension_.size() + 4);
+  name.append(kBlobsDir);
+  name.push_back('/');
+  name.append(key.substr(0, 2));
+  name.push_back('/');
+  name.append(key);
+  name.append(extension_);
+  return name;
+}
+
+std::string FileBlobStore::getBlobPath(const std::string &name) const {
+  return root_dir_ + "/" + name;
+}
+
+bool FileBlobStore::writeFile(const std::string &path, std::string_view data) {
+  // Write to a temporary file in the same directory and rename it, so that
+  // a partially written file never appears under the final name.
+  auto temp_path = path + ".tmp" + std::to_string(++temp_files_count_);
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      return false;
+    }
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    file.close();
+    if (!file) {
+      std::error_code error;
+      fs::remove(temp_path, error);
+      return false;
+    }
+  }
+  std::error_code error;
+  fs::rename(temp_path, path, error);
+  if (error) {
+    fs::remove(temp_path, error);
+    return false;
+  }
+  return true;
+}
+
+void FileBlobStore::loadRefs() {
+  if (refs_loaded_) {
+    return;
+  }
+  refs_loaded_ = true;
+  readRefs(getRefsPath(kRefsFileName), refs_generation_, refs_lost_, refs_);
+  uint64_t journal_generation = 0;
+  bool journal_lost = false;
+  std::unordered_map<std::string, uint32_t> journal_refs;
+  bool has_journal = readRefs(getRefsPath(kJournalFileName), journal_generation, journal_lost, journal_refs);
+  // The journal of an older generation is already in the refs file. The
+  // journal of a newer one means the refs file is missing or outdated, and
+  // a missing journal means its changes are lost, unless the refs file is
+  // of the first generation that had no journal.
+  bool lost = has_journal ? journal_generation > refs_generation_ : refs_generation_ > 0;
+  if (has_journal && journal_generation >= refs_generation_) {
+    for (const auto &[name, count] : journal_refs) {
+      if (count > 0) {
+        refs_[name] = count;
+      } else {
+        refs_.erase(name);
+      }
+    }
+    refs_lost_ = refs_lost_ || journal_lost;
+    journal_entries_ = journal_refs.size();
+  }
+  refs_generation_ = std::max(refs_generation_, journal_generation);
+  refs_lost_ = refs_lost_ || lost;
+  if (!has_journal || journal_generation != refs_generation_ || lost) {
+    compactRefs();
+  }
+}
+
+void FileBlobStore::setRefs(const std::string &name, uint32_t count) {
+  if (count > 0) {
+    refs_[name] = count;
+  } else {
+    refs_.erase(name);
+  }
+  if (++journal_entries_ > std::max<uint64_t>(kMinJournalEntriesToCompact, refs_.size()) &&
+      compactRefs()) {
+    return;
+  }
+  if (!journal_.is_open()) {
+    journal_.open(getRefsPath(kJournalFileName), std::ios::app);
+  }
+  journal_ << name << ' ' << count << '\n';
+  journal_.flush();
+}
+
+bool FileBlobStore::compactRefs() {
+  // The refs file of the next generation is written first, so the journal
+  // is either still used with the previous refs file or outdated.
+  ++refs_generation_;
+  std::string content = getRefsHeader();
+  for (const auto &[name, count] : refs_) {
+    content += name + " " + std::to_string(count) + "\n";
+  }
+  std::error_code error;
+  fs::create_directories(getRefsPath(""), error);
+  if (!writeFile(getRefsPath(kRefsFileName), content)) {
+    --refs_generation_;
+    return false;
+  }
+  journal_.close();
+  journal_.clear();
+  journal_.open(getRefsPath(kJournalFileName), std::ios::trunc);
+  journal_ << getRefsHeader();
+  journal_.flush();
+  journal_entries_ = 0;
+  return true;
+}
+
+std::string FileBlobStore::getRefsPath(std::string_view file_name) const {
+  return root_dir_ + "/" + std::string(kBlobsDir) + "/" + std::string(file_name);
+}
+
+std::string FileBlobStore::getRefsHeader() const {
+  return "# " + std::to_string(refs_generation_) + (refs_lost_ ? " lost" : "") + "\n";
+}
@@ -0,0 +1,104 @@
+#ifndef CLIPBOOK_BLOB_STORE_H_
+#define CLIPBOOK_BLOB_STORE_H_
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// A content-addressed storage of immutable blobs such as the clipboard
+// images. A blob is identified by a key derived from its content, so the
+// identical blobs are stored once and can be found without scanning the
+// storage. Every stored blob is reference counted and removed when the last
+// reference to it is released.
+class BlobStore {
+ public:
+  virtual ~BlobStore() = default;
+
+  /**
+   * Returns the name of the blob with the given key if it's stored or an
+   * empty string otherwise. The reference count is not changed.
+   */
+  virtual std::string find(std::string_view key) = 0;
+
+  /**
+   * Stores the data under the given key unless a blob with this key is
+   * already stored, adds a reference to the blob and returns its name.
+   * Returns an empty string if the data cannot be stored.
+   */
+  virtual std::string add(std::string_view key, std::string_view data) = 0;
+
+  /**
+   * Adds a reference to the blob with the given name.
+   */
+  virtual bool retain(const std::string &name) = 0;
+
+  /**
+   * Releases a reference to the blob with the given name and removes the
+   * blob when there are no references left. Returns false if the name does
+   * not belong to the store.
+   */
+  virtual bool release(const std::string &name) = 0;
+
+  /**
+   * Replaces the content of the blob with the given name with the data
+   * that has the same key, e.g. the image re-encoded without changing its
+   * pixels. Returns false if the blob has no references left.
+   */
+  virtual bool replace(const std::string &name, std::string_view data) = 0;
+};
+
+// Stores blobs as files in the sharded subdirectories of the given directory:
+//
+//   <root>/blobs/<first two characters of the key>/<key><extension>
+//
+// The blob names are relative to the root directory, e.g.
+// "blobs/3f/3fa1c07e9b2d4e15.png". A blob is written to a temporary file
+// and renamed, so a blob file is either complete or absent. The reference
+// counts are kept in the "blobs/refs" file and their changes are appended
+// to the "blobs/refs.journal" file, which is compacted into the refs file
+// once it outgrows it. When the refs are lost, the blobs without a stored
+// reference count are kept on release rather than removed while still used.
+class FileBlobStore : public BlobStore {
+ public:
+  FileBlobStore(std::string root_dir, std::string extension);
+
+  std::string find(std::string_view key) override;
+  std::string add(std::string_view key, std::string_view data) override;
+  bool retain(const std::string &name) override;
+  bool release(const std::string &name) override;
+  bool replace(const std::string &name, std::string_view data) override;
+
+  /**
+   * Indicates if the given name or path relative to the root directory
+   * belongs to the store.
+   */
+  static bool isBlobName(std::string_view name);
+
+ private:
+  [[nodiscard]] std::string getBlobName(std::string_view key) const;
+  [[nodiscard]] std::string getBlobPath(const std::string &name) const;
+  [[nodiscard]] std::string getRefsPath(std::string_view file_name) const;
+  [[nodiscard]] std::string getRefsHeader() const;
+  bool writeFile(const std::string &path, std::string_view data);
+  void loadRefs();
+  void setRefs(const std::string &name, uint32_t count);
+  bool compactRefs();
+
+ private:
+  const std::string root_dir_;
+  const std::string extension_;
+  std::unordered_map<std::string, uint32_t> refs_;
+  bool refs_loaded_ = false;
+  // The refs file and the journal of the same generation make up the refs.
+  uint64_t refs_generation_ = 0;
+  bool refs_lost_ = false;
+  std::ofstream journal_;
+  uint64_t journal_entries_ = 0;
+  uint64_t temp_files_count_ = 0;
+  std::mutex mutex_;
+};
+
+#endif  // CLIPBOOK_BLOB_STORE_H_
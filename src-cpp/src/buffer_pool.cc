@@ -0,0 +1,50 @@
+#include "buffer_pool.h"
+
+#include <utility>
+
+BufferPool::Buffer::Buffer(BufferPool *pool, std::unique_ptr<char[]> data)
+    : pool_(pool), data_(std::move(data)) {}
+
+BufferPool::Buffer::Buffer(Buffer &&other) noexcept
+    : pool_(other.pool_), data_(std::move(other.data_)) {}
+
+BufferPool::Buffer::~Buffer() {
+  if (data_) {
+    pool_->release(std::move(data_));
+  }
+}
+
+char *BufferPool::Buffer::data() const {
+  return data_.get();
+}
+
+std::size_t BufferPool::Buffer::size() const {
+  return pool_->bufferSize();
+}
+
+BufferPool::BufferPool(std::size_t buffer_size, std::size_t max_buffers)
+    : buffer_size_(buffer_size), max_buffers_(max_buffers) {}
+
+BufferPool::Buffer BufferPool::acquire() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!free_buffers_.empty()) {
+      auto data = std::move(free_buffers_.back());
+      free_buffers_.pop_back();
+      return {this, std::move(data)};
+    }
+  }
+  return {this, std::unique_ptr<char[]>(new char[buffer_size_])};
+}
+
+std::size_t BufferPool::bufferSize() const {
+  return buffer_size_;
+}
+
+void BufferPool::release(std::unique_ptr<char[]> data) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  // Drop the buffer if the pool is full to keep the memory usage bounded.
+  if (free_buffers_.size() < max_buffers_) {
+    free_buffers_.push_back(std::move(data));
+  }
+}
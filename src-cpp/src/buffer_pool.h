@@ -0,0 +1,47 @@
+#ifndef CLIPBOOK_BUFFER_POOL_H_
+#define CLIPBOOK_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// A thread-safe pool of fixed-size byte buffers. Buffers are returned to the
+// pool when the handle goes out of scope, so the peak memory used by the
+// pool is bounded by buffer_size * max_buffers plus the buffers in flight.
+class BufferPool {
+ public:
+  class Buffer {
+   public:
+    Buffer(BufferPool *pool, std::unique_ptr<char[]> data);
+    Buffer(Buffer &&other) noexcept;
+    Buffer(const Buffer &) = delete;
+    Buffer &operator=(const Buffer &) = delete;
+    ~Buffer();
+
+    [[nodiscard]] char *data() const;
+    [[nodiscard]] std::size_t size() const;
+
+   private:
+    BufferPool *pool_;
+    std::unique_ptr<char[]> data_;
+  };
+
+  BufferPool(std::size_t buffer_size, std::size_t max_buffers);
+
+  // Returns a free buffer from the pool or allocates a new one.
+  Buffer acquire();
+
+  [[nodiscard]] std::size_t bufferSize() const;
+
+ private:
+  void release(std::unique_ptr<char[]> data);
+
+ private:
+  const std::size_t buffer_size_;
+  const std::size_t max_buffers_;
+  std::vector<std::unique_ptr<char[]>> free_buffers_;
+  std::mutex mutex_;
+};
+
+#endif  // CLIPBOOK_BUFFER_POOL_H_
@@ -0,0 +1,248 @@
+#include "clip_log.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+#include "hash.h"
+#include "mapped_file.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'B', 'C', 'L', 'I', 'P', 'L', 'G'};
+constexpr uint32_t kVersion = 1;
+
+constexpr uint32_t kAddRecord = 1;
+constexpr uint32_t kAcknowledgeRecord = 2;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  char reserved[20];
+};
+
+// The record header is followed by the data and the checksum of both.
+struct RecordHeader {
+  uint32_t type;
+  uint32_t size;
+  uint64_t sequence;
+};
+
+static_assert(sizeof(Header) == 32);
+static_assert(sizeof(RecordHeader) == 16);
+
+Header makeHeader() {
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  return header;
+}
+
+uint64_t getRecordChecksum(const RecordHeader &header, std::string_view data) {
+  return hash64(data.data(), data.size(), hash64(&header, sizeof(header)));
+}
+
+bool writeAll(int fd, const void *data, std::size_t size) {
+  auto bytes = static_cast<const char *>(data);
+  while (size > 0) {
+    auto written = write(fd, bytes, size);
+    if (written <= 0) {
+      return false;
+    }
+    bytes += written;
+    size -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+
+// Writes the record with a single call, so the records appended by
+// different calls are never interleaved.
+bool writeRecord(int fd, uint32_t type, uint64_t sequence, std::string_view data) {
+  RecordHeader header{type, static_cast<uint32_t>(data.size()), sequence};
+  auto checksum = getRecordChecksum(header, data);
+  std::string record;
+  record.reserve(sizeof(header) + data.size() + sizeof(checksum));
+  record.append(reinterpret_cast<const char *>(&header), sizeof(header));
+  record.append(data);
+  record.append(reinterpret_cast<const char *>(&checksum), sizeof(checksum));
+  return writeAll(fd, record.data(), record.size());
+}
+
+}  // namespace
+
+ClipLog::ClipLog(std::string file_path) :
+    file_path_(std::move(file_path)) {}
+
+ClipLog::~ClipLog() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+uint64_t ClipLog::append(std::string_view data) {
+  if (data.size() > UINT32_MAX) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  load();
+  auto sequence = last_sequence_ + 1;
+  if (!appendRecord(kAddRecord, sequence, data)) {
+    return 0;
+  }
+  last_sequence_ = sequence;
+  pending_.push_back({sequence, std::string(data)});
+  return sequence;
+}
+
+std::vector<ClipLog::Entry> ClipLog::read(uint64_t after_sequence, std::size_t max_count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  load();
+  std::vector<Entry> entries;
+  auto it = std::upper_bound(pending_.begin(), pending_.end(), after_sequence,
+                             [](uint64_t sequence, const Entry &entry) {
+                               return sequence < entry.sequence;
+                             });
+  for (; it != pending_.end() && entries.size() < max_count; ++it) {
+    entries.push_back(*it);
+  }
+  return entries;
+}
+
+void ClipLog::acknowledge(uint64_t sequence) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  load();
+  if (pending_.empty() || pending_.front().sequence > sequence) {
+    return;
+  }
+  sequence = std::min(sequence, last_sequence_);
+  appendRecord(kAcknowledgeRecord, sequence, {});
+  while (!pending_.empty() && pending_.front().sequence <= sequence) {
+    pending_.pop_front();
+  }
+  if (records_count_ > 2 * pending_.size() + 64) {
+    compact();
+  }
+}
+
+std::size_t ClipLog::pendingCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  load();
+  return pending_.size();
+}
+
+void ClipLog::load() {
+  if (loaded_) {
+    return;
+  }
+  loaded_ = true;
+  std::error_code error;
+  if (!fs::exists(file_path_, error)) {
+    return;
+  }
+
+  std::size_t valid_size = 0;
+  std::size_t file_size = 0;
+  {
+    MappedFile file(file_path_);
+    file_size = file.size();
+    auto expected_header = makeHeader();
+    if (file.isValid() && file.size() >= sizeof(Header) &&
+        std::memcmp(file.data(), &expected_header, sizeof(Header)) == 0) {
+      valid_size = sizeof(Header);
+      while (valid_size + sizeof(RecordHeader) + sizeof(uint64_t) <= file.size()) {
+        RecordHeader header{};
+        std::memcpy(&header, file.data() + valid_size, sizeof(header));
+        auto data_offset = valid_size + sizeof(header);
+        if (header.size > file.size() - data_offset - sizeof(uint64_t)) {
+          break;
+        }
+        std::string_view data(file.data() + data_offset, header.size);
+        uint64_t checksum = 0;
+        std::memcpy(&checksum, file.data() + data_offset + header.size, sizeof(checksum));
+        if (checksum != getRecordChecksum(header, data)) {
+          break;
+        }
+        if (header.type == kAddRecord && header.sequence > last_sequence_) {
+          pending_.push_back({header.sequence, std::string(data)});
+          last_sequence_ = header.sequence;
+        } else if (header.type == kAcknowledgeRecord) {
+          while (!pending_.empty() && pending_.front().sequence <= header.sequence) {
+            pending_.pop_front();
+          }
+          last_sequence_ = std::max(last_sequence_, header.sequence);
+        }
+        valid_size = data_offset + header.size + sizeof(checksum);
+        records_count_++;
+      }
+    }
+  }
+  // Drop the torn record left by a crash or the file with a broken header.
+  if (valid_size == 0) {
+    fs::remove(file_path_, error);
+  } else if (valid_size != file_size) {
+    truncate(file_path_.c_str(), static_cast<off_t>(valid_size));
+  }
+  if (records_count_ > 2 * pending_.size() + 64) {
+    compact();
+  }
+}
+
+bool ClipLog::appendRecord(uint32_t type, uint64_t sequence, std::string_view data) {
+  if (fd_ < 0) {
+    fd_ = open(file_path_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd_ < 0) {
+      return false;
+    }
+    if (lseek(fd_, 0, SEEK_END) == 0) {
+      auto header = makeHeader();
+      if (!writeAll(fd_, &header, sizeof(header))) {
+        return false;
+      }
+    }
+  }
+  if (!writeRecord(fd_, type, sequence, data)) {
+    return false;
+  }
+  records_count_++;
+  return true;
+}
+
+bool ClipLog::compact() {
+  // Write the pending clips to a temporary file and replace the log with
+  // it, so a crash leaves either the old or the new log. The last sequence
+  // number is kept, so the numbers are never reused.
+  auto temp_path = file_path_ + ".tmp";
+  int fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  auto header = makeHeader();
+  bool success = writeAll(fd, &header, sizeof(header));
+  uint64_t acknowledged_sequence = pending_.empty() ? last_sequence_ : pending_.front().sequence - 1;
+  success = success && writeRecord(fd, kAcknowledgeRecord, acknowledged_sequence, {});
+  for (const auto &entry : pending_) {
+    success = success && writeRecord(fd, kAddRecord, entry.sequence, entry.data);
+  }
+  success = success && fsync(fd) == 0;
+  close(fd);
+  std::error_code error;
+  if (success) {
+    fs::rename(temp_path, file_path_, error);
+  }
+  if (!success || error) {
+    fs::remove(temp_path, error);
+    return false;
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+  records_count_ = pending_.size() + 1;
+  return true;
+}
@@ -0,0 +1,70 @@
+#ifndef CLIPBOOK_CLIP_LOG_H_
+#define CLIPBOOK_CLIP_LOG_H_
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A persistent queue of the captured clips and their later updates, e.g. the
+// text recognized in an image, waiting to be applied to the history by the
+// UI. The capture appends a clip and only notifies the UI, so it neither
+// waits for the UI nor loses the clips copied while the UI is not loaded or
+// busy. The UI reads the clips after the last one it has applied and
+// acknowledges them.
+//
+// The log is a file with a header followed by the variable-size records,
+// each with a checksum. A record either adds a clip with the next sequence
+// number or acknowledges all the clips up to a sequence number. The file
+// is read once, a torn record at the end left by a crash is truncated, and
+// the file is rewritten with the pending clips only when most of its
+// records are obsolete.
+class ClipLog {
+ public:
+  struct Entry {
+    uint64_t sequence = 0;
+    std::string data;
+  };
+
+  explicit ClipLog(std::string file_path);
+  ClipLog(const ClipLog &) = delete;
+  ClipLog &operator=(const ClipLog &) = delete;
+  ~ClipLog();
+
+  /**
+   * Appends the clip data and returns its sequence number or 0 if the data
+   * cannot be written.
+   */
+  uint64_t append(std::string_view data);
+
+  /**
+   * Returns up to max_count pending clips with the sequence numbers greater
+   * than the given one, from the oldest.
+   */
+  std::vector<Entry> read(uint64_t after_sequence, std::size_t max_count);
+
+  /**
+   * Marks the clips up to the given sequence number as added to the history.
+   */
+  void acknowledge(uint64_t sequence);
+
+  [[nodiscard]] std::size_t pendingCount();
+
+ private:
+  void load();
+  bool appendRecord(uint32_t type, uint64_t sequence, std::string_view data);
+  bool compact();
+
+ private:
+  const std::string file_path_;
+  std::deque<Entry> pending_;
+  uint64_t last_sequence_ = 0;
+  uint64_t records_count_ = 0;
+  bool loaded_ = false;
+  int fd_ = -1;
+  std::mutex mutex_;
+};
+
+#endif  // CLIPBOOK_CLIP_LOG_H_
@@ -3,7 +3,14 @@
 
 #include "main_app.h"
 
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <vector>
+
+#include "clipboard_source.h"
+#include "latency_histogram.h"
+#include "pipeline_stage.h"
 
 #ifdef __OBJC__
 #import <Cocoa/Cocoa.h>
@@ -33,6 +40,27 @@ struct ClipboardData {
   std::string rtf;
   ImageInfo image_info;
   std::vector<FilePathInfo> file_paths;
+  // The image as read from the clipboard, it's converted and stored by the
+  // persist stage.
+  std::string image_data;
+  bool image_data_tiff = false;
+  // The rich text flavors too large to be sent to the UI with the clip.
+  // They're stored by the persist stage and the UI gets their names.
+  std::string large_rtf;
+  std::string large_html;
+  std::string rtf_file_name;
+  std::string html_file_name;
+  // The name of the file with the whole text when the text is too large to
+  // be sent to the UI. The text is then cut to its beginning.
+  std::string text_file_name;
+  // The type of the whole text found by the text scanner: "link", "email",
+  // "color" or empty for a plain text.
+  std::string text_type;
+  // Indicates if the clip should be merged with the previous one.
+  bool merge = false;
+  // The work done once the clip is in the history, e.g. the text
+  // recognition, whose results are sent to the UI as updates of the clip.
+  std::vector<std::function<void()>> updates;
 };
 
 class ClipboardReaderMac {
@@ -43,29 +71,49 @@ class ClipboardReaderMac {
   void start(const std::shared_ptr<MainApp> &app);
   void copyToClipboardAfterMerge(std::string text);
 
+  /**
+   * Returns the latencies of the clipboard ingestion stages as a JSON object.
+   */
+  std::string getIngestionStats();
+
  private:
 #ifdef __OBJC__
   static std::string readPasteboard(NSPasteboardType type);
+  static void readRichText(NSPasteboardType type, std::string &text, std::string &large_text);
 #endif
-  static bool readTextData(const std::shared_ptr<ClipboardData> &data);
+  static bool readTextData(const std::shared_ptr<ClipboardData> &data, bool read_rich_text);
 
-  void readClipboardData();
+  // Returns false if the clipboard should be read again later.
+  bool readClipboardData();
   bool readClipboardData(const std::shared_ptr<ClipboardData> &data);
   bool readImageData(const std::shared_ptr<ClipboardData> &data);
+  bool storeImageData(const std::shared_ptr<ClipboardData> &data);
   bool readFilesData(const std::shared_ptr<ClipboardData> &data);
   void addClipboardData(const std::shared_ptr<ClipboardData>& data);
-  void mergeClipboardData(const std::shared_ptr<ClipboardData>& data);
+  static std::string getClipJson(const std::shared_ptr<ClipboardData> &data,
+                                 const std::string &content,
+                                 const FilePathInfo &file_path);
+  void persistClipboardData(const std::shared_ptr<ClipboardData> &data);
+  void publishClipboardData(const std::shared_ptr<ClipboardData> &data);
 
  private:
   std::shared_ptr<MainApp> app_;
-  std::shared_ptr<ClipboardData> data_;
   long last_change_count_ = 0;
   bool copy_and_merge_requested_ = false;
+  bool legacy_images_indexed_ = false;
+  std::unique_ptr<ClipboardWatcher> watcher_;
 #ifdef __OBJC__
   id monitor_ = nil;
   NSSound *sound_ = nil;
 #endif
   std::mutex mutex_;
+  // A clip is read from the pasteboard on the watcher thread, then its
+  // image is stored, then it's written to the clip log and the UI is
+  // notified, then the updates are made.
+  LatencyHistogram read_time_;
+  std::unique_ptr<PipelineStage> persist_stage_;
+  std::unique_ptr<PipelineStage> notify_stage_;
+  std::unique_ptr<PipelineStage> update_stage_;
 };
 
 #endif // CLIPBOOK_CLIPBOARD_READER_MAC_H_
@@ -5,35 +5,57 @@
 #import <QuickLookThumbnailing/QuickLookThumbnailing.h>
 #import <Vision/Vision.h>
 
+#include <algorithm>
+#include <climits>
 #include <filesystem>
 #include <fstream>
 #include <memory>
 #include <thread>
-
+#include <vector>
+
+#include "hash.h"
+#include "image_index.h"
+#include "perceptual_hash.h"
+#include "request_metrics.h"
+#include "rgba_image.h"
+#include "text_scanner.h"
+#include "thumbnail_pipeline.h"
+#include "url.h"
 #include "utils.h"
 
 namespace fs = std::filesystem;
 
-static int kCheckInterval = 500;
+// The clipboard is checked with this interval right after the user activity
+// and the interval grows up to the maximum while nothing is copied.
+static const auto kMinCheckInterval = std::chrono::milliseconds(100);
+static const auto kMaxCheckInterval = std::chrono::milliseconds(2000);
 static int kCopyToClipboardAfterMergeDelay = 500;
+static int kImageThumbSize = 48;
+static int kFileThumbSize = 48;
+static int kFilePreviewSize = 1024;
+// The rich text flavors larger than this are stored in files instead of
+// being sent to the UI with the clip.
+static const NSUInteger kMaxInlineRichTextSize = 256 * 1024;
+// The size of the beginning of a large text sent to the UI as its preview.
+static const std::size_t kLargeTextPreviewSize = 16 * 1024;
+// The number of clips waiting for each ingestion stage.
+static const std::size_t kIngestionQueueSize = 8;
 
 bool hasCustomClip(NSPasteboard *pasteboard) {
   return [pasteboard availableTypeFromArray:@[@"com.clipbook.data"]] != nil;
 }
 
-void extractTextFromImage(NSImage *image,
-                          const std::shared_ptr<MainApp> &app,
-                          const std::shared_ptr<ClipboardData> &data) {
-  // Convert NSImage to CGImage
-  CGImageRef cgImage = [image CGImageForProposedRect:nullptr context:nil hints:nil];
-  if (cgImage == nil) {
-    return;
+// Returns the text recognized in the image, one line per observation.
+std::string recognizeText(CGImageRef cgImage) {
+  if (cgImage == nullptr) {
+    return "";
   }
 
   // Create a VNImageRequestHandler with the CGImage
   VNImageRequestHandler *handler = [[VNImageRequestHandler alloc] initWithCGImage:cgImage options:@{}];
 
   // Create a text recognition request
+  __block std::string content;
   VNRecognizeTextRequest *textRequest = [[VNRecognizeTextRequest alloc] initWithCompletionHandler:^(
       VNRequest *request,
       NSError *_Nullable error) {
@@ -42,7 +64,6 @@ void extractTextFromImage(NSImage *image,
     }
 
     // Process the text recognition results
-    std::string content;
     NSArray *observations = request.results;
     for (VNRecognizedTextObservation *observation in observations) {
       VNRecognizedText *recognizedText = [[observation topCandidates:1] firstObject];
@@ -57,12 +78,6 @@ void extractTextFromImage(NSImage *image,
         }
       }
     }
-
-    if (content.empty()) {
-      return;
-    }
-
-    data->image_info.text = content;
   }];
 
   // Perform the request
@@ -72,37 +87,29 @@ void extractTextFromImage(NSImage *image,
   // Clean up.
   [textRequest release];
   [handler release];
-  CGImageRelease(cgImage);
+  return content;
 }
 
-NSImage *createThumbnail(NSImage *image, int width, int height) {
-  // Get the original image dimensions
-  NSSize originalSize = [image size];
-
-  // Calculate the scale factor to maintain the aspect ratio
-  CGFloat widthRatio = width / originalSize.width;
-  CGFloat heightRatio = height / originalSize.height;
-  CGFloat scaleFactor = MIN(widthRatio, heightRatio);
-
-  // Calculate the new size, maintaining aspect ratio
-  NSSize newSize = NSMakeSize(originalSize.width * scaleFactor, originalSize.height * scaleFactor);
-
-  // Create a new NSImage with the calculated size
-  NSImage *thumbnail = [[NSImage alloc] initWithSize:newSize];
-
-  // Start drawing the original image into the new size
-  [thumbnail lockFocus];
-  [image setSize:newSize];
-
-  // Draw the scaled-down image in the new context
-  [image drawAtPoint:NSZeroPoint
-            fromRect:NSMakeRect(0, 0, originalSize.width, originalSize.height)
-           operation:NSCompositingOperationSourceOver
-            fraction:1.0];
-
-  [thumbnail unlockFocus];
-
-  return thumbnail;
+// Recognizes the text in the image and writes it to the clip log after the
+// clip with the given image file name or file path. The UI attaches it to
+// the clip when it reads the log, even if it was not loaded at the time.
+void sendImageText(const std::shared_ptr<MainApp> &app, CGImageRef cgImage, const std::string &name) {
+  auto text = recognizeText(cgImage);
+  if (text.empty()) {
+    return;
+  }
+  auto record = "{\"update\":\"imageText\",\"fileName\":" + toJsonString(name) +
+                ",\"text\":" + toJsonString(text) + "}";
+  if (app->clipLog()->append(record) == 0) {
+    return;
+  }
+  auto image_index = app->imageIndex();
+  ImageMetadata metadata;
+  if (image_index->getMetadata(name, metadata)) {
+    metadata.has_text = true;
+    image_index->update(metadata);
+  }
+  app->notifyClipsAvailable();
 }
 
 std::vector<fs::path> findImages(const fs::path &dir,
@@ -134,87 +141,107 @@ std::string getThumbImageFileName(const std::string &imageFileName) {
   return thumbFileName;
 }
 
-bool findIdenticalImage(NSImage *srcImage,
-                        const fs::path &imagesDir,
-                        const std::shared_ptr<ClipboardData> &data) {
-  @autoreleasepool {
+// Computes the hash of the decoded image pixels, so the same image encoded
+// differently has the same hash. The image dimensions are returned as well.
+bool getImageHash(NSImage *image, uint64_t &hash, int &width, int &height) {
+  CGImageRef cgImage = [image CGImageForProposedRect:nullptr context:nil hints:nil];
+  if (cgImage == nil) {
+    return false;
+  }
+  CFDataRef pixels = CGDataProviderCopyData(CGImageGetDataProvider(cgImage));
+  if (pixels == nullptr) {
+    return false;
+  }
+  width = static_cast<int>(CGImageGetWidth(cgImage));
+  height = static_cast<int>(CGImageGetHeight(cgImage));
+  // The images with the same pixel bytes but different dimensions differ.
+  uint64_t seed = (static_cast<uint64_t>(width) << 32) | static_cast<uint32_t>(height);
+  hash = hash64(CFDataGetBytePtr(pixels), CFDataGetLength(pixels), seed);
+  CFRelease(pixels);
+  return true;
+}
 
-    CGImageRef srcCGImage = [srcImage CGImageForProposedRect:nullptr context:nil hints:nil];
-    size_t srcWidth = CGImageGetWidth(srcCGImage);
-    size_t srcHeight = CGImageGetHeight(srcCGImage);
-
-    auto images = findImages(imagesDir, "image_", "image_thumb_", ".png");
-    for (const auto &image_path : images) {
-      // Get file name without extension.
-      auto image_info_path = image_path.string().replace(
-          image_path.string().find(".png"), 4, ".info");
-      bool file_exists = fs::exists(image_info_path);
-      if (file_exists) {
-        std::ifstream input_file(image_info_path);
-        if (input_file.is_open()) {
-          std::string line;
-          int width = 0;
-          int height = 0;
-          int size_in_bytes = 0;
-          while (std::getline(input_file, line)) {
-            if (line.find("width: ") == 0) {
-              width = std::stoi(line.substr(7));
-            } else if (line.find("height: ") == 0) {
-              height = std::stoi(line.substr(8));
-            }
-          }
-          input_file.close();
+// Computes the perceptual hash of the image. The image is drawn into a small
+// grayscale buffer first, so the hash is computed without decoding the
+// full-size pixels once again.
+uint64_t getImagePerceptualHash(NSImage *image) {
+  CGImageRef cgImage = [image CGImageForProposedRect:nullptr context:nil hints:nil];
+  if (cgImage == nil) {
+    return 0;
+  }
+  size_t width = CGImageGetWidth(cgImage);
+  size_t height = CGImageGetHeight(cgImage);
+  double scale = std::min(1.0, 256.0 / static_cast<double>(std::max(width, height)));
+  size_t scaled_width = std::max<size_t>(1, static_cast<size_t>(width * scale));
+  size_t scaled_height = std::max<size_t>(1, static_cast<size_t>(height * scale));
+  std::vector<uint8_t> pixels(scaled_width * scaled_height);
+  CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceGray();
+  CGContextRef context = CGBitmapContextCreate(pixels.data(), scaled_width, scaled_height, 8,
+                                               scaled_width, colorSpace, kCGImageAlphaNone);
+  CGColorSpaceRelease(colorSpace);
+  if (context == nullptr) {
+    return 0;
+  }
+  CGContextSetInterpolationQuality(context, kCGInterpolationMedium);
+  CGContextDrawImage(context, CGRectMake(0, 0, scaled_width, scaled_height), cgImage);
+  CGContextRelease(context);
+  return computeDifferenceHash(pixels.data(), static_cast<int>(scaled_width),
+                               static_cast<int>(scaled_height), scaled_width);
+}
 
-          if (width != data->image_info.width || height != data->image_info.height) {
-            continue;
-          }
-        }
-      }
+// Returns the name of the thumbnail of the given stored image.
+std::string getThumbFileName(const std::string &imageFileName) {
+  if (FileBlobStore::isBlobName(imageFileName)) {
+    auto thumbFileName = imageFileName;
+    thumbFileName.insert(thumbFileName.rfind('.'), "_thumb");
+    return thumbFileName;
+  }
+  return getThumbImageFileName(imageFileName);
+}
 
-      // Compare image pixels.
+// Adds the legacy "image_*.png" images that are not in the index yet. The
+// images are decoded once, after that only their names are listed.
+void indexLegacyImages(const fs::path &imagesDir, const std::shared_ptr<ImageIndex> &index) {
+  auto images = findImages(imagesDir, "image_", "image_thumb_", ".png");
+  for (const auto &image_path : images) {
+    auto file_name = image_path.filename().string();
+    if (index->contains(file_name)) {
+      continue;
+    }
+    @autoreleasepool {
       auto imagePath = [NSString stringWithUTF8String:image_path.c_str()];
-      NSImage *dstImage = [[NSImage alloc] initWithContentsOfFile:imagePath];
-      CGImageRef dstCGImage = [dstImage CGImageForProposedRect:nullptr context:nil hints:nil];
-
-      size_t dstWidth = CGImageGetWidth(dstCGImage);
-      size_t dstHeight = CGImageGetHeight(dstCGImage);
-
-      if (!file_exists) {
-        const NSSize &dstImageSize = [dstImage size];
-        // Create image info file for old images.
-        std::string text_to_write =
-            "width: " + std::to_string(static_cast<int>(dstImageSize.width)) + "\n" +
-            "height: " + std::to_string(static_cast<int>(dstImageSize.height)) + "\n";
-        std::ofstream output_file(image_info_path);
-        if (output_file.is_open()) {
-          output_file << text_to_write;
-          output_file.close();
-        }
-      }
-
-      if (srcWidth != dstWidth || srcHeight != dstHeight) {
-        continue;
-      }
-
-      CFDataRef data1 = CGDataProviderCopyData(CGImageGetDataProvider(srcCGImage));
-      CFDataRef data2 = CGDataProviderCopyData(CGImageGetDataProvider(dstCGImage));
-
-      BOOL identical = CFDataGetLength(data1) == CFDataGetLength(data2) &&
-                       memcmp(CFDataGetBytePtr(data1),
-                              CFDataGetBytePtr(data2),
-                              CFDataGetLength(data1)) == 0;
-
-      CFRelease(data1);
-      CFRelease(data2);
-
-      if (identical) {
-        data->image_info.file_name = image_path.filename().string();
-        data->image_info.thumb_file_name = getThumbImageFileName(data->image_info.file_name);
-        return true;
+      NSImage *image = [[NSImage alloc] initWithContentsOfFile:imagePath];
+      ImageMetadata metadata;
+      if (image && getImageHash(image, metadata.hash, metadata.width, metadata.height)) {
+        std::error_code error;
+        metadata.file_name = file_name;
+        metadata.thumb_file_name = getThumbImageFileName(file_name);
+        metadata.size_in_bytes = fs::file_size(image_path, error);
+        metadata.perceptual_hash = getImagePerceptualHash(image);
+        metadata.hashed = true;
+        index->add(metadata);
       }
     }
   }
-  return false;
+}
+
+bool findIdenticalImage(uint64_t hash,
+                        int width,
+                        int height,
+                        const fs::path &imagesDir,
+                        const std::shared_ptr<ImageIndex> &index,
+                        const std::shared_ptr<ClipboardData> &data) {
+  auto file_name = index->find(hash, width, height);
+  if (file_name.empty()) {
+    return false;
+  }
+  if (!fs::exists(imagesDir / file_name)) {
+    index->remove(file_name);
+    return false;
+  }
+  data->image_info.file_name = file_name;
+  data->image_info.thumb_file_name = getThumbImageFileName(file_name);
+  return true;
 }
 
 NSImage *getThumbnailForFile(NSString *filePath, CGSize maxSize) {
@@ -264,19 +291,180 @@ NSString *getHashForPath(NSString *filePath) {
   return hashedString;
 }
 
+// Draws the image into a premultiplied RGBA buffer of its size in pixels.
+RgbaImage getRgbaImage(CGImageRef cgImage) {
+  RgbaImage result;
+  if (cgImage == nullptr) {
+    return result;
+  }
+  result.width = static_cast<int>(CGImageGetWidth(cgImage));
+  result.height = static_cast<int>(CGImageGetHeight(cgImage));
+  result.premultiplied = true;
+  result.pixels.resize(static_cast<size_t>(result.width) * result.height * 4);
+  CGColorSpaceRef colorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+  CGContextRef context = CGBitmapContextCreate(result.pixels.data(), result.width, result.height, 8,
+                                               static_cast<size_t>(result.width) * 4, colorSpace,
+                                               kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big);
+  CGColorSpaceRelease(colorSpace);
+  if (context == nullptr) {
+    return {};
+  }
+  CGContextDrawImage(context, CGRectMake(0, 0, result.width, result.height), cgImage);
+  CGContextRelease(context);
+  return result;
+}
+
+// Writes the file next to its destination and renames it, so the file is
+// never served half-written.
+bool writeImageFile(const fs::path &path, const std::string &data) {
+  auto temp_path = path;
+  temp_path += ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+      return false;
+    }
+  }
+  std::error_code error;
+  fs::rename(temp_path, path, error);
+  return !error;
+}
+
+// Returns the size of a thumbnail in pixels for the given size in points.
+int getThumbnailSizeInPixels(int size) {
+  return static_cast<int>(size * [NSScreen mainScreen].backingScaleFactor);
+}
+
+// Generates the thumbnail and the downscaled copies of a new image in the
+// background and adds them to the store. The UI is notified with the name
+// of the thumbnail or of the image whose copy is ready.
+void generateImageThumbnails(const std::shared_ptr<MainApp> &app,
+                             NSImage *image,
+                             const std::string &image_name,
+                             const std::string &image_key) {
+  CGImageRef cgImage = [image CGImageForProposedRect:nullptr context:nil hints:nil];
+  if (cgImage == nil) {
+    return;
+  }
+  auto store = [app, image_key](const std::string &key, const std::string &notify_name) {
+    return [app, image_key, key, notify_name](const std::string &png) {
+      auto image_store = app->imageStore();
+      // The image might have been deleted while its thumbnail was waiting.
+      if (png.empty() || image_store->find(image_key).empty()) {
+        return;
+      }
+      if (!image_store->add(key, png).empty()) {
+        app->notifyThumbnailReady(notify_name);
+      }
+    };
+  };
+  std::vector<ThumbnailPipeline::Output> outputs;
+  auto thumb_size = getThumbnailSizeInPixels(kImageThumbSize);
+  outputs.push_back({thumb_size, thumb_size, store(image_key + "_thumb", getThumbFileName(image_name))});
+  // The copies are only useful for the images wider than the level.
+  auto width = static_cast<int>(CGImageGetWidth(cgImage));
+  for (int level : kImagePyramidLevels) {
+    if (width > level) {
+      outputs.push_back({level, INT_MAX, store(getImageLevelFileName(image_key, level), image_name)});
+    }
+  }
+  // The decoded image is kept alive until the worker draws it.
+  std::shared_ptr<CGImage> source(CGImageRetain(cgImage), CGImageRelease);
+  app->thumbnailPipeline()->enqueue([source]() { return getRgbaImage(source.get()); }, std::move(outputs));
+}
+
+// Generates the preview and the thumbnail of a copied file in the
+// background. Both are produced from a single Quick Look thumbnail.
+void generateFileThumbnails(const std::shared_ptr<MainApp> &app,
+                            const std::string &file_path,
+                            const fs::path &images_dir,
+                            const std::string &preview_file_name,
+                            const std::string &thumb_file_name) {
+  auto onDone = [app, images_dir](const std::string &file_name) {
+    return [app, images_dir, file_name](const std::string &png) {
+      if (!png.empty() && writeImageFile(images_dir / file_name, png)) {
+        app->notifyThumbnailReady(file_name);
+      }
+    };
+  };
+  auto preview_size = getThumbnailSizeInPixels(kFilePreviewSize);
+  auto thumb_size = getThumbnailSizeInPixels(kFileThumbSize);
+  app->thumbnailPipeline()->enqueue(
+      [file_path]() {
+        @autoreleasepool {
+          NSString *path = [NSString stringWithUTF8String:file_path.c_str()];
+          NSImage *preview = getThumbnailForFile(path, CGSizeMake(kFilePreviewSize, kFilePreviewSize));
+          if (preview == nil) {
+            return RgbaImage();
+          }
+          auto result = getRgbaImage([preview CGImageForProposedRect:nullptr context:nil hints:nil]);
+          [preview release];
+          return result;
+        }
+      },
+      {{preview_size, preview_size, onDone(preview_file_name)},
+       {thumb_size, thumb_size, onDone(thumb_file_name)}});
+}
+
+// Stores the text in the text store and returns its name or an empty
+// string on failure. The text is converted to UTF-8 unless it's UTF-8
+// already.
+std::string storeText(const std::shared_ptr<BlobStore> &store, const std::string &text, const char *flavor) {
+  @autoreleasepool {
+    std::string utf8_text;
+    NSString *string = [[[NSString alloc] initWithBytesNoCopy:const_cast<char *>(text.data())
+                                                       length:text.size()
+                                                     encoding:NSUTF8StringEncoding
+                                                 freeWhenDone:NO] autorelease];
+    if (string == nil) {
+      string = [[[NSString alloc] initWithBytes:text.data()
+                                         length:text.size()
+                                       encoding:NSUnicodeStringEncoding] autorelease];
+      const char *chars = [string UTF8String];
+      if (chars == nullptr) {
+        return "";
+      }
+      utf8_text = chars;
+    }
+    std::string_view content = utf8_text.empty() ? std::string_view(text) : std::string_view(utf8_text);
+    // The text already stored gets another reference for the new clip,
+    // which the UI releases if the clip turns out to be a copy of an item.
+    return store->add(hashToHex(hash64(content)) + flavor, content);
+  }
+}
+
 static CFAbsoluteTime lastTapTime = 0;
 
-ClipboardReaderMac::ClipboardReaderMac() = default;
+// The general pasteboard. macOS does not notify about the pasteboard
+// changes, so it's polled.
+class PasteboardClipboardSource : public ClipboardSource {
+ public:
+  long changeCount() override {
+    @autoreleasepool {
+      return [[NSPasteboard generalPasteboard] changeCount];
+    }
+  }
+};
+
+ClipboardReaderMac::ClipboardReaderMac() :
+    // The clips read from the pasteboard are stored and written to the log
+    // before the app quits, the updates of the clips in the log are not.
+    persist_stage_(std::make_unique<PipelineStage>("persist", kIngestionQueueSize, true)),
+    notify_stage_(std::make_unique<PipelineStage>("notify", kIngestionQueueSize, true)),
+    update_stage_(std::make_unique<PipelineStage>("update", kIngestionQueueSize)) {}
 
 ClipboardReaderMac::~ClipboardReaderMac() {
+  watcher_.reset();
+  // The stages are stopped in order, so a running or drained task never
+  // posts to a stage that is already destroyed.
+  persist_stage_.reset();
+  notify_stage_.reset();
+  update_stage_.reset();
   if (monitor_ != nil) {
     [NSEvent removeMonitor:monitor_];
   }
 }
 
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "EndlessLoop"
-
 void ClipboardReaderMac::start(const std::shared_ptr<MainApp> &app) {
   app_ = app;
 
@@ -287,7 +475,24 @@ void ClipboardReaderMac::start(const std::shared_ptr<MainApp> &app) {
   // Initialize the last change count on start to ignore the initial clipboard content.
   last_change_count_ = [[NSPasteboard generalPasteboard] changeCount];
 
-  monitor_ = [NSEvent addGlobalMonitorForEventsMatchingMask:NSEventMaskKeyDown handler:^(NSEvent *event) {
+  watcher_ = std::make_unique<ClipboardWatcher>(
+      std::make_shared<PasteboardClipboardSource>(),
+      PollSchedule(kMinCheckInterval, kMaxCheckInterval),
+      [this]() {
+        @autoreleasepool {
+          return readClipboardData();
+        }
+      });
+
+  monitor_ = [NSEvent addGlobalMonitorForEventsMatchingMask:NSEventMaskKeyDown | NSEventMaskLeftMouseUp
+                                                    handler:^(NSEvent *event) {
+    // A shortcut or a click on a menu item might copy something.
+    if ([event type] == NSEventTypeLeftMouseUp || ([event modifierFlags] & NSEventModifierFlagCommand)) {
+      watcher_->notifyActivity();
+    }
+    if ([event type] != NSEventTypeKeyDown) {
+      return;
+    }
     if (!app_->settings()->isCopyAndMergeEnabled() || app_->isPaused()) {
       return;
     }
@@ -301,17 +506,9 @@ void ClipboardReaderMac::start(const std::shared_ptr<MainApp> &app) {
     }
   }];
 
-  std::thread t([this]() {
-    while (true) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(kCheckInterval));
-      readClipboardData();
-    }
-  });
-  t.detach();
+  watcher_->start();
 }
 
-#pragma clang diagnostic pop
-
 void ClipboardReaderMac::copyToClipboardAfterMerge(std::string text) {
   std::thread t([this, text]() {
     do {
@@ -322,7 +519,8 @@ void ClipboardReaderMac::copyToClipboardAfterMerge(std::string text) {
     [pasteboard clearContents];
     NSString *string = [NSString stringWithUTF8String:text.c_str()];
     [pasteboard setString:string forType:NSPasteboardTypeString];
-    readClipboardData(data_);
+    // The merged text is read only to skip it, it's already in the history.
+    readClipboardData(std::make_shared<ClipboardData>());
   });
   t.detach();
 }
@@ -332,104 +530,159 @@ void ClipboardReaderMac::addClipboardData(const std::shared_ptr<ClipboardData> &
     [sound_ play];
   }
 
-  auto frame = app_->browser()->mainFrame();
-  auto window = frame->executeJavaScript("window");
+  // The clips are written to the log and the UI reads them when it's ready,
+  // so a busy or not loaded UI does not delay the capture.
+  auto clip_log = app_->clipLog();
   if (data->file_paths.empty()) {
-    window.asJsObject()->call("addClipboardData",
-                              data->text,
-                              data->active_app_info.path,
-                              data->image_info.file_name,
-                              data->image_info.thumb_file_name,
-                              data->image_info.width,
-                              data->image_info.height,
-                              data->image_info.size_in_bytes,
-                              data->image_info.text,
-                              "",
-                              "",
-                              "",
-                              0,
-                              false,
-                              data->rtf,
-                              data->html);
+    clip_log->append(getClipJson(data, data->text, FilePathInfo()));
   } else {
     for (const auto &file_path : data->file_paths) {
-      window.asJsObject()->call("addClipboardData",
-                                file_path.file_path,
-                                data->active_app_info.path,
-                                data->image_info.file_name,
-                                data->image_info.thumb_file_name,
-                                data->image_info.width,
-                                data->image_info.height,
-                                data->image_info.size_in_bytes,
-                                data->image_info.text,
-                                file_path.file_path,
-                                file_path.file_preview_name,
-                                file_path.file_thumb_name,
-                                file_path.size_in_bytes,
-                                file_path.folder,
-                                "",
-                                "");
-    }
-  }
-}
-
-void ClipboardReaderMac::mergeClipboardData(const std::shared_ptr<ClipboardData> &data) {
-  if (app_->settings()->shouldPlaySoundOnCopy()) {
-    [sound_ play];
+      // The merged clip is the text, the added one is the file path.
+      clip_log->append(getClipJson(data, data->merge ? data->text : file_path.file_path, file_path));
+    }
   }
-  auto frame = app_->browser()->mainFrame();
-  auto window = frame->executeJavaScript("window");
-  if (data->file_paths.empty()) {
-    window.asJsObject()->call("mergeClipboardData",
-                              data->text,
-                              data->active_app_info.path,
-                              data->image_info.file_name,
-                              data->image_info.thumb_file_name,
-                              data->image_info.width,
-                              data->image_info.height,
-                              data->image_info.size_in_bytes,
-                              data->image_info.text,
-                              "", "", "", 0, false);
-  } else {
-    for (const auto &file_path : data->file_paths) {
-      window.asJsObject()->call("mergeClipboardData",
-                                data->text,
-                                data->active_app_info.path,
-                                data->image_info.file_name,
-                                data->image_info.thumb_file_name,
-                                data->image_info.width,
-                                data->image_info.height,
-                                data->image_info.size_in_bytes,
-                                data->image_info.text,
-                                file_path.file_path,
-                                file_path.file_preview_name,
-                                file_path.file_thumb_name,
-                                file_path.size_in_bytes,
-                                file_path.folder);
+  app_->notifyClipsAvailable();
+}
+
+// Returns the type of the whole text as the UI names it: "link", "email",
+// "color" or an empty string for a plain text. Only the web links are
+// links in the UI.
+std::string getClipTextType(const std::string &text) {
+  TextSpanType type;
+  if (!getTextType(text, type)) {
+    return "";
+  }
+  switch (type) {
+    case TextSpanType::kLink: {
+      std::string scheme(URL(text).scheme());
+      std::transform(scheme.begin(), scheme.end(), scheme.begin(), ::tolower);
+      return scheme == "http" || scheme == "https" ? "link" : "";
     }
+    case TextSpanType::kEmail:
+      return "email";
+    case TextSpanType::kColor:
+      return "color";
   }
+  return "";
 }
 
-void ClipboardReaderMac::readClipboardData() {
+std::string ClipboardReaderMac::getClipJson(const std::shared_ptr<ClipboardData> &data,
+                                            const std::string &content,
+                                            const FilePathInfo &file_path) {
+  // The rich text is only added with a text or an image clip.
+  bool rich_text = !data->merge && data->file_paths.empty();
+  return "{\"merge\":" + std::string(data->merge ? "true" : "false") +
+         ",\"content\":" + toJsonString(content) +
+         ",\"sourceAppPath\":" + toJsonString(data->active_app_info.path) +
+         ",\"imageFileName\":" + toJsonString(data->image_info.file_name) +
+         ",\"imageThumbFileName\":" + toJsonString(data->image_info.thumb_file_name) +
+         ",\"imageWidth\":" + std::to_string(data->image_info.width) +
+         ",\"imageHeight\":" + std::to_string(data->image_info.height) +
+         ",\"imageSizeInBytes\":" + std::to_string(data->image_info.size_in_bytes) +
+         ",\"imageText\":" + toJsonString(data->image_info.text) +
+         ",\"filePath\":" + toJsonString(file_path.file_path) +
+         ",\"filePathFileName\":" + toJsonString(file_path.file_preview_name) +
+         ",\"filePathThumbFileName\":" + toJsonString(file_path.file_thumb_name) +
+         ",\"fileSizeInBytes\":" + std::to_string(file_path.size_in_bytes) +
+         ",\"isFolder\":" + std::string(file_path.folder ? "true" : "false") +
+         ",\"rtf\":" + toJsonString(rich_text ? data->rtf : "") +
+         ",\"html\":" + toJsonString(rich_text ? data->html : "") +
+         ",\"rtfFileName\":" + toJsonString(rich_text ? data->rtf_file_name : "") +
+         ",\"htmlFileName\":" + toJsonString(rich_text ? data->html_file_name : "") +
+         ",\"textFileName\":" + toJsonString(data->text_file_name) +
+         ",\"textType\":" + toJsonString(data->text_type) + "}";
+}
+
+bool ClipboardReaderMac::readClipboardData() {
   // Let the user press Command+C second time and do not read the clipboard
   // if the time since the last Command+C is less than 0.5 seconds.
   if (app_->settings()->isCopyAndMergeEnabled()) {
     CFAbsoluteTime currentTime = CFAbsoluteTimeGetCurrent();
     if (currentTime - lastTapTime < 0.5) {
-      return;
+      return false;
     }
   }
-  std::lock_guard<std::mutex> guard(mutex_);
+  auto start_time = std::chrono::steady_clock::now();
   std::shared_ptr<ClipboardData> data = std::make_shared<ClipboardData>();
-  if (readClipboardData(data)) {
-    data_ = data;
-    if (copy_and_merge_requested_) {
-      mergeClipboardData(data);
-    } else {
-      addClipboardData(data);
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    bool has_data = readClipboardData(data);
+    data->merge = copy_and_merge_requested_;
+    copy_and_merge_requested_ = false;
+    if (!has_data) {
+      return true;
+    }
+  }
+  read_time_.record(std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start_time));
+  // Only the pasteboard is read on this thread. The image is stored and the
+  // clip is sent to the UI on the stage threads, so the next copy is not
+  // delayed by the previous one.
+  persist_stage_->post([this, data]() {
+    @autoreleasepool {
+      persistClipboardData(data);
+    }
+  });
+  return true;
+}
+
+void ClipboardReaderMac::persistClipboardData(const std::shared_ptr<ClipboardData> &data) {
+  bool has_image = !data->image_data.empty() && storeImageData(data);
+  data->image_data.clear();
+  data->image_data.shrink_to_fit();
+  // The merged clips do not keep the rich text.
+  if (!data->merge && !data->large_rtf.empty()) {
+    data->rtf_file_name = storeText(app_->textStore(), data->large_rtf, "_rtf");
+  }
+  if (!data->merge && !data->large_html.empty()) {
+    data->html_file_name = storeText(app_->textStore(), data->large_html, "_html");
+  }
+  // The text is classified as a whole, the UI might only get its beginning.
+  if (!data->merge && data->file_paths.empty() && !data->text.empty()) {
+    data->text_type = getClipTextType(data->text);
+  }
+  // The large text is stored as a whole and only its beginning is sent to
+  // the UI, which reads the rest when the clip is pasted, copied or opened.
+  // The merged clips keep the whole text, the UI appends it to another clip.
+  auto large_text_threshold = app_->settings()->getLargeTextThreshold();
+  if (!data->merge && data->file_paths.empty() && large_text_threshold > 0 &&
+      data->text.size() > std::max<std::size_t>(large_text_threshold, kLargeTextPreviewSize)) {
+    data->text_file_name = storeText(app_->textStore(), data->text, "_text");
+    if (!data->text_file_name.empty()) {
+      data->text = truncateUtf8(data->text, kLargeTextPreviewSize);
+    }
+  }
+  data->large_rtf.clear();
+  data->large_rtf.shrink_to_fit();
+  data->large_html.clear();
+  data->large_html.shrink_to_fit();
+  if (!has_image && data->text.empty() && data->file_paths.empty()) {
+    return;
+  }
+  notify_stage_->post([this, data]() {
+    @autoreleasepool {
+      publishClipboardData(data);
     }
+  });
+}
+
+void ClipboardReaderMac::publishClipboardData(const std::shared_ptr<ClipboardData> &data) {
+  addClipboardData(data);
+  // The slow parts, e.g. the text recognition, are sent as the updates of
+  // the clip that is already in the log.
+  for (auto &update : data->updates) {
+    update_stage_->post(std::move(update));
   }
-  copy_and_merge_requested_ = false;
+  data->updates.clear();
+}
+
+std::string ClipboardReaderMac::getIngestionStats() {
+  std::string result = "{\"read\":{\"runUs\":" + latencyToJson(read_time_) + "}";
+  for (auto *stage : {persist_stage_.get(), notify_stage_.get(), update_stage_.get()}) {
+    result += ",\"" + stage->name() + "\":" + stage->toJson();
+  }
+  result += "}";
+  return result;
 }
 
 bool ClipboardReaderMac::readImageData(const std::shared_ptr<ClipboardData> &data) {
@@ -439,81 +692,133 @@ bool ClipboardReaderMac::readImageData(const std::shared_ptr<ClipboardData> &dat
   if ([types containsObject:NSPasteboardTypeFileURL]) {
     return false;
   }
-  // Read image content in the PNG and TIFF formats.
+  // Read image content in the PNG and TIFF formats. The data is only copied
+  // here, it's converted and stored by the persist stage.
   if ([types containsObject:NSPasteboardTypePNG] || [types containsObject:NSPasteboardTypeTIFF]) {
-    // Make sure the images directory exists.
-    fs::path imagesDir = app_->getImagesDir();
-    if (!fs::exists(imagesDir)) {
-      fs::create_directories(imagesDir);
-    }
-
     @autoreleasepool {
-      // Get image info.
-      NSData *png_data = nil;
+      NSData *image_data = nil;
       if ([types containsObject:NSPasteboardTypePNG]) {
-        png_data = [pasteboard dataForType:NSPasteboardTypePNG];
+        image_data = [pasteboard dataForType:NSPasteboardTypePNG];
       }
-      // Check if the PNG data is not available, then try to get the TIFF data
-      // and convert it to PNG. In some applications (e.g., Lightshot), the PNG data
-      // might be empty for NSPasteboardTypePNG, so we need to handle this case
-      // using the TIFF data.
-      if (!png_data && [types containsObject:NSPasteboardTypeTIFF]) {
-        NSData *tiff_data = [pasteboard dataForType:NSPasteboardTypeTIFF];
-        NSBitmapImageRep *image_rep = [NSBitmapImageRep imageRepWithData:tiff_data];
-        if (image_rep) {
-          png_data = [image_rep representationUsingType:NSBitmapImageFileTypePNG properties:@{}];
-        }
+      // Check if the PNG data is not available, then try to get the TIFF data.
+      // In some applications (e.g., Lightshot), the PNG data might be empty
+      // for NSPasteboardTypePNG, so we need to handle this case using the
+      // TIFF data.
+      if (!image_data && [types containsObject:NSPasteboardTypeTIFF]) {
+        image_data = [pasteboard dataForType:NSPasteboardTypeTIFF];
+        data->image_data_tiff = true;
       }
-
-      if (!png_data) {
+      if (!image_data || [image_data length] == 0) {
         return false;
       }
+      data->image_data.assign(static_cast<const char *>([image_data bytes]), [image_data length]);
+    }
+    return true;
+  }
+  return false;
+}
 
-      NSImage *image = [[NSImage alloc] initWithData:png_data];
-      data->image_info.width = static_cast<int>([image size].width);
-      data->image_info.height = static_cast<int>([image size].height);
-      data->image_info.size_in_bytes = [png_data length];
+bool ClipboardReaderMac::storeImageData(const std::shared_ptr<ClipboardData> &data) {
+  // Make sure the images directory exists.
+  fs::path imagesDir = app_->getImagesDir();
+  if (!fs::exists(imagesDir)) {
+    fs::create_directories(imagesDir);
+  }
 
-      // Check if an identical image is already stored in the directory and use it.
-      if (findIdenticalImage(image, imagesDir, data)) {
-        return true;
-      }
+  @autoreleasepool {
+    // The data is copied, the image might be decoded later on the thumbnail
+    // and the update threads.
+    NSData *png_data = [NSData dataWithBytes:data->image_data.data() length:data->image_data.size()];
+    if (data->image_data_tiff) {
+      NSBitmapImageRep *image_rep = [NSBitmapImageRep imageRepWithData:png_data];
+      png_data = image_rep ? [image_rep representationUsingType:NSBitmapImageFileTypePNG properties:@{}] : nil;
+    }
+    if (!png_data) {
+      return false;
+    }
 
-      int creation_time_in_ms = (int) [[NSDate date] timeIntervalSince1970];
-
-      // Save image to file.
-      NSString *image_filename = [NSString stringWithFormat:@"image_%d.png", creation_time_in_ms];
-      NSString *images_dir = [NSString stringWithUTF8String:imagesDir.c_str()];
-      NSString *image_path = [images_dir stringByAppendingPathComponent:image_filename];
-      [png_data writeToFile:image_path atomically:YES];
-      data->image_info.file_name = [image_filename UTF8String];
-
-      // Save image info to file.
-      std::string image_info_filename = "image_" + std::to_string(creation_time_in_ms) + ".info";
-      std::string text_to_write = "width: " + std::to_string(data->image_info.width) + "\n" +
-                                  "height: " + std::to_string(data->image_info.height) + "\n";
-      std::ofstream output_file(imagesDir / image_info_filename);
-      if (output_file.is_open()) {
-        output_file << text_to_write;
-        output_file.close();
-      }
+    NSImage *image = [[[NSImage alloc] initWithData:png_data] autorelease];
+    data->image_info.width = static_cast<int>([image size].width);
+    data->image_info.height = static_cast<int>([image size].height);
+    data->image_info.size_in_bytes = [png_data length];
+
+    // Images are stored by the hash of their pixels, so an identical image
+    // is found without reading the stored images.
+    uint64_t image_hash = 0;
+    int pixels_width = 0;
+    int pixels_height = 0;
+    if (!getImageHash(image, image_hash, pixels_width, pixels_height)) {
+      return false;
+    }
+    auto image_store = app_->imageStore();
+    auto image_key = hashToHex(image_hash);
+    auto image_name = image_store->find(image_key);
+    if (!image_name.empty()) {
+      data->image_info.file_name = image_name;
+      data->image_info.thumb_file_name = getThumbFileName(image_name);
+      return true;
+    }
+
+    // Check if an identical image is stored under the legacy name and use it.
+    if (!legacy_images_indexed_) {
+      indexLegacyImages(imagesDir, app_->imageIndex());
+      legacy_images_indexed_ = true;
+    }
+    auto image_index = app_->imageIndex();
+    if (findIdenticalImage(image_hash, pixels_width, pixels_height, imagesDir, image_index, data)) {
+      return true;
+    }
 
-      // Save image thumbnail to file.
-      NSImage *thumb = createThumbnail(image, 48, 48);
-      NSData *tiff_data = [thumb TIFFRepresentation];
-      NSBitmapImageRep *rep = [NSBitmapImageRep imageRepWithData:tiff_data];
-      NSData *thumb_png_data = [rep representationUsingType:NSBitmapImageFileTypePNG properties:@{}];
-      NSString *thumb_filename = [NSString stringWithFormat:@"image_thumb_%d.png", creation_time_in_ms];
-      NSString *thumb_path = [images_dir stringByAppendingPathComponent:thumb_filename];
-      [thumb_png_data writeToFile:thumb_path atomically:YES];
-      data->image_info.thumb_file_name = [thumb_filename UTF8String];
+    // Reuse a similar image, e.g. a screenshot that differs by the cursor
+    // or the clock, if it's enabled in the settings.
+    auto perceptual_hash = getImagePerceptualHash(image);
+    auto similar_image_threshold = app_->settings()->getSimilarImageThreshold();
+    if (similar_image_threshold >= 0) {
+      auto similar_image_name = image_index->findSimilar(
+          perceptual_hash, pixels_width, pixels_height, similar_image_threshold);
+      if (!similar_image_name.empty() && fs::exists(imagesDir / similar_image_name)) {
+        data->image_info.file_name = similar_image_name;
+        data->image_info.thumb_file_name = getThumbFileName(similar_image_name);
+        return true;
+      }
+    }
 
-      // Extract text from image.
-      extractTextFromImage(image, app_, data);
+    // Save image to the store.
+    image_name = image_store->add(image_key, std::string_view(static_cast<const char *>([png_data bytes]),
+                                                              [png_data length]));
+    if (image_name.empty()) {
+      return false;
+    }
+    data->image_info.file_name = image_name;
+
+    // The thumbnail is generated in the background. Its name is known in
+    // advance and the UI reloads it when the file is written.
+    data->image_info.thumb_file_name = getThumbFileName(image_name);
+    generateImageThumbnails(app_, image, image_name, image_key);
+
+    ImageMetadata metadata;
+    metadata.file_name = data->image_info.file_name;
+    metadata.thumb_file_name = data->image_info.thumb_file_name;
+    metadata.width = pixels_width;
+    metadata.height = pixels_height;
+    metadata.size_in_bytes = data->image_info.size_in_bytes;
+    metadata.hash = image_hash;
+    metadata.perceptual_hash = perceptual_hash;
+    metadata.hashed = true;
+    image_index->add(metadata);
+
+    // The text is recognized once the clip is in the history.
+    CGImageRef cgImage = [image CGImageForProposedRect:nullptr context:nil hints:nil];
+    if (cgImage != nil) {
+      std::shared_ptr<CGImage> source(CGImageRetain(cgImage), CGImageRelease);
+      data->updates.push_back([app = app_, source, image_name]() {
+        @autoreleasepool {
+          sendImageText(app, source.get(), image_name);
+        }
+      });
     }
-    return true;
   }
-  return false;
+  return true;
 }
 
 std::string ClipboardReaderMac::readPasteboard(NSPasteboardType type) {
@@ -532,10 +837,38 @@ std::string ClipboardReaderMac::readPasteboard(NSPasteboardType type) {
   return "";
 }
 
-bool ClipboardReaderMac::readTextData(const std::shared_ptr<ClipboardData> &data) {
+void ClipboardReaderMac::readRichText(NSPasteboardType type, std::string &text, std::string &large_text) {
+  NSPasteboard *pasteboard = [NSPasteboard generalPasteboard];
+  if (![[pasteboard types] containsObject:type]) {
+    return;
+  }
+  NSData *data = [pasteboard dataForType:type];
+  if (data == nil || [data length] == 0) {
+    return;
+  }
+  // The large flavor is only copied here. It's converted and stored in a
+  // file by the persist stage and the UI reads it when it's needed.
+  if ([data length] > kMaxInlineRichTextSize) {
+    large_text.assign(static_cast<const char *>([data bytes]), [data length]);
+    return;
+  }
+  NSString *string = [[[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding] autorelease];
+  if (string == nil) {
+    string = [pasteboard stringForType:type];
+  }
+  const char *chars = [string UTF8String];
+  if (chars != nullptr && !isEmptyOrSpaces(chars)) {
+    text = chars;
+  }
+}
+
+bool ClipboardReaderMac::readTextData(const std::shared_ptr<ClipboardData> &data, bool read_rich_text) {
   data->text = readPasteboard(NSPasteboardTypeString);
-  data->rtf = readPasteboard(NSPasteboardTypeRTF);
-  data->html = readPasteboard(NSPasteboardTypeHTML);
+  // The rich text is only useful together with the text or the image.
+  if (read_rich_text && (!data->text.empty() || !data->image_data.empty())) {
+    readRichText(NSPasteboardTypeRTF, data->rtf, data->large_rtf);
+    readRichText(NSPasteboardTypeHTML, data->html, data->large_html);
+  }
   return !data->text.empty();
 }
 
@@ -555,12 +888,18 @@ bool ClipboardReaderMac::readFilesData(const std::shared_ptr<ClipboardData> &dat
           // If the file is an image, read the image size and extract text from it.
           if ([filePath hasSuffix:@".png"] || [filePath hasSuffix:@".jpg"] || [filePath hasSuffix:@".jpeg"] ||
               [filePath hasSuffix:@".gif"] || [filePath hasSuffix:@".bmp"] || [filePath hasSuffix:@".tiff"]) {
-              NSImage *image = [[NSImage alloc] initWithContentsOfFile:filePath];
+              NSImage *image = [[[NSImage alloc] initWithContentsOfFile:filePath] autorelease];
               if (image) {
                 auto size = [image size];
                 data->image_info.width = static_cast<int>(size.width);
                 data->image_info.height = static_cast<int>(size.height);
-                extractTextFromImage(image, app_, data);
+                data->updates.push_back([app = app_, file_path = file_path_info.file_path]() {
+                  @autoreleasepool {
+                    NSString *path = [NSString stringWithUTF8String:file_path.c_str()];
+                    NSImage *image = [[[NSImage alloc] initWithContentsOfFile:path] autorelease];
+                    sendImageText(app, [image CGImageForProposedRect:nullptr context:nil hints:nil], file_path);
+                  }
+                });
               }
           }
 
@@ -569,32 +908,14 @@ bool ClipboardReaderMac::readFilesData(const std::shared_ptr<ClipboardData> &dat
           if (!fs::exists(imagesDir)) {
             fs::create_directories(imagesDir);
           }
-          NSString *images_dir = [NSString stringWithUTF8String:imagesDir.c_str()];
           NSString *file_path_hash = getHashForPath(filePath);
 
           NSString *preview_file_name = [NSString stringWithFormat:@"file_preview_%@.png", file_path_hash];
-          NSString *preview_file_path = [images_dir stringByAppendingPathComponent:preview_file_name];
           file_path_info.file_preview_name = [preview_file_name UTF8String];
-          NSImage *preview = getThumbnailForFile(filePath, CGSizeMake(1024, 1024));
-          if (preview) {
-            NSData *tiff_data = [preview TIFFRepresentation];
-            NSBitmapImageRep *rep = [NSBitmapImageRep imageRepWithData:tiff_data];
-            NSData *png_data = [rep representationUsingType:NSBitmapImageFileTypePNG properties:@{}];
-            [png_data writeToFile:preview_file_path atomically:YES];
-            file_path_info.file_preview_name = [preview_file_name UTF8String];
-          }
-
           NSString *file_thumb_name = [NSString stringWithFormat:@"file_thumb_%@.png", file_path_hash];
-          NSString *file_thumb_path = [images_dir stringByAppendingPathComponent:file_thumb_name];
           file_path_info.file_thumb_name = [file_thumb_name UTF8String];
-          NSImage *thumb = getThumbnailForFile(filePath, CGSizeMake(48, 48));
-          if (thumb) {
-            NSData *tiff_data = [thumb TIFFRepresentation];
-            NSBitmapImageRep *rep = [NSBitmapImageRep imageRepWithData:tiff_data];
-            NSData *png_data = [rep representationUsingType:NSBitmapImageFileTypePNG properties:@{}];
-            [png_data writeToFile:file_thumb_path atomically:YES];
-            file_path_info.file_thumb_name = [file_thumb_name UTF8String];
-          }
+          generateFileThumbnails(app_, file_path_info.file_path, imagesDir,
+                                 file_path_info.file_preview_name, file_path_info.file_thumb_name);
 
           // Read file size in bytes.
           NSFileManager *fileManager = [NSFileManager defaultManager];
@@ -662,7 +983,8 @@ bool ClipboardReaderMac::readClipboardData(const std::shared_ptr<ClipboardData>
   }
 
   bool has_image = readImageData(data);
-  bool has_text = readTextData(data);
   bool has_files = readFilesData(data);
+  // The rich text of the copied files is not used.
+  bool has_text = readTextData(data, !has_files);
   return has_image || has_text || has_files;
 }
@@ -0,0 +1,106 @@
+#include "clipboard_source.h"
+
+#include <algorithm>
+#include <utility>
+
+PollSchedule::PollSchedule(std::chrono::milliseconds min_interval, std::chrono::milliseconds max_interval) :
+    min_interval_(min_interval),
+    max_interval_(std::max(min_interval, max_interval)),
+    delay_(min_interval) {}
+
+std::chrono::milliseconds PollSchedule::onCheck(bool changed) {
+  delay_ = changed ? min_interval_ : std::min(delay_ * 2, max_interval_);
+  return delay_;
+}
+
+void PollSchedule::onActivity() {
+  delay_ = min_interval_;
+}
+
+std::chrono::milliseconds PollSchedule::delay() const {
+  return delay_;
+}
+
+ClipboardWatcher::ClipboardWatcher(std::shared_ptr<ClipboardSource> source, PollSchedule schedule, Handler handler) :
+    source_(std::move(source)),
+    schedule_(schedule),
+    handler_(std::move(handler)) {}
+
+ClipboardWatcher::~ClipboardWatcher() {
+  stop();
+}
+
+void ClipboardWatcher::start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (thread_.joinable()) {
+    return;
+  }
+  // The content copied before the start is not reported.
+  last_change_count_ = source_->changeCount();
+  // The clipboard is still polled with the maximum interval if the source
+  // notifies about the changes, in case a notification is missed.
+  source_->setChangeListener([this]() {
+    notifyChanged();
+  });
+  next_check_time_ = std::chrono::steady_clock::now() + schedule_.delay();
+  thread_ = std::thread([this]() {
+    run();
+  });
+}
+
+void ClipboardWatcher::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  condition_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void ClipboardWatcher::notifyActivity() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    schedule_.onActivity();
+    next_check_time_ = std::min(next_check_time_, std::chrono::steady_clock::now() + schedule_.delay());
+  }
+  condition_.notify_all();
+}
+
+void ClipboardWatcher::notifyChanged() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    check_requested_ = true;
+  }
+  condition_.notify_all();
+}
+
+void ClipboardWatcher::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopped_) {
+    // The wait is interrupted when the next check is moved closer.
+    auto check_time = next_check_time_;
+    condition_.wait_until(lock, check_time, [this, check_time]() {
+      return stopped_ || check_requested_ || next_check_time_ < check_time;
+    });
+    if (stopped_) {
+      break;
+    }
+    if (!check_requested_ && std::chrono::steady_clock::now() < next_check_time_) {
+      continue;
+    }
+    check_requested_ = false;
+    lock.unlock();
+    bool changed = false;
+    auto change_count = source_->changeCount();
+    if (change_count != last_change_count_) {
+      changed = true;
+      if (handler_()) {
+        last_change_count_ = change_count;
+      }
+    }
+    lock.lock();
+    next_check_time_ = std::chrono::steady_clock::now() + schedule_.onCheck(changed);
+  }
+}
@@ -0,0 +1,97 @@
+#ifndef CLIPBOOK_CLIPBOARD_SOURCE_H_
+#define CLIPBOOK_CLIPBOARD_SOURCE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// The system clipboard as seen by the watcher.
+class ClipboardSource {
+ public:
+  virtual ~ClipboardSource() = default;
+
+  /**
+   * Returns a number that changes every time the clipboard content changes.
+   */
+  virtual long changeCount() = 0;
+
+  /**
+   * Registers the function to call when the clipboard content changes.
+   * Returns false if the platform does not notify about the changes and
+   * the clipboard must be polled.
+   */
+  virtual bool setChangeListener(std::function<void()> /*listener*/) {
+    return false;
+  }
+};
+
+// Decides when to check the clipboard next. The clipboard is checked often
+// right after the user activity or a change, when a copy is likely, and the
+// interval doubles with every check that finds no change, so an idle app
+// rarely wakes up.
+class PollSchedule {
+ public:
+  PollSchedule(std::chrono::milliseconds min_interval, std::chrono::milliseconds max_interval);
+
+  /**
+   * Returns the delay before the next check after a check that has or has
+   * not found a change.
+   */
+  std::chrono::milliseconds onCheck(bool changed);
+
+  /**
+   * Resets the delay to the minimum after the user activity.
+   */
+  void onActivity();
+
+  [[nodiscard]] std::chrono::milliseconds delay() const;
+
+ private:
+  const std::chrono::milliseconds min_interval_;
+  const std::chrono::milliseconds max_interval_;
+  std::chrono::milliseconds delay_;
+};
+
+// Watches the clipboard source on a background thread and calls the
+// handler when its content changes. The handler returns false to be called
+// again on the next check, e.g. while the user might still press a key
+// that changes how the content is handled.
+class ClipboardWatcher {
+ public:
+  using Handler = std::function<bool()>;
+
+  ClipboardWatcher(std::shared_ptr<ClipboardSource> source, PollSchedule schedule, Handler handler);
+  ClipboardWatcher(const ClipboardWatcher &) = delete;
+  ClipboardWatcher &operator=(const ClipboardWatcher &) = delete;
+  ~ClipboardWatcher();
+
+  void start();
+  void stop();
+
+  /**
+   * Makes the watcher check the clipboard soon, e.g. after a key press that
+   * might copy something.
+   */
+  void notifyActivity();
+
+ private:
+  void run();
+  void notifyChanged();
+
+ private:
+  std::shared_ptr<ClipboardSource> source_;
+  PollSchedule schedule_;
+  Handler handler_;
+  long last_change_count_ = 0;
+  std::chrono::steady_clock::time_point next_check_time_;
+  bool check_requested_ = false;
+  bool stopped_ = false;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+};
+
+#endif  // CLIPBOOK_CLIPBOARD_SOURCE_H_
@@ -0,0 +1,32 @@
+#include "compression.h"
+
+#include <zlib.h>
+
+bool gunzip(std::string_view input, std::string &output) {
+  z_stream stream{};
+  // Add 16 to the window bits to decode the gzip header and trailer.
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+    return false;
+  }
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+  stream.avail_in = static_cast<uInt>(input.size());
+
+  output.clear();
+  int result = Z_OK;
+  char buffer[64 * 1024];
+  while (result == Z_OK) {
+    stream.next_out = reinterpret_cast<Bytef *>(buffer);
+    stream.avail_out = sizeof(buffer);
+    result = inflate(&stream, Z_NO_FLUSH);
+    if (result != Z_OK && result != Z_STREAM_END) {
+      break;
+    }
+    output.append(buffer, sizeof(buffer) - stream.avail_out);
+    if (result == Z_OK && stream.avail_in == 0 && stream.avail_out != 0) {
+      // The input is truncated.
+      result = Z_DATA_ERROR;
+    }
+  }
+  inflateEnd(&stream);
+  return result == Z_STREAM_END;
+}
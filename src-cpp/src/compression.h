@@ -0,0 +1,10 @@
+#ifndef CLIPBOOK_COMPRESSION_H_
+#define CLIPBOOK_COMPRESSION_H_
+
+#include <string>
+#include <string_view>
+
+// Decompresses the gzip data. Returns false if the data is not a valid gzip stream.
+bool gunzip(std::string_view input, std::string &output);
+
+#endif  // CLIPBOOK_COMPRESSION_H_
@@ -0,0 +1,95 @@
+#include "hash.h"
+
+#include <cstring>
+
+// The implementation follows wyhash (public domain) by Wang Yi.
+namespace {
+
+const uint64_t kSecret0 = 0xa0761d6478bd642fULL;
+const uint64_t kSecret1 = 0xe7037ed1a0b428dbULL;
+const uint64_t kSecret2 = 0x8ebc6af09c88c6e3ULL;
+const uint64_t kSecret3 = 0x589965cc75374cc3ULL;
+
+inline void multiply(uint64_t *a, uint64_t *b) {
+  __uint128_t r = static_cast<__uint128_t>(*a) * *b;
+  *a = static_cast<uint64_t>(r);
+  *b = static_cast<uint64_t>(r >> 64);
+}
+
+inline uint64_t mix(uint64_t a, uint64_t b) {
+  multiply(&a, &b);
+  return a ^ b;
+}
+
+inline uint64_t read64(const uint8_t *p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t read32(const uint8_t *p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t read3(const uint8_t *p, std::size_t size) {
+  return (static_cast<uint64_t>(p[0]) << 16) |
+         (static_cast<uint64_t>(p[size >> 1]) << 8) |
+         p[size - 1];
+}
+
+}  // namespace
+
+uint64_t hash64(const void *data, std::size_t size, uint64_t seed) {
+  const auto *p = static_cast<const uint8_t *>(data);
+  seed ^= mix(seed ^ kSecret0, kSecret1);
+  uint64_t a;
+  uint64_t b;
+  if (size <= 16) {
+    if (size >= 4) {
+      a = (read32(p) << 32) | read32(p + ((size >> 3) << 2));
+      b = (read32(p + size - 4) << 32) | read32(p + size - 4 - ((size >> 3) << 2));
+    } else if (size > 0) {
+      a = read3(p, size);
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    std::size_t i = size;
+    if (i > 48) {
+      uint64_t seed1 = seed;
+      uint64_t seed2 = seed;
+      do {
+        seed = mix(read64(p) ^ kSecret1, read64(p + 8) ^ seed);
+        seed1 = mix(read64(p + 16) ^ kSecret2, read64(p + 24) ^ seed1);
+        seed2 = mix(read64(p + 32) ^ kSecret3, read64(p + 40) ^ seed2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= seed1 ^ seed2;
+    }
+    while (i > 16) {
+      seed = mix(read64(p) ^ kSecret1, read64(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = read64(p + i - 16);
+    b = read64(p + i - 8);
+  }
+  a ^= kSecret1;
+  b ^= seed;
+  multiply(&a, &b);
+  return mix(a ^ kSecret0 ^ size, b ^ kSecret1);
+}
+
+std::string hashToHex(uint64_t hash) {
+  static const char kDigits[] = "0123456789abcdef";
+  std::string result(16, '0');
+  for (int i = 15; i >= 0; --i) {
+    result[i] = kDigits[hash & 0xf];
+    hash >>= 4;
+  }
+  return result;
+}
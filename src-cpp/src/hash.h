@@ -0,0 +1,19 @@
+#ifndef CLIPBOOK_HASH_H_
+#define CLIPBOOK_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Returns a fast non-cryptographic 64-bit hash of the given bytes.
+uint64_t hash64(const void *data, std::size_t size, uint64_t seed = 0);
+
+inline uint64_t hash64(std::string_view str, uint64_t seed = 0) {
+  return hash64(str.data(), str.size(), seed);
+}
+
+// Returns the hash as a 16 characters long lowercase hex string.
+std::string hashToHex(uint64_t hash);
+
+#endif  // CLIPBOOK_HASH_H_
@@ -0,0 +1,444 @@
+#include "image_index.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "hash.h"
+#include "mapped_file.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'B', 'I', 'M', 'G', 'I', 'D', 'X'};
+constexpr uint32_t kVersion = 1;
+
+constexpr uint32_t kRemovedFlag = 1;
+constexpr uint32_t kHashedFlag = 2;
+constexpr uint32_t kHasTextFlag = 4;
+constexpr uint32_t kOptimizedFlag = 8;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  char reserved[16];
+};
+
+struct Record {
+  uint64_t hash;
+  uint64_t perceptual_hash;
+  uint64_t size_in_bytes;
+  uint32_t width;
+  uint32_t height;
+  uint32_t flags;
+  // The number of bytes the optimization of the image file saved.
+  uint32_t saved_bytes;
+  char file_name[104];
+  char thumb_file_name[104];
+  // The hash of all the preceding bytes of the record.
+  uint64_t checksum;
+};
+
+static_assert(sizeof(Header) == 32);
+static_assert(sizeof(Record) == 256);
+
+Header makeHeader() {
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.record_size = sizeof(Record);
+  return header;
+}
+
+uint64_t getRecordChecksum(const Record &record) {
+  return hash64(&record, offsetof(Record, checksum));
+}
+
+bool copyName(const std::string &name, char (&field)[104]) {
+  if (name.size() >= sizeof(field)) {
+    return false;
+  }
+  std::memcpy(field, name.data(), name.size());
+  return true;
+}
+
+std::string readName(const char (&field)[104]) {
+  return {field, strnlen(field, sizeof(field))};
+}
+
+// Returns false if the file names do not fit the record.
+bool encodeRecord(const ImageMetadata &metadata, bool removed, Record &record) {
+  record = {};
+  if (!copyName(metadata.file_name, record.file_name) ||
+      !copyName(metadata.thumb_file_name, record.thumb_file_name)) {
+    return false;
+  }
+  record.hash = metadata.hash;
+  record.perceptual_hash = metadata.perceptual_hash;
+  record.size_in_bytes = metadata.size_in_bytes;
+  record.width = static_cast<uint32_t>(metadata.width);
+  record.height = static_cast<uint32_t>(metadata.height);
+  record.flags = (removed ? kRemovedFlag : 0) | (metadata.hashed ? kHashedFlag : 0) |
+                 (metadata.has_text ? kHasTextFlag : 0) | (metadata.optimized ? kOptimizedFlag : 0);
+  record.saved_bytes = static_cast<uint32_t>(std::min<uint64_t>(metadata.saved_bytes, UINT32_MAX));
+  record.checksum = getRecordChecksum(record);
+  return true;
+}
+
+ImageMetadata decodeRecord(const Record &record) {
+  ImageMetadata metadata;
+  metadata.file_name = readName(record.file_name);
+  metadata.thumb_file_name = readName(record.thumb_file_name);
+  metadata.width = static_cast<int>(record.width);
+  metadata.height = static_cast<int>(record.height);
+  metadata.size_in_bytes = record.size_in_bytes;
+  metadata.hash = record.hash;
+  metadata.perceptual_hash = record.perceptual_hash;
+  metadata.hashed = (record.flags & kHashedFlag) != 0;
+  metadata.has_text = (record.flags & kHasTextFlag) != 0;
+  metadata.optimized = (record.flags & kOptimizedFlag) != 0;
+  metadata.saved_bytes = record.saved_bytes;
+  return metadata;
+}
+
+bool writeAll(int fd, const void *data, std::size_t size) {
+  auto bytes = static_cast<const char *>(data);
+  while (size > 0) {
+    auto written = write(fd, bytes, size);
+    if (written <= 0) {
+      return false;
+    }
+    bytes += written;
+    size -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+
+uint64_t getSizeKey(int width, int height) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(width)) << 32) | static_cast<uint32_t>(height);
+}
+
+bool parseHash(const std::string &hex, uint64_t &hash) {
+  auto result = std::from_chars(hex.data(), hex.data() + hex.size(), hash, 16);
+  return result.ec == std::errc() && result.ptr == hex.data() + hex.size();
+}
+
+}  // namespace
+
+ImageIndex::ImageIndex(std::string images_dir) :
+    images_dir_(std::move(images_dir)),
+    index_file_path_(images_dir_ + "/index.bin") {}
+
+ImageIndex::~ImageIndex() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+std::string ImageIndex::find(uint64_t hash, int width, int height) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  load();
+  auto it = hashes_.find(hash);
+  if (it == hashes_.end()) {
+    return "";
+  }
+  const auto &image = images_.at(it->second);
+  if (image.width != width || image.height != height) {
+    return "";
+  }
+  return image.file_name;
+}
+
+std::string ImageIndex::findSimilar(uint64_t perceptual_hash, int width, int height, int max_distance) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  load();
+  auto it = similar_images_.find(getSizeKey(width, height));
+  if (it == similar_images_.end()) {
+    return "";
+  }
+  return it->second.findClosest(perceptual_hash, max_distance);
+}
+
+bool ImageIndex::contains(const std::string &file_name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  load();
+  auto it = images_.find(file_name);
+  return it != images_.end() && it->second.hashed;
+}
+
+bool ImageIndex::getMetadata(const std::string &file_name, ImageMetadata &metadata) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  load();
+  auto it = images_.find(file_name);
+  if (it == images_.end()) {
+    return false;
+  }
+  metadata = it->second;
+  return true;
+}
+
+std::vector<ImageMetadata> ImageIndex::list() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  load();
+  std::vector<ImageMetadata> images;
+  images.reserve(images_.size());
+  for (const auto &[file_name, metadata] : images_) {
+    images.push_back(metadata);
+  }
+  return images;
+}
+
+bool ImageIndex::add(const ImageMetadata &metadata) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  load();
+  if (!append(metadata, false)) {
+    return false;
+  }
+  apply(metadata);
+  return true;
+}
+
+bool ImageIndex::update(const ImageMetadata &metadata) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  load();
+  if (!images_.contains(metadata.file_name) || !append(metadata, false)) {
+    return false;
+  }
+  apply(metadata);
+  return true;
+}
+
+void ImageIndex::remove(const std::string &file_name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  load();
+  auto it = images_.find(file_name);
+  if (it == images_.end()) {
+    return;
+  }
+  append(it->second, true);
+  erase(file_name);
+}
+
+void ImageIndex::load() {
+  if (loaded_) {
+    return;
+  }
+  loaded_ = true;
+  std::error_code error;
+  if (!fs::exists(index_file_path_, error)) {
+    migrate();
+    return;
+  }
+
+  std::size_t valid_size = 0;
+  std::size_t file_size = 0;
+  {
+    MappedFile file(index_file_path_);
+    file_size = file.size();
+    auto expected_header = makeHeader();
+    if (file.isValid() && file.size() >= sizeof(Header) &&
+        std::memcmp(file.data(), &expected_header, sizeof(Header)) == 0) {
+      valid_size = sizeof(Header);
+      while (valid_size + sizeof(Record) <= file.size()) {
+        Record record{};
+        std::memcpy(&record, file.data() + valid_size, sizeof(Record));
+        if (record.checksum != getRecordChecksum(record)) {
+          break;
+        }
+        if (record.flags & kRemovedFlag) {
+          erase(readName(record.file_name));
+        } else {
+          apply(decodeRecord(record));
+        }
+        valid_size += sizeof(Record);
+        records_count_++;
+      }
+    }
+  }
+  // Drop the torn record left by a crash or the file with a broken header.
+  if (valid_size == 0) {
+    fs::remove(index_file_path_, error);
+  } else if (valid_size != file_size) {
+    truncate(index_file_path_.c_str(), static_cast<off_t>(valid_size));
+  }
+  if (records_count_ > 2 * images_.size() + 64) {
+    compact();
+  }
+}
+
+void ImageIndex::migrate() {
+  std::vector<fs::path> legacy_files;
+  // The text index with the "+ <hash> <width> <height> <perceptual hash>
+  // <file name>" and "- <file name>" records.
+  fs::path text_index_path = fs::path(images_dir_) / "index";
+  std::ifstream text_index(text_index_path);
+  if (text_index.is_open()) {
+    legacy_files.push_back(text_index_path);
+    std::string line;
+    while (std::getline(text_index, line)) {
+      if (line.size() < 3 || line[1] != ' ') {
+        continue;
+      }
+      if (line[0] == '-') {
+        erase(line.substr(2));
+        continue;
+      }
+      std::istringstream stream(line.substr(2));
+      std::string hash_hex;
+      std::string perceptual_hash_hex;
+      ImageMetadata metadata;
+      if (line[0] != '+' ||
+          !(stream >> hash_hex >> metadata.width >> metadata.height >> perceptual_hash_hex) ||
+          !std::getline(stream >> std::ws, metadata.file_name) || metadata.file_name.empty() ||
+          !parseHash(hash_hex, metadata.hash) || !parseHash(perceptual_hash_hex, metadata.perceptual_hash)) {
+        continue;
+      }
+      metadata.hashed = true;
+      apply(std::move(metadata));
+    }
+    text_index.close();
+  }
+
+  // The ".info" files with the "width: " and "height: " lines.
+  std::error_code error;
+  for (const auto &entry : fs::directory_iterator(images_dir_, error)) {
+    if (!entry.is_regular_file() || entry.path().extension() != ".info") {
+      continue;
+    }
+    legacy_files.push_back(entry.path());
+    auto image_path = fs::path(entry.path()).replace_extension(".png");
+    auto file_name = image_path.filename().string();
+    if (images_.contains(file_name) || !fs::exists(image_path, error)) {
+      continue;
+    }
+    ImageMetadata metadata;
+    metadata.file_name = file_name;
+    metadata.size_in_bytes = fs::file_size(image_path, error);
+    std::ifstream info_file(entry.path());
+    std::string line;
+    while (std::getline(info_file, line)) {
+      if (line.starts_with("width: ")) {
+        std::from_chars(line.data() + 7, line.data() + line.size(), metadata.width);
+      } else if (line.starts_with("height: ")) {
+        std::from_chars(line.data() + 8, line.data() + line.size(), metadata.height);
+      }
+    }
+    apply(std::move(metadata));
+  }
+
+  if (legacy_files.empty()) {
+    return;
+  }
+  // Write the table first, so the legacy files are removed only when their
+  // content has been saved.
+  if (!compact()) {
+    return;
+  }
+  for (const auto &path : legacy_files) {
+    fs::remove(path, error);
+  }
+}
+
+void ImageIndex::apply(ImageMetadata metadata) {
+  erase(metadata.file_name);
+  if (metadata.hashed) {
+    // The hash is mapped to the latest file with it. The other file with the
+    // same hash, e.g. the legacy copy of the image, keeps its metadata.
+    hashes_[metadata.hash] = metadata.file_name;
+    similar_images_[getSizeKey(metadata.width, metadata.height)].insert(metadata.perceptual_hash,
+                                                                        metadata.file_name);
+  }
+  auto file_name = metadata.file_name;
+  images_[file_name] = std::move(metadata);
+}
+
+void ImageIndex::erase(const std::string &file_name) {
+  auto it = images_.find(file_name);
+  if (it == images_.end()) {
+    return;
+  }
+  const auto &image = it->second;
+  if (image.hashed) {
+    auto hash = hashes_.find(image.hash);
+    if (hash != hashes_.end() && hash->second == file_name) {
+      hashes_.erase(hash);
+    }
+    auto tree = similar_images_.find(getSizeKey(image.width, image.height));
+    if (tree != similar_images_.end()) {
+      tree->second.remove(file_name);
+      if (tree->second.size() == 0) {
+        similar_images_.erase(tree);
+      }
+    }
+  }
+  images_.erase(it);
+}
+
+bool ImageIndex::append(const ImageMetadata &metadata, bool removed) {
+  Record record{};
+  if (!encodeRecord(metadata, removed, record)) {
+    return false;
+  }
+  if (fd_ < 0) {
+    fd_ = open(index_file_path_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd_ < 0) {
+      return false;
+    }
+    if (lseek(fd_, 0, SEEK_END) == 0) {
+      auto header = makeHeader();
+      if (!writeAll(fd_, &header, sizeof(header))) {
+        return false;
+      }
+    }
+  }
+  if (!writeAll(fd_, &record, sizeof(record))) {
+    return false;
+  }
+  records_count_++;
+  return true;
+}
+
+bool ImageIndex::compact() {
+  // Write the live records to a temporary file and replace the table with
+  // it, so a crash leaves either the old or the new table.
+  auto temp_path = index_file_path_ + ".tmp";
+  int fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  auto header = makeHeader();
+  bool success = writeAll(fd, &header, sizeof(header));
+  for (const auto &[file_name, image] : images_) {
+    Record record{};
+    if (success && encodeRecord(image, false, record)) {
+      success = writeAll(fd, &record, sizeof(record));
+    }
+  }
+  success = success && fsync(fd) == 0;
+  close(fd);
+  std::error_code error;
+  if (success) {
+    fs::rename(temp_path, index_file_path_, error);
+  }
+  if (!success || error) {
+    fs::remove(temp_path, error);
+    return false;
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+  records_count_ = images_.size();
+  return true;
+}
@@ -0,0 +1,110 @@
+#ifndef CLIPBOOK_IMAGE_INDEX_H_
+#define CLIPBOOK_IMAGE_INDEX_H_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "perceptual_hash.h"
+
+struct ImageMetadata {
+  std::string file_name;
+  std::string thumb_file_name;
+  int width = 0;
+  int height = 0;
+  uint64_t size_in_bytes = 0;
+  // The hash of the decoded pixels and the perceptual hash. The images
+  // imported from the legacy ".info" files have no hashes until they are
+  // decoded.
+  uint64_t hash = 0;
+  uint64_t perceptual_hash = 0;
+  bool hashed = false;
+  // Indicates if a text has been recognized in the image.
+  bool has_text = false;
+  // Indicates if the image file has been re-encoded to take less space and
+  // how many bytes that saved.
+  bool optimized = false;
+  uint64_t saved_bytes = 0;
+};
+
+// A persistent table of the stored images metadata indexed by the hash of
+// the image pixels and by the perceptual hash. The table is loaded once,
+// so an identical or a similar image is found with a lookup instead of
+// decoding and comparing all the stored images.
+//
+// The table is the "index.bin" file in the images directory. It is a
+// header followed by the fixed-size records, each with a checksum. The
+// records are appended, the last record of an image wins and a removed
+// image gets a tombstone record. The file is memory-mapped on load, a torn
+// record at the end left by a crash is truncated, and the file is compacted
+// into a temporary file that replaces it atomically when most of its
+// records are obsolete.
+//
+// On the first load the table imports the legacy "index" text file and the
+// per-image ".info" files and removes them.
+class ImageIndex {
+ public:
+  explicit ImageIndex(std::string images_dir);
+  ImageIndex(const ImageIndex &) = delete;
+  ImageIndex &operator=(const ImageIndex &) = delete;
+  ~ImageIndex();
+
+  /**
+   * Returns the name of the image file with the given pixel hash and
+   * dimensions or an empty string if there is no such image in the index.
+   */
+  std::string find(uint64_t hash, int width, int height);
+
+  /**
+   * Returns the name of the image file with the same dimensions whose
+   * perceptual hash differs from the given one in at most max_distance bits
+   * or an empty string if there is no such image in the index.
+   */
+  std::string findSimilar(uint64_t perceptual_hash, int width, int height, int max_distance);
+
+  /**
+   * Indicates if the image file with the given name is indexed by its
+   * pixel hash.
+   */
+  bool contains(const std::string &file_name);
+
+  bool getMetadata(const std::string &file_name, ImageMetadata &metadata);
+  std::vector<ImageMetadata> list();
+
+  /**
+   * Adds or replaces the metadata of the image file. Returns false if the
+   * file names do not fit the record.
+   */
+  bool add(const ImageMetadata &metadata);
+
+  /**
+   * Replaces the metadata of the indexed image file. Returns false if the
+   * image is not in the index, e.g. it has been removed meanwhile.
+   */
+  bool update(const ImageMetadata &metadata);
+  void remove(const std::string &file_name);
+
+ private:
+  void load();
+  void migrate();
+  void apply(ImageMetadata metadata);
+  void erase(const std::string &file_name);
+  bool append(const ImageMetadata &metadata, bool removed);
+  bool compact();
+
+ private:
+  const std::string images_dir_;
+  const std::string index_file_path_;
+  std::unordered_map<std::string, ImageMetadata> images_;
+  std::unordered_map<uint64_t, std::string> hashes_;
+  // The perceptual hashes of the images by the image dimensions.
+  std::unordered_map<uint64_t, HammingTree> similar_images_;
+  std::size_t records_count_ = 0;
+  int fd_ = -1;
+  bool loaded_ = false;
+  std::mutex mutex_;
+};
+
+#endif  // CLIPBOOK_IMAGE_INDEX_H_
@@ -0,0 +1,108 @@
+#include "image_optimizer.h"
+
+#if defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include "png.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// The pause between the images, so the optimization does not keep a core
+// busy.
+constexpr auto kPauseBetweenImages = std::chrono::milliseconds(100);
+
+void setBackgroundPriority() {
+#if defined(__APPLE__)
+  pthread_set_qos_class_self_np(QOS_CLASS_BACKGROUND, 0);
+#endif
+}
+
+bool readFile(const fs::path &path, std::string &data) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  std::ostringstream stream;
+  stream << file.rdbuf();
+  data = std::move(stream).str();
+  return !file.bad();
+}
+
+}  // namespace
+
+ImageOptimizer::ImageOptimizer(std::string images_dir,
+                               std::shared_ptr<BlobStore> store,
+                               std::shared_ptr<ImageIndex> index) :
+    images_dir_(std::move(images_dir)),
+    store_(std::move(store)),
+    index_(std::move(index)) {}
+
+uint64_t ImageOptimizer::run(std::chrono::seconds min_age) {
+  setBackgroundPriority();
+  uint64_t saved_bytes = 0;
+  auto max_write_time = fs::file_time_type::clock::now() - min_age;
+  for (auto &metadata : index_->list()) {
+    if (stopped_) {
+      break;
+    }
+    if (metadata.optimized || !metadata.file_name.ends_with(".png") ||
+        !FileBlobStore::isBlobName(metadata.file_name)) {
+      continue;
+    }
+    std::error_code error;
+    auto path = fs::path(images_dir_) / metadata.file_name;
+    auto write_time = fs::last_write_time(path, error);
+    if (error || write_time > max_write_time) {
+      continue;
+    }
+    if (optimize(metadata)) {
+      saved_bytes += metadata.saved_bytes;
+    }
+    // The image is marked even if it cannot be made smaller, so it's not
+    // read again, unless it has been deleted meanwhile.
+    metadata.optimized = true;
+    index_->update(metadata);
+    std::this_thread::sleep_for(kPauseBetweenImages);
+  }
+  return saved_bytes;
+}
+
+void ImageOptimizer::stop() {
+  stopped_ = true;
+}
+
+void ImageOptimizer::getStats(uint64_t &images_count, uint64_t &saved_bytes) {
+  images_count = 0;
+  saved_bytes = 0;
+  for (const auto &metadata : index_->list()) {
+    if (metadata.optimized && metadata.saved_bytes > 0) {
+      images_count++;
+      saved_bytes += metadata.saved_bytes;
+    }
+  }
+}
+
+bool ImageOptimizer::optimize(ImageMetadata &metadata) {
+  auto path = fs::path(images_dir_) / metadata.file_name;
+  std::string png;
+  std::string optimized_png;
+  if (!readFile(path, png) || !optimizePng(png, optimized_png)) {
+    return false;
+  }
+  // The image might have been deleted while it was re-encoded.
+  if (!store_->replace(metadata.file_name, optimized_png)) {
+    return false;
+  }
+  metadata.saved_bytes = png.size() - optimized_png.size();
+  metadata.size_in_bytes = optimized_png.size();
+  return true;
+}
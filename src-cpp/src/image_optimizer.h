@@ -0,0 +1,53 @@
+#ifndef CLIPBOOK_IMAGE_OPTIMIZER_H_
+#define CLIPBOOK_IMAGE_OPTIMIZER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "blob_store.h"
+#include "image_index.h"
+
+// Re-encodes the stored images that have not been modified for a while, so
+// they take less disk space. The images stay PNG files with the same pixels
+// and the same color profile, so pasting or saving them is not affected.
+// Every image is processed once, the result is kept in the image index.
+//
+// Only the images in the blob store are re-encoded. They are replaced
+// through the store, so an image deleted meanwhile is not brought back.
+class ImageOptimizer {
+ public:
+  ImageOptimizer(std::string images_dir, std::shared_ptr<BlobStore> store, std::shared_ptr<ImageIndex> index);
+  ImageOptimizer(const ImageOptimizer &) = delete;
+  ImageOptimizer &operator=(const ImageOptimizer &) = delete;
+
+  /**
+   * Re-encodes the indexed images whose files are older than the given age
+   * on the calling thread with the background priority. Returns the number
+   * of bytes saved by this call.
+   */
+  uint64_t run(std::chrono::seconds min_age);
+
+  /**
+   * Makes the running optimization return after the current image.
+   */
+  void stop();
+
+  /**
+   * Returns the number of optimized images and the bytes saved by them.
+   */
+  void getStats(uint64_t &images_count, uint64_t &saved_bytes);
+
+ private:
+  bool optimize(ImageMetadata &metadata);
+
+ private:
+  const std::string images_dir_;
+  std::shared_ptr<BlobStore> store_;
+  std::shared_ptr<ImageIndex> index_;
+  std::atomic<bool> stopped_ = false;
+};
+
+#endif  // CLIPBOOK_IMAGE_OPTIMIZER_H_
@@ -0,0 +1,42 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <bit>
+
+void LatencyHistogram::record(std::chrono::microseconds latency) {
+  auto us = static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0));
+  // Bucket i holds the samples in [2^(i-1), 2^i) microseconds.
+  auto bucket = std::min<std::size_t>(std::bit_width(us), kBucketsCount - 1);
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  total_us_.fetch_add(us, std::memory_order_relaxed);
+}
+
+std::chrono::microseconds LatencyHistogram::percentile(double percentile) const {
+  uint64_t count = 0;
+  std::array<uint64_t, kBucketsCount> buckets{};
+  for (std::size_t i = 0; i < kBucketsCount; ++i) {
+    buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    count += buckets[i];
+  }
+  if (count == 0) {
+    return std::chrono::microseconds(0);
+  }
+  auto rank = static_cast<uint64_t>(static_cast<double>(count) * percentile / 100.0);
+  uint64_t seen = 0;
+  for (std::size_t i = 0; i < kBucketsCount; ++i) {
+    seen += buckets[i];
+    if (seen > rank || seen == count) {
+      return std::chrono::microseconds(uint64_t(1) << i);
+    }
+  }
+  return std::chrono::microseconds(uint64_t(1) << (kBucketsCount - 1));
+}
+
+uint64_t LatencyHistogram::count() const {
+  return count_.load(std::memory_order_relaxed);
+}
+
+std::chrono::microseconds LatencyHistogram::total() const {
+  return std::chrono::microseconds(total_us_.load(std::memory_order_relaxed));
+}
@@ -0,0 +1,31 @@
+#ifndef CLIPBOOK_LATENCY_HISTOGRAM_H_
+#define CLIPBOOK_LATENCY_HISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// A lock-free histogram of latencies with power-of-two microsecond buckets.
+// Recording a sample is a couple of relaxed atomic increments, so it can be
+// used on hot paths from any thread.
+class LatencyHistogram {
+ public:
+  static constexpr std::size_t kBucketsCount = 32;
+
+  void record(std::chrono::microseconds latency);
+
+  // Returns the upper bound of the bucket containing the given percentile
+  // (0-100) of the recorded samples or 0 if there are no samples.
+  [[nodiscard]] std::chrono::microseconds percentile(double percentile) const;
+
+  [[nodiscard]] uint64_t count() const;
+  [[nodiscard]] std::chrono::microseconds total() const;
+
+ private:
+  std::array<std::atomic<uint64_t>, kBucketsCount> buckets_{};
+  std::atomic<uint64_t> count_ = 0;
+  std::atomic<uint64_t> total_us_ = 0;
+};
+
+#endif  // CLIPBOOK_LATENCY_HISTOGRAM_H_
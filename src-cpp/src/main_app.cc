@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <thread>
 #include <iostream>
 #include <fstream>
@@ -7,6 +8,7 @@
 #include <utility>
 
 #include "main_app.h"
+#include "url.h"
 #include "utils.h"
 #include "webview.h"
 
@@ -18,6 +20,19 @@ using namespace mobrowser;
 
 namespace fs = std::filesystem;
 
+// The thumbnails are generated in the background by at most this number of
+// threads, so they never take all the cores.
+static const unsigned kMaxThumbnailThreadsCount = 4;
+static const std::size_t kThumbnailQueueSize = 64;
+// The images are re-encoded to take less space a while after the launch,
+// so the launch is not slowed down, and then once a day. Only the images
+// that have not been modified for a week are re-encoded.
+static const auto kImageOptimizationDelay = std::chrono::minutes(5);
+static const auto kImageOptimizationInterval = std::chrono::hours(24);
+static const auto kImageOptimizationMinAge = std::chrono::hours(24 * 7);
+// The maximum number of captured clips the UI reads at once.
+static const std::size_t kMaxClipsReadCount = 64;
+
 std::string escapeJavaScriptString(const std::string &value) {
   std::string result;
   result.reserve(value.size());
@@ -135,6 +150,17 @@ MainApp::MainApp(const std::shared_ptr<App> &app, const std::shared_ptr<AppSetti
       settings_(settings) {
   request_interceptor_ = std::make_shared<UrlRequestInterceptor>(
       app_->profile()->path(), app_->getPath(mobrowser::PathKey::kAppResources));
+  image_store_ = std::make_shared<FileBlobStore>(getImagesDir(), ".png");
+  image_index_ = std::make_shared<ImageIndex>(getImagesDir());
+  text_store_ = std::make_shared<FileBlobStore>(getTextsDir(), ".txt");
+  clip_log_ = std::make_shared<ClipLog>(app_->profile()->path() + "/clips.log");
+  thumbnail_pipeline_ = std::make_shared<ThumbnailPipeline>(
+      std::clamp(std::thread::hardware_concurrency() / 2, 1u, kMaxThumbnailThreadsCount), kThumbnailQueueSize);
+  image_optimizer_ = std::make_shared<ImageOptimizer>(getImagesDir(), image_store_, image_index_);
+}
+
+MainApp::~MainApp() {
+  stopImageOptimization();
 }
 
 bool MainApp::init() {
@@ -142,6 +168,12 @@ bool MainApp::init() {
                                                              InterceptUrlRequestAction action) {
     request_interceptor_->intercept(args, std::move(action));
   };
+  std::thread([this]() {
+    request_interceptor_->preloadResources();
+  }).detach();
+  image_optimizer_thread_ = std::thread([this]() {
+    optimizeImages();
+  });
 
   open_app_item_ = menu::Item("Open ClipBook", [this](const CustomMenuItemActionArgs &args) {
     show();
@@ -370,6 +402,26 @@ std::shared_ptr<AppSettings> MainApp::settings() const {
   return settings_;
 }
 
+std::shared_ptr<BlobStore> MainApp::imageStore() const {
+  return image_store_;
+}
+
+std::shared_ptr<BlobStore> MainApp::textStore() const {
+  return text_store_;
+}
+
+std::shared_ptr<ClipLog> MainApp::clipLog() const {
+  return clip_log_;
+}
+
+std::shared_ptr<ImageIndex> MainApp::imageIndex() const {
+  return image_index_;
+}
+
+std::shared_ptr<ThumbnailPipeline> MainApp::thumbnailPipeline() const {
+  return thumbnail_pipeline_;
+}
+
 void MainApp::pasteNextItemToActiveApp() {
   std::thread([this]() {
     auto frame = app_window_->mainFrame();
@@ -789,6 +841,12 @@ void MainApp::initJavaScriptApi(const std::shared_ptr<mobrowser::JsObject> &wind
   window->putProperty("deleteLinkImage", [this](std::string imageFileName) {
     deleteLinkImage(std::move(imageFileName));
   });
+  window->putProperty("readText", [this](std::string textFileName) -> std::string {
+    return readText(textFileName);
+  });
+  window->putProperty("deleteText", [this](std::string textFileName) {
+    deleteText(textFileName);
+  });
   window->putProperty("openInBrowser", [this](std::string url) {
     app_->desktop()->openUrl(url);
     hide();
@@ -1055,6 +1113,18 @@ void MainApp::initJavaScriptApi(const std::shared_ptr<mobrowser::JsObject> &wind
   window->putProperty("getRetentionPeriodColor", [this]() -> int {
     return settings_->getRetentionPeriodColor();
   });
+  window->putProperty("saveSimilarImageThreshold", [this](int threshold) -> void {
+    settings_->saveSimilarImageThreshold(threshold);
+  });
+  window->putProperty("getSimilarImageThreshold", [this]() -> int {
+    return settings_->getSimilarImageThreshold();
+  });
+  window->putProperty("saveLargeTextThreshold", [this](int threshold) -> void {
+    settings_->saveLargeTextThreshold(threshold);
+  });
+  window->putProperty("getLargeTextThreshold", [this]() -> int {
+    return settings_->getLargeTextThreshold();
+  });
 
   window->putProperty("saveTheme", [this](std::string theme) -> void {
     setTheme(theme);
@@ -1593,6 +1663,23 @@ void MainApp::initJavaScriptApi(const std::shared_ptr<mobrowser::JsObject> &wind
     }).detach();
   });
 
+  window->putProperty("getCanonicalUrl", [](std::string url) -> std::string {
+    return URL(url).canonical();
+  });
+
+  window->putProperty("getImageStorageStats", [this]() -> std::string {
+    return getImageStorageStats();
+  });
+  window->putProperty("getIngestionStats", [this]() -> std::string {
+    return getIngestionStats();
+  });
+  window->putProperty("readClips", [this](int afterSequence) -> std::string {
+    return readClips(afterSequence);
+  });
+  window->putProperty("acknowledgeClips", [this](int sequence) {
+    clip_log_->acknowledge(static_cast<uint64_t>(std::max(sequence, 0)));
+  });
+
   window->putProperty("setUpdateHistoryAfterAction", [this](bool update) -> void {
     settings_->saveUpdateHistoryAfterAction(update);
   });
@@ -1622,16 +1709,24 @@ void MainApp::initJavaScriptApi(const std::shared_ptr<mobrowser::JsObject> &wind
 }
 
 void MainApp::fetchLinkPreviewDetails(const std::string &url, const std::shared_ptr<mobrowser::JsObject> &callback) {
-  // If the given URL is already being fetched, ignore the request.
-  if (std::find(fetch_url_requests_.begin(), fetch_url_requests_.end(), url) != fetch_url_requests_.end()) {
-    LOG(INFO) << "Skip fetching link preview: " << url;
-    return;
+  // If the same page is already being fetched, ignore the request. The URLs
+  // are compared in the canonical form, so "HTTPS://X.com/a/" and
+  // "https://x.com/a?utm_source=y" are the same page.
+  auto url_hash = URL(url).canonicalHash();
+  {
+    std::lock_guard<std::mutex> lock(fetch_url_requests_mutex_);
+    if (!fetch_url_requests_.insert(url_hash).second) {
+      LOG(INFO) << "Skip fetching link preview: " << url;
+      return;
+    }
   }
-  fetch_url_requests_.push_back(url);
   HeadlessWebView headless(app_, getLinkImagesDir());
   LinkPreviewDetails details;
   auto success = headless.fetchLinkPreviewDetails(url, details);
-  fetch_url_requests_.remove(url);
+  {
+    std::lock_guard<std::mutex> lock(fetch_url_requests_mutex_);
+    fetch_url_requests_.erase(url_hash);
+  }
   callback->call("run",
                  success,
                  details.title,
@@ -1721,6 +1816,7 @@ void MainApp::createTray() {
 }
 
 void MainApp::quit() {
+  stopImageOptimization();
   if (settings_->shouldClearHistoryOnQuit()) {
     if (const auto frame = app_window_->mainFrame()) {
       // Set the flag to false to indicate that the app is not ready to quit.
@@ -1888,6 +1984,35 @@ void MainApp::notifyClipBookArchiveImported() {
       "window.clipBookArchiveDidImport && window.clipBookArchiveDidImport()");
 }
 
+void MainApp::notifyThumbnailReady(const std::string &fileName) {
+  if (!app_window_ || app_window_->isClosed()) {
+    return;
+  }
+
+  app_window_->mainFrame()->executeJavaScript(
+      "window.onThumbnailReady && window.onThumbnailReady(\"" + escapeJavaScriptString(fileName) + "\")");
+}
+
+void MainApp::notifyClipsAvailable() {
+  if (!app_window_ || app_window_->isClosed()) {
+    return;
+  }
+
+  app_window_->mainFrame()->executeJavaScript("window.onClipsAvailable && window.onClipsAvailable()");
+}
+
+std::string MainApp::readClips(int afterSequence) {
+  std::string result = "[";
+  for (const auto &entry : clip_log_->read(static_cast<uint64_t>(std::max(afterSequence, 0)), kMaxClipsReadCount)) {
+    if (result.size() > 1) {
+      result += ",";
+    }
+    result += "{\"sequence\":" + std::to_string(entry.sequence) + ",\"clip\":" + entry.data + "}";
+  }
+  result += "]";
+  return result;
+}
+
 std::string MainApp::copyClipBookArchiveAsset(const std::string &archiveRoot,
                                               const std::string &relativePath,
                                               bool linkPreview,
@@ -1921,6 +2046,42 @@ std::string MainApp::copyClipBookArchiveAsset(const std::string &archiveRoot,
   return destination.filename().string();
 }
 
+void MainApp::optimizeImages() {
+  std::unique_lock<std::mutex> lock(image_optimizer_mutex_);
+  std::chrono::minutes delay = kImageOptimizationDelay;
+  // The wait ends early when the app quits.
+  while (!image_optimizer_stop_.wait_for(lock, delay, [this]() { return image_optimizer_stopped_; })) {
+    lock.unlock();
+    auto saved_bytes = image_optimizer_->run(kImageOptimizationMinAge);
+    if (saved_bytes > 0) {
+      LOG(INFO) << "Image optimization saved " << saved_bytes << " bytes";
+    }
+    lock.lock();
+    delay = kImageOptimizationInterval;
+  }
+}
+
+void MainApp::stopImageOptimization() {
+  // The running optimization returns after the current image.
+  image_optimizer_->stop();
+  {
+    std::lock_guard<std::mutex> lock(image_optimizer_mutex_);
+    image_optimizer_stopped_ = true;
+  }
+  image_optimizer_stop_.notify_all();
+  if (image_optimizer_thread_.joinable()) {
+    image_optimizer_thread_.join();
+  }
+}
+
+std::string MainApp::getImageStorageStats() {
+  uint64_t images_count = 0;
+  uint64_t saved_bytes = 0;
+  image_optimizer_->getStats(images_count, saved_bytes);
+  return "{\"optimizedImages\":" + std::to_string(images_count) +
+         ",\"savedBytes\":" + std::to_string(saved_bytes) + "}";
+}
+
 std::string MainApp::getImagesDir() {
   return app_->profile()->path() + "/images";
 }
@@ -1929,14 +2090,51 @@ std::string MainApp::getLinkImagesDir() {
   return app_->profile()->path() + "/images/links";
 }
 
+std::string MainApp::getTextsDir() {
+  return app_->profile()->path() + "/texts";
+}
+
+std::string MainApp::readText(const std::string &textFileName) {
+  // Only the stored texts can be read, not an arbitrary file.
+  if (!FileBlobStore::isBlobName(textFileName)) {
+    return "";
+  }
+  std::ifstream file(getTextsDir() + "/" + textFileName, std::ios::binary);
+  if (!file) {
+    return "";
+  }
+  std::ostringstream stream;
+  stream << file.rdbuf();
+  return std::move(stream).str();
+}
+
+void MainApp::deleteText(const std::string &textFileName) {
+  if (!textFileName.empty()) {
+    text_store_->release(textFileName);
+  }
+}
+
 void MainApp::deleteImage(const std::string &imageFileName) {
   if (imageFileName.empty()) {
     return;
   }
 
+  // The images in the store might be shared by several clips.
+  if (image_store_->release(imageFileName)) {
+    if (!fs::exists(getImagesDir() + "/" + imageFileName)) {
+      image_index_->remove(imageFileName);
+      // The downscaled copies are removed together with the image.
+      for (int level : kImagePyramidLevels) {
+        image_store_->release(getImageLevelFileName(imageFileName, level));
+      }
+    }
+    return;
+  }
+
   std::string filePath = getImagesDir() + "/" + imageFileName;
   if (fs::exists(filePath) && fs::is_regular_file(filePath)) {
       fs::remove(filePath);
+      image_index_->remove(imageFileName);
       auto infoFilePath = fs::path(filePath).replace_extension(".info");
       if (fs::exists(infoFilePath) && fs::is_regular_file(infoFilePath)) {
           fs::remove(infoFilePath);
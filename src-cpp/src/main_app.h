@@ -1,12 +1,21 @@
 #ifndef CLIPBOOK_MAIN_APP_H_
 #define CLIPBOOK_MAIN_APP_H_
 
+#include <condition_variable>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
-#include <list>
+#include <thread>
+#include <unordered_set>
 
 #include "mobrowser.hpp"
 #include "app_settings.h"
+#include "blob_store.h"
+#include "clip_log.h"
+#include "image_index.h"
+#include "image_optimizer.h"
+#include "thumbnail_pipeline.h"
 #include "url_request_interceptor.h"
 #include "webview.h"
 
@@ -19,12 +28,18 @@ class MainApp : public std::enable_shared_from_this<MainApp> {
   };
   explicit MainApp(const std::shared_ptr<mobrowser::App> &app,
                    const std::shared_ptr<AppSettings> &settings);
+  ~MainApp();
 
   static void updateLanguage(std::shared_ptr<mobrowser::Browser> window);
 
   [[nodiscard]] std::shared_ptr<mobrowser::App> app() const;
   [[nodiscard]] std::shared_ptr<mobrowser::Browser> browser() const;
   [[nodiscard]] std::shared_ptr<AppSettings> settings() const;
+  [[nodiscard]] std::shared_ptr<BlobStore> imageStore() const;
+  [[nodiscard]] std::shared_ptr<BlobStore> textStore() const;
+  [[nodiscard]] std::shared_ptr<ClipLog> clipLog() const;
+  [[nodiscard]] std::shared_ptr<ImageIndex> imageIndex() const;
+  [[nodiscard]] std::shared_ptr<ThumbnailPipeline> thumbnailPipeline() const;
 
   void pause();
   void resume();
@@ -34,6 +49,7 @@ class MainApp : public std::enable_shared_from_this<MainApp> {
   void showWelcomeWindow();
 
   std::string getImagesDir();
+  std::string getTextsDir();
   std::string getLinkImagesDir();
 
   virtual bool init();
@@ -59,6 +75,7 @@ class MainApp : public std::enable_shared_from_this<MainApp> {
                                const std::string &filePath,
                                bool ghost) = 0;
   virtual void copyToClipboardAfterMerge(std::string text) = 0;
+  virtual std::string getIngestionStats() = 0;
   virtual void setOpenAtLogin(bool open) = 0;
   virtual AppInfo getAppInfo() = 0;
   virtual AppInfo getActiveAppInfo() = 0;
@@ -92,6 +109,12 @@ class MainApp : public std::enable_shared_from_this<MainApp> {
                              const std::string &assetRequests);
   void importClipBookArchive();
   void notifyClipBookArchiveImported();
+  void notifyThumbnailReady(const std::string &fileName);
+  void notifyClipsAvailable();
+  std::string readClips(int afterSequence);
+  void optimizeImages();
+  void stopImageOptimization();
+  std::string getImageStorageStats();
   std::string copyClipBookArchiveAsset(const std::string &archiveRoot,
                                        const std::string &relativePath,
                                        bool linkPreview,
@@ -103,6 +126,8 @@ class MainApp : public std::enable_shared_from_this<MainApp> {
   void destroyTray();
   void initJavaScriptApi(const std::shared_ptr<mobrowser::JsObject> &window);
   void deleteImage(const std::string &imageFileName);
+  std::string readText(const std::string &textFileName);
+  void deleteText(const std::string &textFileName);
   void deleteLinkImage(const std::string &imageFileName);
   void fetchLinkPreviewDetails(const std::string &url, const std::shared_ptr<mobrowser::JsObject> &callback);
   void previewLink(const std::string &url);
@@ -168,10 +193,23 @@ class MainApp : public std::enable_shared_from_this<MainApp> {
   std::shared_ptr<mobrowser::CustomMenuItem> support_item_;
   std::shared_ptr<AppSettings> settings_;
 
-  std::list<std::string> fetch_url_requests_;
+  // The canonical URL hashes of the link previews being fetched.
+  std::unordered_set<uint64_t> fetch_url_requests_;
+  std::mutex fetch_url_requests_mutex_;
 
  private:
   std::shared_ptr<UrlRequestInterceptor> request_interceptor_;
+  std::shared_ptr<BlobStore> image_store_;
+  std::shared_ptr<BlobStore> text_store_;
+  std::shared_ptr<ClipLog> clip_log_;
+  std::shared_ptr<ImageIndex> image_index_;
+  std::shared_ptr<ThumbnailPipeline> thumbnail_pipeline_;
+  std::shared_ptr<ImageOptimizer> image_optimizer_;
+  // The optimization runs once in a while until the app quits.
+  std::thread image_optimizer_thread_;
+  std::mutex image_optimizer_mutex_;
+  std::condition_variable image_optimizer_stop_;
+  bool image_optimizer_stopped_ = false;
 };
 
 #endif // CLIPBOOK_MAIN_APP_H_
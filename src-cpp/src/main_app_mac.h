@@ -41,6 +41,7 @@ class MainAppMac : public MainApp {
                        const std::string &filePath,
                        bool ghost) override;
   void copyToClipboardAfterMerge(std::string text) override;
+  std::string getIngestionStats() override;
   void setOpenAtLogin(bool open) override;
   AppInfo getAppInfo() override;
   AppInfo getActiveAppInfo() override;
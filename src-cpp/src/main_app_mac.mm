@@ -583,6 +583,10 @@ void MainAppMac::copyToClipboardAfterMerge(std::string text) {
   clipboard_reader_->copyToClipboardAfterMerge(std::move(text));
 }
 
+std::string MainAppMac::getIngestionStats() {
+  return clipboard_reader_->getIngestionStats();
+}
+
 std::string MainAppMac::getUpdateServerUrl() {
   if (isAppleSilicon()) {
     return "https://clipbook.app/downloads/mac/arm64";
@@ -0,0 +1,27 @@
+#ifndef CLIPBOOK_MAPPED_FILE_H_
+#define CLIPBOOK_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+
+// A read-only memory mapping of a whole file. The mapping is released when
+// the object is destroyed.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &path);
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile();
+
+  // Indicates if the file has been mapped successfully.
+  [[nodiscard]] bool isValid() const;
+
+  [[nodiscard]] const char *data() const;
+  [[nodiscard]] std::size_t size() const;
+
+ private:
+  void *data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+#endif  // CLIPBOOK_MAPPED_FILE_H_
@@ -0,0 +1,14 @@
+#ifndef CLIPBOOK_MIME_TYPES_H_
+#define CLIPBOOK_MIME_TYPES_H_
+
+#include <functional>
+#include <string_view>
+
+// Returns the MIME type for the given lowercase file extension without the
+// leading dot or an empty string if the extension is unknown.
+std::string_view getMimeType(std::string_view extension);
+
+// Calls the function for every known extension and its MIME type.
+void forEachMimeType(const std::function<void(std::string_view, std::string_view)> &function);
+
+#endif  // CLIPBOOK_MIME_TYPES_H_
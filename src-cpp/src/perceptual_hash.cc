@@ -0,0 +1,132 @@
+#include "perceptual_hash.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+constexpr int kHashWidth = 9;
+constexpr int kHashHeight = 8;
+
+}  // namespace
+
+uint64_t computeDifferenceHash(const uint8_t *pixels, int width, int height, std::size_t bytes_per_row) {
+  if (pixels == nullptr || width <= 0 || height <= 0) {
+    return 0;
+  }
+  // Average the pixels of every cell of the 9x8 grid. The cells of an image
+  // smaller than the grid overlap.
+  uint32_t cells[kHashHeight][kHashWidth];
+  for (int cy = 0; cy < kHashHeight; ++cy) {
+    int y0 = cy * height / kHashHeight;
+    int y1 = std::max((cy + 1) * height / kHashHeight, y0 + 1);
+    for (int cx = 0; cx < kHashWidth; ++cx) {
+      int x0 = cx * width / kHashWidth;
+      int x1 = std::max((cx + 1) * width / kHashWidth, x0 + 1);
+      uint64_t sum = 0;
+      for (int y = y0; y < y1; ++y) {
+        const uint8_t *row = pixels + y * bytes_per_row;
+        for (int x = x0; x < x1; ++x) {
+          sum += row[x];
+        }
+      }
+      cells[cy][cx] = static_cast<uint32_t>(sum / ((y1 - y0) * (x1 - x0)));
+    }
+  }
+  uint64_t hash = 0;
+  for (int cy = 0; cy < kHashHeight; ++cy) {
+    for (int cx = 0; cx < kHashWidth - 1; ++cx) {
+      hash = (hash << 1) | (cells[cy][cx] > cells[cy][cx + 1] ? 1 : 0);
+    }
+  }
+  return hash;
+}
+
+int hammingDistance(uint64_t a, uint64_t b) {
+  return std::popcount(a ^ b);
+}
+
+void HammingTree::insert(uint64_t hash, const std::string &value) {
+  remove(value);
+  auto index = static_cast<uint32_t>(nodes_.size());
+  nodes_.push_back({hash, value, false, {}});
+  indices_[value] = index;
+  if (index == 0) {
+    return;
+  }
+  uint32_t current = 0;
+  while (true) {
+    int distance = hammingDistance(nodes_[current].hash, hash);
+    bool found = false;
+    for (const auto &[child_distance, child] : nodes_[current].children) {
+      if (child_distance == distance) {
+        current = child;
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      nodes_[current].children.emplace_back(distance, index);
+      return;
+    }
+  }
+}
+
+void HammingTree::remove(const std::string &value) {
+  auto it = indices_.find(value);
+  if (it == indices_.end()) {
+    return;
+  }
+  nodes_[it->second].removed = true;
+  indices_.erase(it);
+  removed_count_++;
+  if (removed_count_ > 64 && removed_count_ * 2 > nodes_.size()) {
+    rebuild();
+  }
+}
+
+std::string HammingTree::findClosest(uint64_t hash, int max_distance) const {
+  if (nodes_.empty() || max_distance < 0) {
+    return "";
+  }
+  const Node *closest = nullptr;
+  int closest_distance = max_distance + 1;
+  std::vector<uint32_t> stack = {0};
+  while (!stack.empty()) {
+    const auto &node = nodes_[stack.back()];
+    stack.pop_back();
+    int distance = hammingDistance(node.hash, hash);
+    if (!node.removed && distance < closest_distance) {
+      closest = &node;
+      closest_distance = distance;
+      if (distance == 0) {
+        break;
+      }
+    }
+    // By the triangle inequality, only the children at the distance
+    // [distance - radius, distance + radius] can contain a closer hash.
+    int radius = closest_distance - 1;
+    for (const auto &[child_distance, child] : node.children) {
+      if (child_distance >= distance - radius && child_distance <= distance + radius) {
+        stack.push_back(child);
+      }
+    }
+  }
+  return closest ? closest->value : "";
+}
+
+std::size_t HammingTree::size() const {
+  return indices_.size();
+}
+
+void HammingTree::rebuild() {
+  auto nodes = std::move(nodes_);
+  nodes_.clear();
+  indices_.clear();
+  removed_count_ = 0;
+  for (const auto &node : nodes) {
+    if (!node.removed) {
+      insert(node.hash, node.value);
+    }
+  }
+}
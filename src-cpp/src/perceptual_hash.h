@@ -0,0 +1,54 @@
+#ifndef CLIPBOOK_PERCEPTUAL_HASH_H_
+#define CLIPBOOK_PERCEPTUAL_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Returns the 64-bit difference hash (dHash) of the 8-bit grayscale image.
+// The image is downscaled to 9x8 pixels with a box filter and every bit of
+// the hash tells if a pixel is brighter than its right neighbour, so the
+// images that differ in small details, e.g. a cursor or a clock, have the
+// hashes that differ in a few bits.
+uint64_t computeDifferenceHash(const uint8_t *pixels, int width, int height, std::size_t bytes_per_row);
+
+int hammingDistance(uint64_t a, uint64_t b);
+
+// A BK-tree of 64-bit hashes with the Hamming distance metric. The tree
+// finds the hashes within a small distance from the given one visiting a
+// small fraction of the nodes. The removed values are only marked as
+// removed and the tree is rebuilt when most of its nodes are removed.
+class HammingTree {
+ public:
+  void insert(uint64_t hash, const std::string &value);
+  void remove(const std::string &value);
+
+  /**
+   * Returns the value with the closest hash within the given distance or
+   * an empty string if there is no such value.
+   */
+  [[nodiscard]] std::string findClosest(uint64_t hash, int max_distance) const;
+
+  [[nodiscard]] std::size_t size() const;
+
+ private:
+  struct Node {
+    uint64_t hash = 0;
+    std::string value;
+    bool removed = false;
+    // The child node indices by their distance from this node.
+    std::vector<std::pair<int, uint32_t>> children;
+  };
+
+  void rebuild();
+
+ private:
+  std::vector<Node> nodes_;
+  std::unordered_map<std::string, uint32_t> indices_;
+  std::size_t removed_count_ = 0;
+};
+
+#endif  // CLIPBOOK_PERCEPTUAL_HASH_H_
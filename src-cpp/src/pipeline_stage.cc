@@ -0,0 +1,96 @@
+#include "pipeline_stage.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "request_metrics.h"
+
+namespace {
+
+std::chrono::microseconds elapsedSince(std::chrono::steady_clock::time_point time) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - time);
+}
+
+}  // namespace
+
+PipelineStage::PipelineStage(std::string name, std::size_t max_queue_size, bool drain) :
+    name_(std::move(name)),
+    max_queue_size_(std::max<std::size_t>(1, max_queue_size)),
+    drain_(drain) {
+  thread_ = std::thread([this]() {
+    run();
+  });
+}
+
+PipelineStage::~PipelineStage() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stopped_ = true;
+    if (!drain_) {
+      tasks_.clear();
+    }
+  }
+  task_posted_.notify_all();
+  task_taken_.notify_all();
+  thread_.join();
+}
+
+void PipelineStage::post(std::function<void()> task) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    task_taken_.wait(lock, [this]() {
+      return stopped_ || tasks_.size() < max_queue_size_;
+    });
+    if (stopped_) {
+      return;
+    }
+    tasks_.push_back({std::move(task), std::chrono::steady_clock::now()});
+  }
+  task_posted_.notify_one();
+}
+
+const std::string &PipelineStage::name() const {
+  return name_;
+}
+
+std::size_t PipelineStage::queueSize() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return tasks_.size();
+}
+
+const LatencyHistogram &PipelineStage::waitTime() const {
+  return wait_time_;
+}
+
+const LatencyHistogram &PipelineStage::runTime() const {
+  return run_time_;
+}
+
+std::string PipelineStage::toJson() {
+  return "{\"queued\":" + std::to_string(queueSize()) +
+         ",\"waitUs\":" + latencyToJson(wait_time_) +
+         ",\"runUs\":" + latencyToJson(run_time_) + "}";
+}
+
+void PipelineStage::run() {
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      task_posted_.wait(lock, [this]() {
+        return stopped_ || !tasks_.empty();
+      });
+      // The stopped stage exits once the tasks left to drain are done.
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task_taken_.notify_one();
+    wait_time_.record(elapsedSince(task.post_time));
+    auto start_time = std::chrono::steady_clock::now();
+    task.run();
+    run_time_.record(elapsedSince(start_time));
+  }
+}
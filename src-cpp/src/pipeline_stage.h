@@ -0,0 +1,68 @@
+#ifndef CLIPBOOK_PIPELINE_STAGE_H_
+#define CLIPBOOK_PIPELINE_STAGE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "latency_histogram.h"
+
+// A stage of a pipeline: a single thread executing the tasks from a bounded
+// queue in the order they were posted. Posting to a full stage blocks, so a
+// slow stage holds back the stages before it instead of growing its queue.
+//
+// A draining stage runs all the queued tasks before it's destroyed, e.g. the
+// tasks that must not lose the data they carry. Otherwise the tasks that have
+// not started yet are dropped.
+class PipelineStage {
+ public:
+  PipelineStage(std::string name, std::size_t max_queue_size, bool drain = false);
+  PipelineStage(const PipelineStage &) = delete;
+  PipelineStage &operator=(const PipelineStage &) = delete;
+  ~PipelineStage();
+
+  /**
+   * Schedules the task for execution after the previously posted tasks.
+   * Waits while the queue is full. The task is dropped if the stage is
+   * being destroyed.
+   */
+  void post(std::function<void()> task);
+
+  [[nodiscard]] const std::string &name() const;
+  [[nodiscard]] std::size_t queueSize();
+
+  // The time between posting a task and its start.
+  [[nodiscard]] const LatencyHistogram &waitTime() const;
+  // The time a task is executed.
+  [[nodiscard]] const LatencyHistogram &runTime() const;
+
+  // Returns the queue size and the latencies of the stage as a JSON object.
+  [[nodiscard]] std::string toJson();
+
+ private:
+  struct Task {
+    std::function<void()> run;
+    std::chrono::steady_clock::time_point post_time;
+  };
+
+  void run();
+
+ private:
+  const std::string name_;
+  const std::size_t max_queue_size_;
+  const bool drain_;
+  bool stopped_ = false;
+  std::deque<Task> tasks_;
+  LatencyHistogram wait_time_;
+  LatencyHistogram run_time_;
+  std::mutex mutex_;
+  std::condition_variable task_posted_;
+  std::condition_variable task_taken_;
+  std::thread thread_;
+};
+
+#endif  // CLIPBOOK_PIPELINE_STAGE_H_
@@ -0,0 +1,303 @@
+#include "png.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+constexpr std::string_view kSignature("\x89PNG\r\n\x1a\n", 8);
+// The largest decoded image that is re-encoded.
+constexpr uint64_t kMaxDataSize = 1ull << 30;
+
+enum FilterType {
+  kFilterNone = 0,
+  kFilterSub,
+  kFilterUp,
+  kFilterAverage,
+  kFilterPaeth,
+  kFilterTypesCount
+};
+
+struct Chunk {
+  std::string_view type;
+  std::string_view data;
+};
+
+uint8_t paethPredictor(int a, int b, int c) {
+  int p = a + b - c;
+  int pa = std::abs(p - a);
+  int pb = std::abs(p - b);
+  int pc = std::abs(p - c);
+  if (pa <= pb && pa <= pc) {
+    return static_cast<uint8_t>(a);
+  }
+  return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+int predict(int type, int left, int up, int up_left) {
+  switch (type) {
+    case kFilterSub:
+      return left;
+    case kFilterUp:
+      return up;
+    case kFilterAverage:
+      return (left + up) / 2;
+    case kFilterPaeth:
+      return paethPredictor(left, up, up_left);
+    default:
+      return 0;
+  }
+}
+
+// Applies the filter of the given type to the row.
+void filterRow(int type, const uint8_t *row, const uint8_t *previous, std::size_t size, std::size_t bpp,
+               uint8_t *result) {
+  for (std::size_t i = 0; i < size; ++i) {
+    int left = i >= bpp ? row[i - bpp] : 0;
+    int up_left = i >= bpp ? previous[i - bpp] : 0;
+    result[i] = static_cast<uint8_t>(row[i] - predict(type, left, previous[i], up_left));
+  }
+}
+
+// Reverts the filter of the given type in place.
+void unfilterRow(int type, uint8_t *row, const uint8_t *previous, std::size_t size, std::size_t bpp) {
+  for (std::size_t i = 0; i < size; ++i) {
+    int left = i >= bpp ? row[i - bpp] : 0;
+    int up_left = i >= bpp ? previous[i - bpp] : 0;
+    row[i] = static_cast<uint8_t>(row[i] + predict(type, left, previous[i], up_left));
+  }
+}
+
+// Estimates how well the filtered row compresses, the lower the better.
+uint64_t getFilteredRowCost(const uint8_t *row, std::size_t size) {
+  uint64_t cost = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    cost += std::abs(static_cast<int8_t>(row[i]));
+  }
+  return cost;
+}
+
+uint32_t readUint32(const char *data) {
+  auto bytes = reinterpret_cast<const uint8_t *>(data);
+  return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+         (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+}
+
+void appendUint32(std::string &output, uint32_t value) {
+  output.push_back(static_cast<char>(value >> 24));
+  output.push_back(static_cast<char>(value >> 16));
+  output.push_back(static_cast<char>(value >> 8));
+  output.push_back(static_cast<char>(value));
+}
+
+int getChannelsCount(int color_type) {
+  switch (color_type) {
+    case 0:  // Grayscale.
+    case 3:  // Palette.
+      return 1;
+    case 2:  // RGB.
+      return 3;
+    case 4:  // Grayscale with alpha.
+      return 2;
+    case 6:  // RGBA.
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+// Indicates if the chunk stays valid once the image data is re-encoded. The
+// unknown chunks that are not marked as safe to copy, e.g. the "iDOT" chunk
+// with the offsets of the image data, are dropped.
+bool shouldCopyChunk(std::string_view type) {
+  static constexpr std::string_view kKnownChunks[] = {
+      "PLTE", "tRNS", "cHRM", "gAMA", "iCCP", "sBIT", "sRGB", "cICP", "bKGD", "hIST",
+      "pHYs", "sPLT", "eXIf", "tIME", "tEXt", "zTXt", "iTXt"};
+  if (std::find(std::begin(kKnownChunks), std::end(kKnownChunks), type) != std::end(kKnownChunks)) {
+    return true;
+  }
+  // The fourth letter is lowercase in the chunks that are safe to copy.
+  return (type[3] & 0x20) != 0;
+}
+
+bool deflateData(const std::vector<uint8_t> &data, int strategy, std::string &result) {
+  z_stream stream{};
+  if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15, 9, strategy) != Z_OK) {
+    return false;
+  }
+  result.resize(deflateBound(&stream, static_cast<uLong>(data.size())));
+  stream.next_in = const_cast<Bytef *>(data.data());
+  stream.avail_in = static_cast<uInt>(data.size());
+  stream.next_out = reinterpret_cast<Bytef *>(result.data());
+  stream.avail_out = static_cast<uInt>(result.size());
+  auto status = deflate(&stream, Z_FINISH);
+  result.resize(stream.total_out);
+  deflateEnd(&stream);
+  return status == Z_STREAM_END;
+}
+
+}  // namespace
+
+std::vector<uint8_t> filterPngRows(const uint8_t *rows, std::size_t row_size, int rows_count, int bytes_per_pixel) {
+  auto bpp = static_cast<std::size_t>(bytes_per_pixel);
+  std::vector<uint8_t> result((row_size + 1) * rows_count);
+  std::vector<uint8_t> previous(row_size, 0);
+  std::vector<uint8_t> filtered(row_size);
+  std::vector<uint8_t> best(row_size);
+  const uint8_t *previous_row = previous.data();
+  for (int y = 0; y < rows_count; ++y) {
+    const uint8_t *row = rows + y * row_size;
+    int best_type = kFilterNone;
+    uint64_t best_cost = UINT64_MAX;
+    for (int type = kFilterNone; type < kFilterTypesCount; ++type) {
+      filterRow(type, row, previous_row, row_size, bpp, filtered.data());
+      auto cost = getFilteredRowCost(filtered.data(), row_size);
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_type = type;
+        best.swap(filtered);
+      }
+    }
+    uint8_t *target = result.data() + y * (row_size + 1);
+    target[0] = static_cast<uint8_t>(best_type);
+    std::memcpy(target + 1, best.data(), row_size);
+    previous_row = row;
+  }
+  return result;
+}
+
+void appendPngChunk(std::string &png, const char *type, const void *data, std::size_t size) {
+  appendUint32(png, static_cast<uint32_t>(size));
+  auto chunk_begin = png.size();
+  png.append(type, 4);
+  if (size > 0) {
+    png.append(static_cast<const char *>(data), size);
+  }
+  auto crc = crc32(0, reinterpret_cast<const Bytef *>(png.data() + chunk_begin),
+                   static_cast<uInt>(png.size() - chunk_begin));
+  appendUint32(png, static_cast<uint32_t>(crc));
+}
+
+bool optimizePng(std::string_view png, std::string &result) {
+  if (!png.starts_with(kSignature)) {
+    return false;
+  }
+  // The image data is split into the IDAT chunks that follow each other.
+  // The chunks before and after them are copied as is.
+  std::vector<Chunk> leading_chunks;
+  std::vector<Chunk> trailing_chunks;
+  std::string compressed;
+  bool end_found = false;
+  std::size_t pos = kSignature.size();
+  while (!end_found && pos + 12 <= png.size()) {
+    auto length = readUint32(png.data() + pos);
+    if (length > png.size() - pos - 12) {
+      return false;
+    }
+    Chunk chunk{png.substr(pos + 4, 4), png.substr(pos + 8, length)};
+    auto crc = crc32(0, reinterpret_cast<const Bytef *>(png.data() + pos + 4), length + 4);
+    if (crc != readUint32(png.data() + pos + 8 + length)) {
+      return false;
+    }
+    pos += 12 + length;
+    if (chunk.type == "IDAT") {
+      if (!trailing_chunks.empty()) {
+        return false;
+      }
+      compressed.append(chunk.data);
+    } else if (chunk.type == "IEND") {
+      end_found = true;
+    } else if ((chunk.type[0] & 0x20) == 0 && chunk.type != "IHDR" && chunk.type != "PLTE") {
+      // An unknown critical chunk, the image data cannot be interpreted.
+      return false;
+    } else if (chunk.type == "IHDR" || shouldCopyChunk(chunk.type)) {
+      (compressed.empty() ? leading_chunks : trailing_chunks).push_back(chunk);
+    }
+  }
+  if (!end_found || compressed.empty() || leading_chunks.empty() || leading_chunks[0].type != "IHDR" ||
+      leading_chunks[0].data.size() != 13) {
+    return false;
+  }
+
+  const char *header = leading_chunks[0].data.data();
+  uint64_t width = readUint32(header);
+  uint64_t height = readUint32(header + 4);
+  int bit_depth = static_cast<uint8_t>(header[8]);
+  int color_type = static_cast<uint8_t>(header[9]);
+  int interlace_method = static_cast<uint8_t>(header[12]);
+  int channels = getChannelsCount(color_type);
+  if (width == 0 || height == 0 || channels == 0 || interlace_method != 0 ||
+      (bit_depth != 1 && bit_depth != 2 && bit_depth != 4 && bit_depth != 8 && bit_depth != 16)) {
+    return false;
+  }
+  uint64_t bits_per_pixel = channels * bit_depth;
+  uint64_t row_size = (width * bits_per_pixel + 7) / 8;
+  uint64_t data_size = (row_size + 1) * height;
+  if (data_size > kMaxDataSize) {
+    return false;
+  }
+  auto bpp = std::max<std::size_t>(1, bits_per_pixel / 8);
+
+  std::vector<uint8_t> data(data_size);
+  auto inflated_size = static_cast<uLongf>(data_size);
+  if (uncompress(data.data(), &inflated_size, reinterpret_cast<const Bytef *>(compressed.data()),
+                 static_cast<uLong>(compressed.size())) != Z_OK || inflated_size != data_size) {
+    return false;
+  }
+  std::vector<uint8_t> rows(row_size * height);
+  std::vector<uint8_t> zero_row(row_size, 0);
+  for (uint64_t y = 0; y < height; ++y) {
+    const uint8_t *source = data.data() + y * (row_size + 1);
+    if (source[0] >= kFilterTypesCount) {
+      return false;
+    }
+    uint8_t *row = rows.data() + y * row_size;
+    std::memcpy(row, source + 1, row_size);
+    unfilterRow(source[0], row, y > 0 ? row - row_size : zero_row.data(), row_size, bpp);
+  }
+
+  // The adaptive filtering does not suit the palette and low bit depth
+  // images, they usually compress better unfiltered.
+  std::vector<std::vector<uint8_t>> candidates;
+  candidates.push_back(filterPngRows(rows.data(), row_size, static_cast<int>(height), static_cast<int>(bpp)));
+  if (color_type == 3 || bit_depth < 8) {
+    auto &unfiltered = candidates.emplace_back(data_size);
+    for (uint64_t y = 0; y < height; ++y) {
+      uint8_t *target = unfiltered.data() + y * (row_size + 1);
+      target[0] = kFilterNone;
+      std::memcpy(target + 1, rows.data() + y * row_size, row_size);
+    }
+  }
+  std::string best;
+  for (const auto &candidate : candidates) {
+    for (int strategy : {Z_DEFAULT_STRATEGY, Z_FILTERED}) {
+      std::string deflated;
+      if (deflateData(candidate, strategy, deflated) && (best.empty() || deflated.size() < best.size())) {
+        best = std::move(deflated);
+      }
+    }
+  }
+  if (best.empty()) {
+    return false;
+  }
+
+  std::string output;
+  output.reserve(png.size());
+  output.append(kSignature);
+  for (const auto &chunk : leading_chunks) {
+    appendPngChunk(output, chunk.type.data(), chunk.data.data(), chunk.data.size());
+  }
+  appendPngChunk(output, "IDAT", best.data(), best.size());
+  for (const auto &chunk : trailing_chunks) {
+    appendPngChunk(output, chunk.type.data(), chunk.data.data(), chunk.data.size());
+  }
+  appendPngChunk(output, "IEND", nullptr, 0);
+  if (output.size() >= png.size()) {
+    return false;
+  }
+  result = std::move(output);
+  return true;
+}
@@ -0,0 +1,24 @@
+#ifndef CLIPBOOK_PNG_H_
+#define CLIPBOOK_PNG_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Filters the rows of pixels for compression. Every row of the result is
+// prefixed with the type of the filter that is expected to compress the row
+// best.
+std::vector<uint8_t> filterPngRows(const uint8_t *rows, std::size_t row_size, int rows_count, int bytes_per_pixel);
+
+// Appends the chunk with the given four-character type to the PNG data.
+void appendPngChunk(std::string &png, const char *type, const void *data, std::size_t size);
+
+// Re-encodes the PNG image with the adaptive filtering and the best zlib
+// compression. The pixels, the color type, the color profile and the other
+// chunks are kept as is, so the image stays byte-for-byte the same once
+// decoded. Returns false if the image cannot be re-encoded, e.g. it's
+// interlaced, or the result is not smaller.
+bool optimizePng(std::string_view png, std::string &result);
+
+#endif  // CLIPBOOK_PNG_H_
@@ -0,0 +1,23 @@
+#include "request_metrics.h"
+
+void HostMetrics::record(uint64_t bytes_served, std::chrono::microseconds request_latency) {
+  requests.fetch_add(1, std::memory_order_relaxed);
+  bytes.fetch_add(bytes_served, std::memory_order_relaxed);
+  latency.record(request_latency);
+}
+
+std::string HostMetrics::toJson() const {
+  return "{\"requests\":" + std::to_string(requests.load(std::memory_order_relaxed)) +
+         ",\"bytes\":" + std::to_string(bytes.load(std::memory_order_relaxed)) +
+         ",\"cacheHits\":" + std::to_string(cache_hits.load(std::memory_order_relaxed)) +
+         ",\"notModified\":" + std::to_string(not_modified.load(std::memory_order_relaxed)) +
+         ",\"failures\":" + std::to_string(failures.load(std::memory_order_relaxed)) +
+         ",\"latencyUs\":" + latencyToJson(latency) + "}";
+}
+
+std::string latencyToJson(const LatencyHistogram &latency) {
+  return "{\"count\":" + std::to_string(latency.count()) +
+         ",\"p50\":" + std::to_string(latency.percentile(50).count()) +
+         ",\"p95\":" + std::to_string(latency.percentile(95).count()) +
+         ",\"p99\":" + std::to_string(latency.percentile(99).count()) + "}";
+}
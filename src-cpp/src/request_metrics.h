@@ -0,0 +1,37 @@
+#ifndef CLIPBOOK_REQUEST_METRICS_H_
+#define CLIPBOOK_REQUEST_METRICS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "latency_histogram.h"
+
+// The counters of the requests to a single host of the clipbook:// scheme.
+// All counters are lock-free, so they can be updated from any thread.
+struct HostMetrics {
+  std::atomic<uint64_t> requests = 0;
+  std::atomic<uint64_t> bytes = 0;
+  // The responses served from the in-memory cache.
+  std::atomic<uint64_t> cache_hits = 0;
+  // The 304 responses telling the browser to use its own cached copy.
+  std::atomic<uint64_t> not_modified = 0;
+  std::atomic<uint64_t> failures = 0;
+  LatencyHistogram latency;
+
+  void record(uint64_t bytes_served, std::chrono::microseconds request_latency);
+
+  [[nodiscard]] std::string toJson() const;
+};
+
+struct RequestMetrics {
+  HostMetrics app;
+  HostMetrics images;
+  // The requests passed through to the browser with action.proceed().
+  std::atomic<uint64_t> proceeded = 0;
+};
+
+// Returns the latency percentiles of the histogram as a JSON object.
+std::string latencyToJson(const LatencyHistogram &latency);
+
+#endif  // CLIPBOOK_REQUEST_METRICS_H_
@@ -0,0 +1,60 @@
+#include "request_path.h"
+
+#include <unordered_set>
+
+namespace {
+
+// The client-side routes of the app served by index.html, without the leading slash.
+const std::unordered_set<std::string_view> kRoutingPages = {
+    "welcome", "accessibility", "enjoy", "settings", "settings/history", "settings/shortcuts", "settings/privacy", "settings/license", "settings/tags", "settings/about", "settings/storage"
+};
+
+// Indicates if the path segment refers to the parent directory, including
+// its percent-encoded forms such as "%2e%2e".
+bool isParentDirSegment(std::string_view segment) {
+  int dots = 0;
+  std::size_t i = 0;
+  while (i < segment.size()) {
+    if (segment[i] == '.') {
+      i += 1;
+    } else if (segment.substr(i, 3) == "%2e" || segment.substr(i, 3) == "%2E") {
+      i += 3;
+    } else {
+      return false;
+    }
+    dots++;
+  }
+  return dots == 2;
+}
+
+}  // namespace
+
+bool isRoutingPage(std::string_view path) {
+  while (!path.empty() && path.back() == '/') {
+    path.remove_suffix(1);
+  }
+  return kRoutingPages.contains(path);
+}
+
+bool resolvePath(std::string_view base_dir, std::string_view path, std::string &result) {
+  result.clear();
+  result.reserve(base_dir.size() + path.size() + 1);
+  result.append(base_dir);
+  while (!path.empty()) {
+    auto slash = path.find('/');
+    auto segment = path.substr(0, slash);
+    if (isParentDirSegment(segment) || segment.find('\\') != std::string_view::npos ||
+        segment.find('\0') != std::string_view::npos) {
+      return false;
+    }
+    if (!segment.empty() && segment != ".") {
+      result.push_back('/');
+      result.append(segment);
+    }
+    if (slash == std::string_view::npos) {
+      break;
+    }
+    path.remove_prefix(slash + 1);
+  }
+  return true;
+}
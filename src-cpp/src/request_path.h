@@ -0,0 +1,15 @@
+#ifndef CLIPBOOK_REQUEST_PATH_H_
+#define CLIPBOOK_REQUEST_PATH_H_
+
+#include <string>
+#include <string_view>
+
+// Indicates if the URL path without the leading slash is a client-side
+// route of the app served by index.html, e.g. "settings/history".
+bool isRoutingPage(std::string_view path);
+
+// Appends the relative URL path to the base directory. Empty and "." segments
+// are skipped. Returns false if the path tries to leave the base directory.
+bool resolvePath(std::string_view base_dir, std::string_view path, std::string &result);
+
+#endif  // CLIPBOOK_REQUEST_PATH_H_
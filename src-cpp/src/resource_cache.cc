@@ -0,0 +1,128 @@
+#include "resource_cache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+#include "hash.h"
+
+namespace fs = std::filesystem;
+
+// A single file may take at most this fraction of the cache budget.
+static const std::size_t kMaxEntryFraction = 4;
+// The maximum number of remembered paths of the files that do not exist.
+// Any path can be requested, so the set is cleared when it's full.
+static const std::size_t kMaxMissingPathsCount = 1024;
+
+ResourceCache::ResourceCache(std::size_t max_bytes) : max_bytes_(max_bytes) {}
+
+void ResourceCache::preload(const std::string &dir) {
+  std::error_code error;
+  fs::recursive_directory_iterator it(dir, error);
+  if (error) {
+    return;
+  }
+  for (const auto &entry : it) {
+    if (sizeInBytes() >= max_bytes_) {
+      break;
+    }
+    if (entry.is_regular_file(error)) {
+      read(entry.path().string(), false);
+    }
+  }
+}
+
+std::shared_ptr<const Resource> ResourceCache::get(const std::string &path) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = index_.find(path);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+  hits_++;
+  // Move the entry to the front of the list as the most recently used one.
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->resource;
+}
+
+std::shared_ptr<const Resource> ResourceCache::load(const std::string &path) {
+  return read(path, true);
+}
+
+std::shared_ptr<const Resource> ResourceCache::read(const std::string &path, bool count_miss) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (missing_paths_.contains(path)) {
+      return nullptr;
+    }
+  }
+  std::error_code error;
+  auto file_size = fs::file_size(path, error);
+  if (error == std::errc::no_such_file_or_directory) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (missing_paths_.size() >= kMaxMissingPathsCount) {
+      missing_paths_.clear();
+    }
+    missing_paths_.insert(path);
+    return nullptr;
+  }
+  if (count_miss) {
+    misses_++;
+  }
+  if (error || file_size > max_bytes_ / kMaxEntryFraction) {
+    return nullptr;
+  }
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    return nullptr;
+  }
+  std::string data(file_size, '\0');
+  file.read(data.data(), static_cast<std::streamsize>(file_size));
+  if (file.gcount() != static_cast<std::streamsize>(file_size)) {
+    return nullptr;
+  }
+  return add(path, std::move(data));
+}
+
+std::shared_ptr<const Resource> ResourceCache::add(const std::string &path, std::string data) {
+  auto resource = std::make_shared<Resource>();
+  resource->data = std::move(data);
+  resource->etag = "\"" + hashToHex(hash64(resource->data)) + "\"";
+  if (resource->data.size() <= max_bytes_ / kMaxEntryFraction) {
+    put(path, resource);
+  }
+  return resource;
+}
+
+uint64_t ResourceCache::hits() const {
+  return hits_;
+}
+
+uint64_t ResourceCache::misses() const {
+  return misses_;
+}
+
+std::size_t ResourceCache::sizeInBytes() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return size_in_bytes_;
+}
+
+void ResourceCache::put(const std::string &path, const std::shared_ptr<const Resource> &resource) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = index_.find(path);
+  if (it != index_.end()) {
+    size_in_bytes_ -= it->second->resource->data.size();
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  // Evict the least recently used entries until the new entry fits.
+  while (!entries_.empty() && size_in_bytes_ + resource->data.size() > max_bytes_) {
+    auto &last = entries_.back();
+    size_in_bytes_ -= last.resource->data.size();
+    index_.erase(last.path);
+    entries_.pop_back();
+  }
+  entries_.push_front({path, resource});
+  index_[path] = entries_.begin();
+  size_in_bytes_ += resource->data.size();
+}
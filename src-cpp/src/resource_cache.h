@@ -0,0 +1,71 @@
+#ifndef CLIPBOOK_RESOURCE_CACHE_H_
+#define CLIPBOOK_RESOURCE_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// The contents of a cached file.
+struct Resource {
+  std::string data;
+  // The entity tag derived from the contents of the file.
+  std::string etag;
+};
+
+// A thread-safe in-memory LRU cache of file contents keyed by the file path.
+// The total size of the cached contents never exceeds the given byte budget.
+class ResourceCache {
+ public:
+  explicit ResourceCache(std::size_t max_bytes);
+
+  // Reads all files in the given directory and its subdirectories into the
+  // cache until the byte budget is exhausted.
+  void preload(const std::string &dir);
+
+  // Returns the cached contents of the file or nullptr if the file is not
+  // cached. Only the found files are counted, as a file might be looked up
+  // just to check if it's cached, e.g. a precompressed copy of a file.
+  std::shared_ptr<const Resource> get(const std::string &path);
+
+  // Reads the file into the cache and returns its contents. Returns nullptr if
+  // the file cannot be read or is too large to be cached. A limited number
+  // of the files that do not exist are remembered and not looked up on the
+  // disk again.
+  std::shared_ptr<const Resource> load(const std::string &path);
+
+  // Puts the given contents of the file into the cache.
+  std::shared_ptr<const Resource> add(const std::string &path, std::string data);
+
+  // The number of the files found in the cache.
+  [[nodiscard]] uint64_t hits() const;
+  // The number of the existing files that had to be read from the disk
+  // after the preloading.
+  [[nodiscard]] uint64_t misses() const;
+  [[nodiscard]] std::size_t sizeInBytes();
+
+ private:
+  struct Entry {
+    std::string path;
+    std::shared_ptr<const Resource> resource;
+  };
+
+  std::shared_ptr<const Resource> read(const std::string &path, bool count_miss);
+  void put(const std::string &path, const std::shared_ptr<const Resource> &resource);
+
+ private:
+  const std::size_t max_bytes_;
+  std::size_t size_in_bytes_ = 0;
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  std::unordered_set<std::string> missing_paths_;
+  std::atomic<uint64_t> hits_ = 0;
+  std::atomic<uint64_t> misses_ = 0;
+  std::mutex mutex_;
+};
+
+#endif  // CLIPBOOK_RESOURCE_CACHE_H_
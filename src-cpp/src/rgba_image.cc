@@ -0,0 +1,159 @@
+#include "rgba_image.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "png.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr int kBytesPerPixel = 4;
+
+// Adds the channels of the given number of pixels to the four channel sums.
+void accumulatePixels(const uint8_t *pixels, int count, uint32_t *sums) {
+  int i = 0;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sums));
+  for (; i + 2 <= count; i += 2) {
+    // Two pixels widened to 16 bits and then each of them to 32 bits.
+    __m128i pair = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(pixels + i * kBytesPerPixel));
+    pair = _mm_unpacklo_epi8(pair, zero);
+    acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(pair, zero));
+    acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(pair, zero));
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(sums), acc);
+#elif defined(__ARM_NEON)
+  uint32x4_t acc = vld1q_u32(sums);
+  for (; i + 2 <= count; i += 2) {
+    uint16x8_t pair = vmovl_u8(vld1_u8(pixels + i * kBytesPerPixel));
+    acc = vaddw_u16(acc, vget_low_u16(pair));
+    acc = vaddw_u16(acc, vget_high_u16(pair));
+  }
+  vst1q_u32(sums, acc);
+#endif
+  for (; i < count; ++i) {
+    const uint8_t *pixel = pixels + i * kBytesPerPixel;
+    sums[0] += pixel[0];
+    sums[1] += pixel[1];
+    sums[2] += pixel[2];
+    sums[3] += pixel[3];
+  }
+}
+
+// Converts a row of premultiplied pixels to straight alpha.
+void unpremultiplyRow(const uint8_t *src, uint8_t *dst, int width) {
+  for (int x = 0; x < width; ++x) {
+    const uint8_t *pixel = src + x * kBytesPerPixel;
+    uint8_t *result = dst + x * kBytesPerPixel;
+    uint32_t alpha = pixel[3];
+    if (alpha == 0 || alpha == 255) {
+      std::memcpy(result, pixel, kBytesPerPixel);
+      if (alpha == 0) {
+        std::memset(result, 0, kBytesPerPixel);
+      }
+      continue;
+    }
+    for (int c = 0; c < 3; ++c) {
+      result[c] = static_cast<uint8_t>(std::min<uint32_t>(255, (pixel[c] * 255 + alpha / 2) / alpha));
+    }
+    result[3] = static_cast<uint8_t>(alpha);
+  }
+}
+
+}  // namespace
+
+RgbaImage resizeImage(const RgbaImage &image, int max_width, int max_height) {
+  if (image.isEmpty() || max_width <= 0 || max_height <= 0 ||
+      (image.width <= max_width && image.height <= max_height)) {
+    return image;
+  }
+  double scale = std::min(static_cast<double>(max_width) / image.width,
+                          static_cast<double>(max_height) / image.height);
+  RgbaImage result;
+  result.width = std::clamp(static_cast<int>(std::lround(image.width * scale)), 1, max_width);
+  result.height = std::clamp(static_cast<int>(std::lround(image.height * scale)), 1, max_height);
+  result.premultiplied = image.premultiplied;
+  result.pixels.resize(static_cast<std::size_t>(result.width) * result.height * kBytesPerPixel);
+
+  // The source columns covered by every target column.
+  std::vector<int> columns(result.width + 1);
+  for (int x = 0; x <= result.width; ++x) {
+    columns[x] = static_cast<int>(static_cast<int64_t>(x) * image.width / result.width);
+  }
+  std::vector<uint32_t> sums(static_cast<std::size_t>(result.width) * kBytesPerPixel);
+  const auto src_stride = static_cast<std::size_t>(image.width) * kBytesPerPixel;
+  for (int ty = 0; ty < result.height; ++ty) {
+    int y0 = static_cast<int>(static_cast<int64_t>(ty) * image.height / result.height);
+    int y1 = std::max(static_cast<int>(static_cast<int64_t>(ty + 1) * image.height / result.height), y0 + 1);
+    std::fill(sums.begin(), sums.end(), 0);
+    for (int y = y0; y < y1; ++y) {
+      const uint8_t *row = image.pixels.data() + y * src_stride;
+      for (int tx = 0; tx < result.width; ++tx) {
+        accumulatePixels(row + columns[tx] * kBytesPerPixel, columns[tx + 1] - columns[tx],
+                         &sums[tx * kBytesPerPixel]);
+      }
+    }
+    uint8_t *target = result.pixels.data() + static_cast<std::size_t>(ty) * result.width * kBytesPerPixel;
+    for (int tx = 0; tx < result.width; ++tx) {
+      auto area = static_cast<uint32_t>((y1 - y0) * (columns[tx + 1] - columns[tx]));
+      for (int c = 0; c < kBytesPerPixel; ++c) {
+        target[tx * kBytesPerPixel + c] =
+            static_cast<uint8_t>((sums[tx * kBytesPerPixel + c] + area / 2) / area);
+      }
+    }
+  }
+  return result;
+}
+
+bool encodePng(const RgbaImage &image, std::string &png) {
+  if (image.isEmpty()) {
+    return false;
+  }
+  const auto stride = static_cast<std::size_t>(image.width) * kBytesPerPixel;
+  const uint8_t *rows = image.pixels.data();
+  std::vector<uint8_t> straight_pixels;
+  if (image.premultiplied) {
+    straight_pixels.resize(stride * image.height);
+    for (int y = 0; y < image.height; ++y) {
+      unpremultiplyRow(rows + y * stride, straight_pixels.data() + y * stride, image.width);
+    }
+    rows = straight_pixels.data();
+  }
+  auto data = filterPngRows(rows, stride, image.height, kBytesPerPixel);
+
+  uLongf compressed_size = compressBound(static_cast<uLong>(data.size()));
+  std::string compressed(compressed_size, '\0');
+  if (compress2(reinterpret_cast<Bytef *>(compressed.data()), &compressed_size, data.data(),
+                static_cast<uLong>(data.size()), Z_DEFAULT_COMPRESSION) != Z_OK) {
+    return false;
+  }
+  compressed.resize(compressed_size);
+
+  png.clear();
+  png.reserve(compressed.size() + 64);
+  png.append("\x89PNG\r\n\x1a\n", 8);
+  std::string header;
+  header.reserve(13);
+  for (auto value : {static_cast<uint32_t>(image.width), static_cast<uint32_t>(image.height)}) {
+    header.push_back(static_cast<char>(value >> 24));
+    header.push_back(static_cast<char>(value >> 16));
+    header.push_back(static_cast<char>(value >> 8));
+    header.push_back(static_cast<char>(value));
+  }
+  // 8 bits per channel, RGBA, deflate, adaptive filtering, no interlace.
+  header.append("\x08\x06\x00\x00\x00", 5);
+  appendPngChunk(png, "IHDR", header.data(), header.size());
+  appendPngChunk(png, "IDAT", compressed.data(), compressed.size());
+  appendPngChunk(png, "IEND", nullptr, 0);
+  return true;
+}
@@ -0,0 +1,31 @@
+#ifndef CLIPBOOK_RGBA_IMAGE_H_
+#define CLIPBOOK_RGBA_IMAGE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// An 8-bit RGBA image with the rows packed without padding.
+struct RgbaImage {
+  int width = 0;
+  int height = 0;
+  // Indicates if the color channels are multiplied by alpha. The resizing
+  // of such images does not produce dark fringes around the transparent
+  // areas.
+  bool premultiplied = false;
+  std::vector<uint8_t> pixels;
+
+  [[nodiscard]] bool isEmpty() const {
+    return width <= 0 || height <= 0 || pixels.size() < static_cast<std::size_t>(width) * height * 4;
+  }
+};
+
+// Downscales the image to fit into the given size keeping the aspect ratio.
+// Every target pixel is the average of the source pixels it covers. The
+// image is returned as is if it already fits.
+RgbaImage resizeImage(const RgbaImage &image, int max_width, int max_height);
+
+// Encodes the image as PNG. Returns false if the image cannot be encoded.
+bool encodePng(const RgbaImage &image, std::string &png);
+
+#endif  // CLIPBOOK_RGBA_IMAGE_H_
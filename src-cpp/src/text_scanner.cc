@@ -0,0 +1,330 @@
+#include "text_scanner.h"
+
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "url.h"
+
+namespace {
+
+bool isAlpha(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+bool isAlnum(char c) {
+  return isAlpha(c) || isDigit(c);
+}
+
+bool isHexDigit(char c) {
+  return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+bool isEmailLocalChar(char c) {
+  return isAlnum(c) || c == '.' || c == '_' || c == '%' || c == '+' || c == '-';
+}
+
+bool isDomainChar(char c) {
+  return isAlnum(c) || c == '.' || c == '-';
+}
+
+// Characters that cannot be a part of a link in plain text.
+bool isLinkTerminator(char c) {
+  return isSpace(c) || c == '"' || c == '<' || c == '>' || c == '`' || c == '\0';
+}
+
+bool isTrigger(char c) {
+  return c == ':' || c == '@' || c == '#' || c == '(';
+}
+
+// Returns the offset of the next character that can start a match or the
+// text size if there is no such character.
+std::size_t findNextTrigger(std::string_view text, std::size_t pos) {
+  const char *data = text.data();
+  const std::size_t size = text.size();
+#if defined(__AVX2__)
+  const __m256i colon = _mm256_set1_epi8(':');
+  const __m256i at = _mm256_set1_epi8('@');
+  const __m256i hash = _mm256_set1_epi8('#');
+  const __m256i paren = _mm256_set1_epi8('(');
+  while (pos + 32 <= size) {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+    __m256i matches = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, colon), _mm256_cmpeq_epi8(chunk, at)),
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, hash), _mm256_cmpeq_epi8(chunk, paren)));
+    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+    if (mask != 0) {
+      return pos + __builtin_ctz(mask);
+    }
+    pos += 32;
+  }
+#elif defined(__SSE2__)
+  const __m128i colon = _mm_set1_epi8(':');
+  const __m128i at = _mm_set1_epi8('@');
+  const __m128i hash = _mm_set1_epi8('#');
+  const __m128i paren = _mm_set1_epi8('(');
+  while (pos + 16 <= size) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+    __m128i matches = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, colon), _mm_cmpeq_epi8(chunk, at)),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, hash), _mm_cmpeq_epi8(chunk, paren)));
+    auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+    if (mask != 0) {
+      return pos + __builtin_ctz(mask);
+    }
+    pos += 16;
+  }
+#elif defined(__ARM_NEON)
+  const uint8x16_t colon = vdupq_n_u8(':');
+  const uint8x16_t at = vdupq_n_u8('@');
+  const uint8x16_t hash = vdupq_n_u8('#');
+  const uint8x16_t paren = vdupq_n_u8('(');
+  while (pos + 16 <= size) {
+    uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t *>(data + pos));
+    uint8x16_t matches = vorrq_u8(vorrq_u8(vceqq_u8(chunk, colon), vceqq_u8(chunk, at)),
+                                  vorrq_u8(vceqq_u8(chunk, hash), vceqq_u8(chunk, paren)));
+    // Narrow every byte of the comparison result to 4 bits of a 64-bit mask.
+    uint64_t mask = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+    if (mask != 0) {
+      return pos + (__builtin_ctzll(mask) >> 2);
+    }
+    pos += 16;
+  }
+#endif
+  while (pos < size && !isTrigger(data[pos])) {
+    ++pos;
+  }
+  return pos;
+}
+
+// Matches a link with the "scheme://" prefix around the ":" at the given offset.
+bool matchLink(std::string_view text, std::size_t colon, TextSpan &span) {
+  if (colon + 2 >= text.size() || text[colon + 1] != '/' || text[colon + 2] != '/') {
+    return false;
+  }
+  std::size_t begin = colon;
+  while (begin > 0 && (isAlnum(text[begin - 1]) || text[begin - 1] == '+' ||
+                       text[begin - 1] == '-' || text[begin - 1] == '.')) {
+    --begin;
+  }
+  // The scheme must start with a letter.
+  while (begin < colon && !isAlpha(text[begin])) {
+    ++begin;
+  }
+  if (begin == colon) {
+    return false;
+  }
+  std::size_t end = colon + 3;
+  int open_parens = 0;
+  while (end < text.size() && !isLinkTerminator(text[end])) {
+    if (text[end] == '(') {
+      ++open_parens;
+    } else if (text[end] == ')') {
+      // Stop at the closing parenthesis around the link, e.g. "(https://x.com)".
+      if (open_parens == 0) {
+        break;
+      }
+      --open_parens;
+    }
+    ++end;
+  }
+  // The punctuation at the end most likely belongs to the sentence.
+  while (end > colon + 3) {
+    char c = text[end - 1];
+    if (c != '.' && c != ',' && c != ';' && c != ':' && c != '!' && c != '?' && c != '\'') {
+      break;
+    }
+    --end;
+  }
+  if (!URL(text.substr(begin, end - begin)).isValid()) {
+    return false;
+  }
+  span = {TextSpanType::kLink, begin, end - begin};
+  return true;
+}
+
+// Matches an email around the "@" at the given offset.
+bool matchEmail(std::string_view text, std::size_t at, std::size_t min_begin, TextSpan &span) {
+  std::size_t begin = at;
+  while (begin > min_begin && isEmailLocalChar(text[begin - 1])) {
+    --begin;
+  }
+  if (begin == at) {
+    return false;
+  }
+  std::size_t end = at + 1;
+  std::size_t last_dot = 0;
+  while (end < text.size() && isDomainChar(text[end])) {
+    if (text[end] == '.') {
+      last_dot = end;
+    }
+    ++end;
+  }
+  // Exclude the trailing dot, e.g. at the end of a sentence.
+  if (end > at + 1 && text[end - 1] == '.') {
+    --end;
+    last_dot = 0;
+    for (std::size_t i = at + 1; i < end; ++i) {
+      if (text[i] == '.') {
+        last_dot = i;
+      }
+    }
+  }
+  if (last_dot <= at + 1 || end - last_dot - 1 < 2) {
+    return false;
+  }
+  for (std::size_t i = last_dot + 1; i < end; ++i) {
+    if (!isAlpha(text[i])) {
+      return false;
+    }
+  }
+  span = {TextSpanType::kEmail, begin, end - begin};
+  return true;
+}
+
+// Matches a hex color such as "#fff" or "#ffcc00aa" at the given offset.
+bool matchHexColor(std::string_view text, std::size_t hash, TextSpan &span) {
+  if (hash > 0 && (isAlnum(text[hash - 1]) || text[hash - 1] == '&')) {
+    return false;
+  }
+  std::size_t end = hash + 1;
+  while (end < text.size() && isHexDigit(text[end]) && end - hash <= 8) {
+    ++end;
+  }
+  auto digits = end - hash - 1;
+  if (digits != 3 && digits != 4 && digits != 6 && digits != 8) {
+    return false;
+  }
+  if (end < text.size() && (isAlnum(text[end]) || text[end] == '_')) {
+    return false;
+  }
+  span = {TextSpanType::kColor, hash, end - hash};
+  return true;
+}
+
+// Matches an "rgb(r, g, b)" or "rgba(r, g, b, a)" color around the "(" at the given offset.
+bool matchRgbColor(std::string_view text, std::size_t paren, TextSpan &span) {
+  std::size_t begin;
+  int components;
+  if (paren >= 4 && text.substr(paren - 4, 4) == "rgba") {
+    begin = paren - 4;
+    components = 4;
+  } else if (paren >= 3 && text.substr(paren - 3, 3) == "rgb") {
+    begin = paren - 3;
+    components = 3;
+  } else {
+    return false;
+  }
+  if (begin > 0 && isAlnum(text[begin - 1])) {
+    return false;
+  }
+  std::size_t pos = paren + 1;
+  for (int i = 0; i < components; ++i) {
+    while (pos < text.size() && text[pos] == ' ') {
+      ++pos;
+    }
+    std::size_t number_begin = pos;
+    while (pos < text.size() && (isDigit(text[pos]) || (i == 3 && text[pos] == '.'))) {
+      ++pos;
+    }
+    if (pos == number_begin || pos - number_begin > 4) {
+      return false;
+    }
+    while (pos < text.size() && text[pos] == ' ') {
+      ++pos;
+    }
+    char separator = i + 1 < components ? ',' : ')';
+    if (pos >= text.size() || text[pos] != separator) {
+      return false;
+    }
+    ++pos;
+  }
+  span = {TextSpanType::kColor, begin, pos - begin};
+  return true;
+}
+
+// Finds the spans in the text in a single pass and passes them to the
+// visitor until it returns false. Only the triggers before the given offset
+// are matched.
+template <typename Visitor>
+void scanTextSpans(std::string_view text, std::size_t triggers_end, Visitor &&visitor) {
+  // The end of the last match. The matches do not overlap, so the triggers
+  // inside a match, e.g. "#" in the fragment of a link, are skipped.
+  std::size_t match_end = 0;
+  std::size_t pos = findNextTrigger(text, 0);
+  while (pos < triggers_end && pos < text.size()) {
+    if (pos >= match_end) {
+      TextSpan span{};
+      bool matched = false;
+      switch (text[pos]) {
+        case ':':
+          matched = matchLink(text, pos, span);
+          break;
+        case '@':
+          matched = matchEmail(text, pos, match_end, span);
+          break;
+        case '#':
+          matched = matchHexColor(text, pos, span);
+          break;
+        case '(':
+          matched = matchRgbColor(text, pos, span);
+          break;
+        default:
+          break;
+      }
+      // A link scheme is scanned backwards and must not overlap the previous match.
+      if (matched && span.begin >= match_end) {
+        if (!visitor(span)) {
+          return;
+        }
+        match_end = span.begin + span.length;
+      }
+    }
+    pos = findNextTrigger(text, pos + 1);
+  }
+}
+
+}  // namespace
+
+std::vector<TextSpan> findTextSpans(std::string_view text) {
+  std::vector<TextSpan> spans;
+  scanTextSpans(text, text.size(), [&spans](const TextSpan &span) {
+    spans.push_back(span);
+    return true;
+  });
+  return spans;
+}
+
+bool getTextType(std::string_view text, TextSpanType &type) {
+  // There is no whitespace between the beginning of a span and its trigger:
+  // the link scheme, the email local part and the "rgb" of a color come
+  // right before it. So the text with a whitespace before the first match
+  // is rejected without scanning the rest of it, and the scan stops at the
+  // first match, which either covers the whole text or not.
+  std::size_t first_space = 0;
+  while (first_space < text.size() && !isSpace(text[first_space])) {
+    ++first_space;
+  }
+  bool whole_text = false;
+  scanTextSpans(text, first_space, [&](const TextSpan &span) {
+    if (span.begin == 0 && span.length == text.size()) {
+      whole_text = true;
+      type = span.type;
+    }
+    return false;
+  });
+  return whole_text;
+}
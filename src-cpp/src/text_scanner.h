@@ -0,0 +1,31 @@
+#ifndef CLIPBOOK_TEXT_SCANNER_H_
+#define CLIPBOOK_TEXT_SCANNER_H_
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+enum class TextSpanType {
+  kLink,
+  kEmail,
+  kColor
+};
+
+// A typed fragment of text. The offsets are in bytes of the UTF-8 text.
+struct TextSpan {
+  TextSpanType type;
+  std::size_t begin;
+  std::size_t length;
+};
+
+// Finds all links (e.g. "https://clipbook.app"), emails and hex or rgb()
+// color literals in the text in a single pass. The text is scanned with
+// SIMD instructions for the characters that can start a match, so large
+// texts without matches are processed at memory speed.
+std::vector<TextSpan> findTextSpans(std::string_view text);
+
+// Returns true and the type of the span if the whole text is a single link,
+// email or color literal, e.g. a copied link.
+bool getTextType(std::string_view text, TextSpanType &type);
+
+#endif  // CLIPBOOK_TEXT_SCANNER_H_
@@ -0,0 +1,53 @@
+#include "thumbnail_pipeline.h"
+
+#include <algorithm>
+#include <memory>
+
+std::string getImageLevelFileName(const std::string &image_file_name, int level) {
+  auto file_name = image_file_name;
+  auto suffix = "_w" + std::to_string(level);
+  auto extension_pos = file_name.rfind('.');
+  auto directory_pos = file_name.rfind('/');
+  if (extension_pos == std::string::npos || (directory_pos != std::string::npos && extension_pos < directory_pos)) {
+    return file_name + suffix;
+  }
+  return file_name.insert(extension_pos, suffix);
+}
+
+ThumbnailPipeline::ThumbnailPipeline(std::size_t threads_count, std::size_t max_queue_size) :
+    pool_(threads_count, max_queue_size) {}
+
+void ThumbnailPipeline::enqueue(Decoder decoder, std::vector<Output> outputs) {
+  if (outputs.empty()) {
+    return;
+  }
+  auto task = std::make_shared<std::pair<Decoder, std::vector<Output>>>(std::move(decoder), std::move(outputs));
+  if (!pool_.post([task]() { run(task->first, task->second); })) {
+    run(task->first, task->second);
+  }
+}
+
+const LatencyHistogram &ThumbnailPipeline::latency() const {
+  return pool_.latency();
+}
+
+void ThumbnailPipeline::run(const Decoder &decoder, std::vector<Output> &outputs) {
+  auto image = decoder();
+  // Every output is downscaled from the previous, larger one, which is a lot
+  // cheaper than downscaling the source image again.
+  std::sort(outputs.begin(), outputs.end(), [](const Output &a, const Output &b) {
+    return static_cast<int64_t>(a.max_width) * a.max_height > static_cast<int64_t>(b.max_width) * b.max_height;
+  });
+  for (const auto &output : outputs) {
+    std::string png;
+    if (!image.isEmpty()) {
+      image = resizeImage(image, output.max_width, output.max_height);
+      if (!encodePng(image, png)) {
+        png.clear();
+      }
+    }
+    if (output.done) {
+      output.done(png);
+    }
+  }
+}
@@ -0,0 +1,56 @@
+#ifndef CLIPBOOK_THUMBNAIL_PIPELINE_H_
+#define CLIPBOOK_THUMBNAIL_PIPELINE_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "rgba_image.h"
+#include "worker_pool.h"
+
+// The widths of the downscaled copies of the stored images, from the
+// smallest. A view requests the copy that fits its width instead of
+// decoding the full-size image.
+inline constexpr int kImagePyramidLevels[] = {256, 1024};
+
+// Returns the name of the copy of the image downscaled to the given width,
+// e.g. "blobs/3f/3fa1_w256.png" for "blobs/3f/3fa1.png".
+std::string getImageLevelFileName(const std::string &image_file_name, int level);
+
+// Generates the downscaled PNG copies of the images on the worker threads,
+// so reading the clipboard does not wait for decoding, resizing and
+// encoding.
+class ThumbnailPipeline {
+ public:
+  // Returns the decoded source image or an empty image on failure.
+  using Decoder = std::function<RgbaImage()>;
+  // Receives the encoded thumbnail or an empty string on failure. It's
+  // called on a worker thread.
+  using Callback = std::function<void(const std::string &png)>;
+
+  struct Output {
+    int max_width = 0;
+    int max_height = 0;
+    Callback done;
+  };
+
+  ThumbnailPipeline(std::size_t threads_count, std::size_t max_queue_size);
+  ThumbnailPipeline(const ThumbnailPipeline &) = delete;
+  ThumbnailPipeline &operator=(const ThumbnailPipeline &) = delete;
+
+  /**
+   * Decodes the image once and produces every output from it. The work is
+   * done on the calling thread if the queue is full.
+   */
+  void enqueue(Decoder decoder, std::vector<Output> outputs);
+
+  [[nodiscard]] const LatencyHistogram &latency() const;
+
+ private:
+  static void run(const Decoder &decoder, std::vector<Output> &outputs);
+
+ private:
+  WorkerPool pool_;
+};
+
+#endif  // CLIPBOOK_THUMBNAIL_PIPELINE_H_
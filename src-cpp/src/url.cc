@@ -1,78 +1,340 @@
 #include "url.h"
 
-URL::URL(std::string url) : url_(std::move(url)) {
-  // Find the scheme separator (i.e., "://")
-  if (std::size_t scheme_pos = url_.find("://");
-      scheme_pos != std::string::npos) {
-    scheme_ = url_.substr(0, scheme_pos);
-    // Move past the "://" separator
-    host_ = url_.substr(scheme_pos + 3);
-  } else {
-    scheme_ = "";
-    host_ = url_;
+#include <cctype>
+
+#include "hash.h"
+
+namespace {
+
+bool isAlpha(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool isSchemeChar(char c) {
+  return isAlpha(c) || (c >= '0' && c <= '9') || c == '+' || c == '-' || c == '.';
+}
+
+int hexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+char toLower(char c) {
+  return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool isUnreserved(char c) {
+  return isAlpha(c) || (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' || c == '~';
+}
+
+bool startsWith(std::string_view str, std::string_view prefix) {
+  return str.substr(0, prefix.size()) == prefix;
+}
+
+std::string_view getDefaultPort(std::string_view scheme) {
+  if (scheme == "http" || scheme == "ws") {
+    return "80";
+  }
+  if (scheme == "https" || scheme == "wss") {
+    return "443";
+  }
+  if (scheme == "ftp") {
+    return "21";
+  }
+  return {};
+}
+
+// The query parameters that are added for tracking and do not change the page.
+bool isTrackingParam(std::string_view name) {
+  static constexpr std::string_view kTrackingParams[] = {
+      "fbclid", "gclid", "dclid", "gclsrc", "msclkid", "yclid", "twclid", "igshid",
+      "mc_cid", "mc_eid", "_ga", "_gl", "_hsenc", "_hsmi", "mkt_tok", "oly_anon_id",
+      "oly_enc_id", "vero_id", "wickedid", "ref_src",
+  };
+  if (startsWith(name, "utm_")) {
+    return true;
+  }
+  for (auto param : kTrackingParams) {
+    if (name == param) {
+      return true;
+    }
   }
+  return false;
+}
+
+// Appends the URL component normalizing the percent-encoding: the escaped
+// unreserved characters are decoded and the hex digits are uppercased.
+void appendNormalized(std::string &result, std::string_view component) {
+  for (std::size_t i = 0; i < component.size(); ++i) {
+    if (component[i] == '%' && i + 2 < component.size()) {
+      int high = hexValue(component[i + 1]);
+      int low = hexValue(component[i + 2]);
+      if (high >= 0 && low >= 0) {
+        auto c = static_cast<char>((high << 4) | low);
+        if (isUnreserved(c)) {
+          result.push_back(c);
+        } else {
+          result.push_back('%');
+          result.push_back(static_cast<char>(std::toupper(component[i + 1])));
+          result.push_back(static_cast<char>(std::toupper(component[i + 2])));
+        }
+        i += 2;
+        continue;
+      }
+    }
+    result.push_back(component[i]);
+  }
+}
+
+// Removes the "." and ".." segments and the empty segments produced by the
+// repeated or trailing slashes.
+std::vector<std::string_view> normalizePath(std::string_view path) {
+  std::vector<std::string_view> segments;
+  while (!path.empty()) {
+    auto slash = path.find('/');
+    auto segment = path.substr(0, slash);
+    if (segment == "..") {
+      if (!segments.empty()) {
+        segments.pop_back();
+      }
+    } else if (!segment.empty() && segment != ".") {
+      segments.push_back(segment);
+    }
+    if (slash == std::string_view::npos) {
+      break;
+    }
+    path.remove_prefix(slash + 1);
+  }
+  return segments;
+}
+
+}  // namespace
 
-  // Find the path separator (i.e., "/")
-  if (std::size_t path_pos = host_.find('/'); path_pos != std::string::npos) {
-    path_ = host_.substr(path_pos + 1);
-    // Move back to the start of the host
-    host_ = host_.substr(0, path_pos);
-  } else {
-    path_ = "";
+URL::URL(std::string_view url) : url_(url) {
+  auto size = static_cast<uint32_t>(url_.size());
+  auto make = [](std::size_t begin, std::size_t end) {
+    return Component{static_cast<uint32_t>(begin), static_cast<uint32_t>(end - begin)};
+  };
+
+  // The scheme is a letter followed by letters, digits, "+", "-" or "."
+  // and terminated by ":".
+  uint32_t pos = 0;
+  if (size > 0 && isAlpha(url_[0])) {
+    uint32_t i = 1;
+    while (i < size && isSchemeChar(url_[i])) {
+      ++i;
+    }
+    if (i < size && url_[i] == ':') {
+      scheme_ = make(0, i);
+      pos = i + 1;
+    }
   }
 
-  // Exclude query part from path
-  if (std::size_t query_pos = path_.find('?'); query_pos != std::string::npos) {
-    path_ = path_.substr(0, query_pos);
+  // The authority starts with "//" and ends with the path, query or fragment.
+  if (pos + 1 < size && url_[pos] == '/' && url_[pos + 1] == '/') {
+    pos += 2;
+    uint32_t authority_end = pos;
+    uint32_t at = size;
+    while (authority_end < size && url_[authority_end] != '/' &&
+           url_[authority_end] != '?' && url_[authority_end] != '#') {
+      if (url_[authority_end] == '@') {
+        at = authority_end;
+      }
+      ++authority_end;
+    }
+    if (at != size) {
+      user_info_ = make(pos, at);
+      pos = at + 1;
+    }
+    uint32_t host_end = pos;
+    if (pos < authority_end && url_[pos] == '[') {
+      // An IPv6 address literal, e.g. "[::1]".
+      while (host_end < authority_end && url_[host_end] != ']') {
+        ++host_end;
+      }
+      host_ = make(pos + 1, host_end);
+      if (host_end < authority_end) {
+        ++host_end;
+      }
+    } else {
+      while (host_end < authority_end && url_[host_end] != ':') {
+        ++host_end;
+      }
+      host_ = make(pos, host_end);
+    }
+    if (host_end < authority_end && url_[host_end] == ':') {
+      port_ = make(host_end + 1, authority_end);
+    }
+    pos = authority_end;
   }
 
-  // Find the port separator (i.e., ":")
-  if (std::size_t port_pos = host_.find(':'); port_pos != std::string::npos) {
-    port_ = host_.substr(port_pos + 1);
-    // Move back to the start of the host
-    host_ = host_.substr(0, port_pos);
-  } else {
-    port_ = "";
+  uint32_t path_end = pos;
+  while (path_end < size && url_[path_end] != '?' && url_[path_end] != '#') {
+    ++path_end;
   }
+  // Skip the slash separating the path from the authority.
+  path_ = make(pos < path_end && url_[pos] == '/' ? pos + 1 : pos, path_end);
+  pos = path_end;
 
-  // Split path into items
-  std::size_t start = 0;
-  std::size_t end = path_.find('/');
-  while (end != std::string::npos) {
-    path_items_.push_back(path_.substr(start, end - start));
-    start = end + 1;
-    end = path_.find('/', start);
+  if (pos < size && url_[pos] == '?') {
+    uint32_t query_end = pos + 1;
+    while (query_end < size && url_[query_end] != '#') {
+      ++query_end;
+    }
+    query_ = make(pos + 1, query_end);
+    pos = query_end;
   }
-  std::string path_item = path_.substr(start);
-  if (!path_item.empty()) {
-    path_items_.push_back(path_item);
+
+  if (pos < size && url_[pos] == '#') {
+    fragment_ = make(pos + 1, size);
   }
 }
 
-std::string URL::scheme() {
-  return scheme_;
+std::string_view URL::scheme() const {
+  return component(scheme_);
+}
+
+std::string_view URL::userInfo() const {
+  return component(user_info_);
+}
+
+std::string_view URL::host() const {
+  return component(host_);
+}
+
+std::string_view URL::port() const {
+  return component(port_);
 }
 
-std::string URL::host() {
-  return host_;
+std::string_view URL::path() const {
+  return component(path_);
 }
 
-std::string URL::port() {
-  return port_;
+std::vector<std::string_view> URL::pathItems() const {
+  std::vector<std::string_view> items;
+  auto path = component(path_);
+  while (!path.empty()) {
+    auto slash = path.find('/');
+    items.push_back(path.substr(0, slash));
+    if (slash == std::string_view::npos) {
+      break;
+    }
+    path.remove_prefix(slash + 1);
+  }
+  return items;
 }
 
-std::string URL::path() {
-  return path_;
+std::string_view URL::query() const {
+  return component(query_);
 }
 
-std::vector<std::string> URL::pathItems() {
-  return path_items_;
+std::string_view URL::fragment() const {
+  return component(fragment_);
 }
 
-std::string URL::string() {
+std::string_view URL::string() const {
   return url_;
 }
 
-bool URL::isValid() {
-  return !scheme_.empty() && !host_.empty();
+bool URL::isValid() const {
+  return scheme_.length > 0 && host_.length > 0;
+}
+
+std::string URL::decode(std::string_view component) {
+  std::string result;
+  result.reserve(component.size());
+  for (std::size_t i = 0; i < component.size(); ++i) {
+    if (component[i] == '%' && i + 2 < component.size()) {
+      int high = hexValue(component[i + 1]);
+      int low = hexValue(component[i + 2]);
+      if (high >= 0 && low >= 0) {
+        result.push_back(static_cast<char>((high << 4) | low));
+        i += 2;
+        continue;
+      }
+    }
+    result.push_back(component[i]);
+  }
+  return result;
+}
+
+std::string_view URL::component(Component component) const {
+  return url_.substr(component.begin, component.length);
+}
+
+std::string URL::canonical() const {
+  if (!isValid()) {
+    return std::string(url_);
+  }
+  std::string result;
+  result.reserve(url_.size() + 3);
+  for (char c : scheme()) {
+    result.push_back(toLower(c));
+  }
+  auto default_port = getDefaultPort(result);
+  result += "://";
+  if (user_info_.length > 0) {
+    result += userInfo();
+    result += '@';
+  }
+  auto host = this->host();
+  while (!host.empty() && host.back() == '.') {
+    host.remove_suffix(1);
+  }
+  bool ipv6 = host.find(':') != std::string_view::npos;
+  if (ipv6) {
+    result += '[';
+  }
+  for (char c : host) {
+    result.push_back(toLower(c));
+  }
+  if (ipv6) {
+    result += ']';
+  }
+  auto port = this->port();
+  while (port.size() > 1 && port.front() == '0') {
+    port.remove_prefix(1);
+  }
+  if (!port.empty() && port != default_port) {
+    result += ':';
+    result += port;
+  }
+
+  auto segments = normalizePath(path());
+  if (segments.empty()) {
+    result += '/';
+  }
+  for (auto segment : segments) {
+    result += '/';
+    appendNormalized(result, segment);
+  }
+
+  auto query = this->query();
+  bool first_param = true;
+  while (!query.empty()) {
+    auto amp = query.find('&');
+    auto param = query.substr(0, amp);
+    if (!param.empty() && !isTrackingParam(param.substr(0, param.find('=')))) {
+      result += first_param ? '?' : '&';
+      appendNormalized(result, param);
+      first_param = false;
+    }
+    if (amp == std::string_view::npos) {
+      break;
+    }
+    query.remove_prefix(amp + 1);
+  }
+  return result;
+}
+
+uint64_t URL::canonicalHash() const {
+  return hash64(canonical());
 }
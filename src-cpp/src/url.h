@@ -1,33 +1,85 @@
 #ifndef CLIPBOOK_URL_H_
 #define CLIPBOOK_URL_H_
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
+// A URL reference parsed according to RFC 3986:
+//
+//   scheme://userinfo@host:port/path?query#fragment
+//
+// The URL is parsed in a single pass and only keeps the offsets of its
+// components, so the accessors return views into the original string
+// without copying. The URL does not own the string, which must outlive it.
 class URL {
  public:
-  explicit URL(std::string url);
+  explicit URL(std::string_view url);
 
   /**
    * Indicates if the URL is valid and has at least scheme and host.
    */
-  bool isValid();
+  [[nodiscard]] bool isValid() const;
 
-  std::string scheme();
-  std::string host();
-  std::string port();
-  std::string path();
-  std::vector<std::string> pathItems();
+  [[nodiscard]] std::string_view scheme() const;
+  [[nodiscard]] std::string_view userInfo() const;
 
-  std::string string();
+  /**
+   * Returns the host. The brackets around an IPv6 address are not included.
+   */
+  [[nodiscard]] std::string_view host() const;
+  [[nodiscard]] std::string_view port() const;
+
+  /**
+   * Returns the path without the leading slash.
+   */
+  [[nodiscard]] std::string_view path() const;
+  [[nodiscard]] std::vector<std::string_view> pathItems() const;
+  [[nodiscard]] std::string_view query() const;
+  [[nodiscard]] std::string_view fragment() const;
+
+  [[nodiscard]] std::string_view string() const;
+
+  /**
+   * Returns the canonical form of the URL that is used to match the URLs
+   * pointing to the same page. The scheme and host are lowercased, the
+   * default port, the trailing dot of the host, the fragment and the known
+   * tracking query parameters are removed, and the path is normalized. If
+   * the URL is not valid, it is returned as is.
+   *
+   *   HTTPS://X.com:443/a/./b/?utm_source=x&id=1#top -> https://x.com/a/b?id=1
+   */
+  [[nodiscard]] std::string canonical() const;
+
+  /**
+   * Returns a stable 64-bit hash of the canonical form of the URL.
+   */
+  [[nodiscard]] uint64_t canonicalHash() const;
+
+  /**
+   * Decodes the percent-encoded octets in the given URL component.
+   * Malformed escape sequences are kept as is.
+   */
+  static std::string decode(std::string_view component);
+
+ private:
+  struct Component {
+    uint32_t begin = 0;
+    uint32_t length = 0;
+  };
+
+  [[nodiscard]] std::string_view component(Component component) const;
 
  private:
-  std::string url_;
-  std::string scheme_;
-  std::string host_;
-  std::string port_;
-  std::string path_;
-  std::vector<std::string> path_items_;
+  std::string_view url_;
+  Component scheme_;
+  Component user_info_;
+  Component host_;
+  Component port_;
+  Component path_;
+  Component query_;
+  Component fragment_;
 };
 
 #endif  // CLIPBOOK_URL_H_
@@ -1,1093 +1,603 @@
 #include "url_request_interceptor.h"
 
-#include <filesystem>
+#include <sys/stat.h>
+
+#include <charconv>
+#include <chrono>
+#include <ctime>
 #include <fstream>
 #include <utility>
 
+#include "blob_store.h"
+#include "compression.h"
+#include "hash.h"
+#include "mapped_file.h"
+#include "mime_types.h"
+#include "request_metrics.h"
+#include "request_path.h"
+#include "thumbnail_pipeline.h"
 #include "url.h"
 
-namespace fs = std::filesystem;
+// The size of a single chunk written to the URL request job.
+static const std::size_t kChunkSize = 64 * 1024;
+// The maximum number of idle chunk buffers kept for reuse.
+static const std::size_t kMaxPooledChunks = 8;
+// The memory budget of the bundled app resources cache.
+static const std::size_t kResourceCacheSize = 32 * 1024 * 1024;
+// Files of this size or larger are memory-mapped instead of being read.
+static const uintmax_t kMapFileThreshold = 1024 * 1024;
+// The number of threads reading files for the URL request jobs.
+static const std::size_t kIoThreadsCount = 4;
+// The maximum number of jobs waiting for an I/O thread.
+static const std::size_t kIoQueueSize = 64;
 
-// Source https://gist.github.com/adamfisher/16fe8c619ea389944d0f
-std::map<std::string, std::string> kMimeTypes = {
-    {"123", "application/vnd.lotus-1-2-3"},
-    {"3dml", "text/vnd.in3d.3dml"},
-    {"3ds", "image/x-3ds"},
-    {"3g2", "video/3gpp2"},
-    {"3gp", "video/3gpp"},
-    {"7z", "application/x-7z-compressed"},
-    {"aab", "application/x-authorware-bin"},
-    {"aac", "audio/x-aac"},
-    {"aam", "application/x-authorware-map"},
-    {"aas", "application/x-authorware-seg"},
-    {"abw", "application/x-abiword"},
-    {"ac", "application/pkix-attr-cert"},
-    {"acc", "application/vnd.americandynamics.acc"},
-    {"ace", "application/x-ace-compressed"},
-    {"acu", "application/vnd.acucobol"},
-    {"acutc", "application/vnd.acucorp"},
-    {"adp", "audio/adpcm"},
-    {"aep", "application/vnd.audiograph"},
-    {"afm", "application/x-font-type1"},
-    {"afp", "application/vnd.ibm.modcap"},
-    {"ahead", "application/vnd.ahead.space"},
-    {"ai", "application/postscript"},
-    {"aif", "audio/x-aiff"},
-    {"aifc", "audio/x-aiff"},
-    {"aiff", "audio/x-aiff"},
-    {"air", "application/vnd.adobe.air-application-installer-package+zip"},
-    {"ait", "application/vnd.dvb.ait"},
-    {"ami", "application/vnd.amiga.ami"},
-    {"apk", "application/vnd.android.package-archive"},
-    {"appcache", "text/cache-manifest"},
-    {"application", "application/x-ms-application"},
-    {"apr", "application/vnd.lotus-approach"},
-    {"arc", "application/x-freearc"},
-    {"asc", "application/pgp-signature"},
-    {"asf", "video/x-ms-asf"},
-    {"asm", "text/x-asm"},
-    {"aso", "application/vnd.accpac.simply.aso"},
-    {"asx", "video/x-ms-asf"},
-    {"atc", "application/vnd.acucorp"},
-    {"atom", "application/atom+xml"},
-    {"atomcat", "application/atomcat+xml"},
-    {"atomsvc", "application/atomsvc+xml"},
-    {"atx", "application/vnd.antix.game-component"},
-    {"au", "audio/basic"},
-    {"avi", "video/x-msvideo"},
-    {"aw", "application/applixware"},
-    {"azf", "application/vnd.airzip.filesecure.azf"},
-    {"azs", "application/vnd.airzip.filesecure.azs"},
-    {"azw", "application/vnd.amazon.ebook"},
-    {"bat", "application/x-msdownload"},
-    {"bcpio", "application/x-bcpio"},
-    {"bdf", "application/x-font-bdf"},
-    {"bdm", "application/vnd.syncml.dm+wbxml"},
-    {"bed", "application/vnd.realvnc.bed"},
-    {"bh2", "application/vnd.fujitsu.oasysprs"},
-    {"bin", "application/octet-stream"},
-    {"blb", "application/x-blorb"},
-    {"blorb", "application/x-blorb"},
-    {"bmi", "application/vnd.bmi"},
-    {"bmp", "image/bmp"},
-    {"book", "application/vnd.framemaker"},
-    {"box", "application/vnd.previewsystems.box"},
-    {"boz", "application/x-bzip2"},
-    {"bpk", "application/octet-stream"},
-    {"btif", "image/prs.btif"},
-    {"bz", "application/x-bzip"},
-    {"bz2", "application/x-bzip2"},
-    {"c", "text/x-c"},
-    {"c11amc", "application/vnd.cluetrust.cartomobile-config"},
-    {"c11amz", "application/vnd.cluetrust.cartomobile-config-pkg"},
-    {"c4d", "application/vnd.clonk.c4group"},
-    {"c4f", "application/vnd.clonk.c4group"},
-    {"c4g", "application/vnd.clonk.c4group"},
-    {"c4p", "application/vnd.clonk.c4group"},
-    {"c4u", "application/vnd.clonk.c4group"},
-    {"cab", "application/vnd.ms-cab-compressed"},
-    {"caf", "audio/x-caf"},
-    {"cap", "application/vnd.tcpdump.pcap"},
-    {"car", "application/vnd.curl.car"},
-    {"cat", "application/vnd.ms-pki.seccat"},
-    {"cb7", "application/x-cbr"},
-    {"cba", "application/x-cbr"},
-    {"cbr", "application/x-cbr"},
-    {"cbt", "application/x-cbr"},
-    {"cbz", "application/x-cbr"},
-    {"cc", "text/x-c"},
-    {"cct", "application/x-director"},
-    {"ccxml", "application/ccxml+xml"},
-    {"cdbcmsg", "application/vnd.contact.cmsg"},
-    {"cdf", "application/x-netcdf"},
-    {"cdkey", "application/vnd.mediastation.cdkey"},
-    {"cdmia", "application/cdmi-capability"},
-    {"cdmic", "application/cdmi-container"},
-    {"cdmid", "application/cdmi-domain"},
-    {"cdmio", "application/cdmi-object"},
-    {"cdmiq", "application/cdmi-queue"},
-    {"cdx", "chemical/x-cdx"},
-    {"cdxml", "application/vnd.chemdraw+xml"},
-    {"cdy", "application/vnd.cinderella"},
-    {"cer", "application/pkix-cert"},
-    {"cfs", "application/x-cfs-compressed"},
-    {"cgm", "image/cgm"},
-    {"chat", "application/x-chat"},
-    {"chm", "application/vnd.ms-htmlhelp"},
-    {"chrt", "application/vnd.kde.kchart"},
-    {"cif", "chemical/x-cif"},
-    {"cii", "application/vnd.anser-web-certificate-issue-initiation"},
-    {"cil", "application/vnd.ms-artgalry"},
-    {"cla", "application/vnd.claymore"},
-    {"class", "application/java-vm"},
-    {"clkk", "application/vnd.crick.clicker.keyboard"},
-    {"clkp", "application/vnd.crick.clicker.palette"},
-    {"clkt", "application/vnd.crick.clicker.template"},
-    {"clkw", "application/vnd.crick.clicker.wordbank"},
-    {"clkx", "application/vnd.crick.clicker"},
-    {"clp", "application/x-msclip"},
-    {"cmc", "application/vnd.cosmocaller"},
-    {"cmdf", "chemical/x-cmdf"},
-    {"cml", "chemical/x-cml"},
-    {"cmp", "application/vnd.yellowriver-custom-menu"},
-    {"cmx", "image/x-cmx"},
-    {"cod", "application/vnd.rim.cod"},
-    {"com", "application/x-msdownload"},
-    {"conf", "text/plain"},
-    {"cpio", "application/x-cpio"},
-    {"cpp", "text/x-c"},
-    {"cpt", "application/mac-compactpro"},
-    {"crd", "application/x-mscardfile"},
-    {"crl", "application/pkix-crl"},
-    {"crt", "application/x-x509-ca-cert"},
-    {"cryptonote", "application/vnd.rig.cryptonote"},
-    {"csh", "application/x-csh"},
-    {"csml", "chemical/x-csml"},
-    {"csp", "application/vnd.commonspace"},
-    {"css", "text/css"},
-    {"cst", "application/x-director"},
-    {"csv", "text/csv"},
-    {"cu", "application/cu-seeme"},
-    {"curl", "text/vnd.curl"},
-    {"cww", "application/prs.cww"},
-    {"cxt", "application/x-director"},
-    {"cxx", "text/x-c"},
-    {"dae", "model/vnd.collada+xml"},
-    {"daf", "application/vnd.mobius.daf"},
-    {"dart", "application/vnd.dart"},
-    {"dataless", "application/vnd.fdsn.seed"},
-    {"davmount", "application/davmount+xml"},
-    {"dbk", "application/docbook+xml"},
-    {"dcr", "application/x-director"},
-    {"dcurl", "text/vnd.curl.dcurl"},
-    {"dd2", "application/vnd.oma.dd2+xml"},
-    {"ddd", "application/vnd.fujixerox.ddd"},
-    {"deb", "application/x-debian-package"},
-    {"def", "text/plain"},
-    {"deploy", "application/octet-stream"},
-    {"der", "application/x-x509-ca-cert"},
-    {"dfac", "application/vnd.dreamfactory"},
-    {"dgc", "application/x-dgc-compressed"},
-    {"dic", "text/x-c"},
-    {"dir", "application/x-director"},
-    {"dis", "application/vnd.mobius.dis"},
-    {"dist", "application/octet-stream"},
-    {"distz", "application/octet-stream"},
-    {"djv", "image/vnd.djvu"},
-    {"djvu", "image/vnd.djvu"},
-    {"dll", "application/x-msdownload"},
-    {"dmg", "application/x-apple-diskimage"},
-    {"dmp", "application/vnd.tcpdump.pcap"},
-    {"dms", "application/octet-stream"},
-    {"dna", "application/vnd.dna"},
-    {"doc", "application/msword"},
-    {"docm", "application/vnd.ms-word.document.macroenabled.12"},
-    {"docx",
-     "application/vnd.openxmlformats-officedocument.wordprocessingml.document"},
-    {"dot", "application/msword"},
-    {"dotm", "application/vnd.ms-word.template.macroenabled.12"},
-    {"dotx",
-     "application/vnd.openxmlformats-officedocument.wordprocessingml.template"},
-    {"dp", "application/vnd.osgi.dp"},
-    {"dpg", "application/vnd.dpgraph"},
-    {"dra", "audio/vnd.dra"},
-    {"dsc", "text/prs.lines.tag"},
-    {"dssc", "application/dssc+der"},
-    {"dtb", "application/x-dtbook+xml"},
-    {"dtd", "application/xml-dtd"},
-    {"dts", "audio/vnd.dts"},
-    {"dtshd", "audio/vnd.dts.hd"},
-    {"dump", "application/octet-stream"},
-    {"dvb", "video/vnd.dvb.file"},
-    {"dvi", "application/x-dvi"},
-    {"dwf", "model/vnd.dwf"},
-    {"dwg", "image/vnd.dwg"},
-    {"dxf", "image/vnd.dxf"},
-    {"dxp", "application/vnd.spotfire.dxp"},
-    {"dxr", "application/x-director"},
-    {"ecelp4800", "audio/vnd.nuera.ecelp4800"},
-    {"ecelp7470", "audio/vnd.nuera.ecelp7470"},
-    {"ecelp9600", "audio/vnd.nuera.ecelp9600"},
-    {"ecma", "application/ecmascript"},
-    {"edm", "application/vnd.novadigm.edm"},
-    {"edx", "application/vnd.novadigm.edx"},
-    {"efif", "application/vnd.picsel"},
-    {"ei6", "application/vnd.pg.osasli"},
-    {"elc", "application/octet-stream"},
-    {"emf", "application/x-msmetafile"},
-    {"eml", "message/rfc822"},
-    {"emma", "application/emma+xml"},
-    {"emz", "application/x-msmetafile"},
-    {"eol", "audio/vnd.digital-winds"},
-    {"eot", "application/vnd.ms-fontobject"},
-    {"eps", "application/postscript"},
-    {"epub", "application/epub+zip"},
-    {"es3", "application/vnd.eszigno3+xml"},
-    {"esa", "application/vnd.osgi.subsystem"},
-    {"esf", "application/vnd.epson.esf"},
-    {"et3", "application/vnd.eszigno3+xml"},
-    {"etx", "text/x-setext"},
-    {"eva", "application/x-eva"},
-    {"evy", "application/x-envoy"},
-    {"exe", "application/x-msdownload"},
-    {"exi", "application/exi"},
-    {"ext", "application/vnd.novadigm.ext"},
-    {"ez", "application/andrew-inset"},
-    {"ez2", "application/vnd.ezpix-album"},
-    {"ez3", "application/vnd.ezpix-package"},
-    {"f", "text/x-fortran"},
-    {"f4v", "video/x-f4v"},
-    {"f77", "text/x-fortran"},
-    {"f90", "text/x-fortran"},
-    {"fbs", "image/vnd.fastbidsheet"},
-    {"fcdt", "application/vnd.adobe.formscentral.fcdt"},
-    {"fcs", "application/vnd.isac.fcs"},
-    {"fdf", "application/vnd.fdf"},
-    {"fe_launch", "application/vnd.denovo.fcselayout-link"},
-    {"fg5", "application/vnd.fujitsu.oasysgp"},
-    {"fgd", "application/x-director"},
-    {"fh", "image/x-freehand"},
-    {"fh4", "image/x-freehand"},
-    {"fh5", "image/x-freehand"},
-    {"fh7", "image/x-freehand"},
-    {"fhc", "image/x-freehand"},
-    {"fig", "application/x-xfig"},
-    {"flac", "audio/x-flac"},
-    {"fli", "video/x-fli"},
-    {"flo", "application/vnd.micrografx.flo"},
-    {"flv", "video/x-flv"},
-    {"flw", "application/vnd.kde.kivio"},
-    {"flx", "text/vnd.fmi.flexstor"},
-    {"fly", "text/vnd.fly"},
-    {"fm", "application/vnd.framemaker"},
-    {"fnc", "application/vnd.frogans.fnc"},
-    {"for", "text/x-fortran"},
-    {"fpx", "image/vnd.fpx"},
-    {"frame", "application/vnd.framemaker"},
-    {"fsc", "application/vnd.fsc.weblaunch"},
-    {"fst", "image/vnd.fst"},
-    {"ftc", "application/vnd.fluxtime.clip"},
-    {"fti", "application/vnd.anser-web-funds-transfer-initiation"},
-    {"fvt", "video/vnd.fvt"},
-    {"fxp", "application/vnd.adobe.fxp"},
-    {"fxpl", "application/vnd.adobe.fxp"},
-    {"fzs", "application/vnd.fuzzysheet"},
-    {"g2w", "application/vnd.geoplan"},
-    {"g3", "image/g3fax"},
-    {"g3w", "application/vnd.geospace"},
-    {"gac", "application/vnd.groove-account"},
-    {"gam", "application/x-tads"},
-    {"gbr", "application/rpki-ghostbusters"},
-    {"gca", "application/x-gca-compressed"},
-    {"gdl", "model/vnd.gdl"},
-    {"geo", "application/vnd.dynageo"},
-    {"gex", "application/vnd.geometry-explorer"},
-    {"ggb", "application/vnd.geogebra.file"},
-    {"ggt", "application/vnd.geogebra.tool"},
-    {"ghf", "application/vnd.groove-help"},
-    {"gif", "image/gif"},
-    {"gim", "application/vnd.groove-identity-message"},
-    {"gml", "application/gml+xml"},
-    {"gmx", "application/vnd.gmx"},
-    {"gnumeric", "application/x-gnumeric"},
-    {"gph", "application/vnd.flographit"},
-    {"gpx", "application/gpx+xml"},
-    {"gqf", "application/vnd.grafeq"},
-    {"gqs", "application/vnd.grafeq"},
-    {"gram", "application/srgs"},
-    {"gramps", "application/x-gramps-xml"},
-    {"gre", "application/vnd.geometry-explorer"},
-    {"grv", "application/vnd.groove-injector"},
-    {"grxml", "application/srgs+xml"},
-    {"gsf", "application/x-font-ghostscript"},
-    {"gtar", "application/x-gtar"},
-    {"gtm", "application/vnd.groove-tool-message"},
-    {"gtw", "model/vnd.gtw"},
-    {"gv", "text/vnd.graphviz"},
-    {"gxf", "application/gxf"},
-    {"gxt", "application/vnd.geonext"},
-    {"h", "text/x-c"},
-    {"h261", "video/h261"},
-    {"h263", "video/h263"},
-    {"h264", "video/h264"},
-    {"hal", "application/vnd.hal+xml"},
-    {"hbci", "application/vnd.hbci"},
-    {"hdf", "application/x-hdf"},
-    {"hh", "text/x-c"},
-    {"hlp", "application/winhlp"},
-    {"hpgl", "application/vnd.hp-hpgl"},
-    {"hpid", "application/vnd.hp-hpid"},
-    {"hps", "application/vnd.hp-hps"},
-    {"hqx", "application/mac-binhex40"},
-    {"htke", "application/vnd.kenameaapp"},
-    {"htm", "text/html"},
-    {"html", "text/html"},
-    {"hvd", "application/vnd.yamaha.hv-dic"},
-    {"hvp", "application/vnd.yamaha.hv-voice"},
-    {"hvs", "application/vnd.yamaha.hv-script"},
-    {"i2g", "application/vnd.intergeo"},
-    {"icc", "application/vnd.iccprofile"},
-    {"ice", "x-conference/x-cooltalk"},
-    {"icm", "application/vnd.iccprofile"},
-    {"ico", "image/x-icon"},
-    {"ics", "text/calendar"},
-    {"ief", "image/ief"},
-    {"ifb", "text/calendar"},
-    {"ifm", "application/vnd.shana.informed.formdata"},
-    {"iges", "model/iges"},
-    {"igl", "application/vnd.igloader"},
-    {"igm", "application/vnd.insors.igm"},
-    {"igs", "model/iges"},
-    {"igx", "application/vnd.micrografx.igx"},
-    {"iif", "application/vnd.shana.informed.interchange"},
-    {"imp", "application/vnd.accpac.simply.imp"},
-    {"ims", "application/vnd.ms-ims"},
-    {"in", "text/plain"},
-    {"ink", "application/inkml+xml"},
-    {"inkml", "application/inkml+xml"},
-    {"install", "application/x-install-instructions"},
-    {"iota", "application/vnd.astraea-software.iota"},
-    {"ipfix", "application/ipfix"},
-    {"ipk", "application/vnd.shana.informed.package"},
-    {"irm", "application/vnd.ibm.rights-management"},
-    {"irp", "application/vnd.irepository.package+xml"},
-    {"iso", "application/x-iso9660-image"},
-    {"itp", "application/vnd.shana.informed.formtemplate"},
-    {"ivp", "application/vnd.immervision-ivp"},
-    {"ivu", "application/vnd.immervision-ivu"},
-    {"jad", "text/vnd.sun.j2me.app-descriptor"},
-    {"jam", "application/vnd.jam"},
-    {"jar", "application/java-archive"},
-    {"java", "text/x-java-source"},
-    {"jisp", "application/vnd.jisp"},
-    {"jlt", "application/vnd.hp-jlyt"},
-    {"jnlp", "application/x-java-jnlp-file"},
-    {"joda", "application/vnd.joost.joda-archive"},
-    {"jpe", "image/jpeg"},
-    {"jpeg", "image/jpeg"},
-    {"jpg", "image/jpeg"},
-    {"jpgm", "video/jpm"},
-    {"jpgv", "video/jpeg"},
-    {"jpm", "video/jpm"},
-    {"js", "application/javascript"},
-    {"json", "application/json"},
-    {"jsonml", "application/jsonml+json"},
-    {"kar", "audio/midi"},
-    {"karbon", "application/vnd.kde.karbon"},
-    {"kfo", "application/vnd.kde.kformula"},
-    {"kia", "application/vnd.kidspiration"},
-    {"kml", "application/vnd.google-earth.kml+xml"},
-    {"kmz", "application/vnd.google-earth.kmz"},
-    {"kne", "application/vnd.kinar"},
-    {"knp", "application/vnd.kinar"},
-    {"kon", "application/vnd.kde.kontour"},
-    {"kpr", "application/vnd.kde.kpresenter"},
-    {"kpt", "application/vnd.kde.kpresenter"},
-    {"kpxx", "application/vnd.ds-keypoint"},
-    {"ksp", "application/vnd.kde.kspread"},
-    {"ktr", "application/vnd.kahootz"},
-    {"ktx", "image/ktx"},
-    {"ktz", "application/vnd.kahootz"},
-    {"kwd", "application/vnd.kde.kword"},
-    {"kwt", "application/vnd.kde.kword"},
-    {"lasxml", "application/vnd.las.las+xml"},
-    {"latex", "application/x-latex"},
-    {"lbd", "application/vnd.llamagraphics.life-balance.desktop"},
-    {"lbe", "application/vnd.llamagraphics.life-balance.exchange+xml"},
-    {"les", "application/vnd.hhe.lesson-player"},
-    {"lha", "application/x-lzh-compressed"},
-    {"link66", "application/vnd.route66.link66+xml"},
-    {"list", "text/plain"},
-    {"list3820", "application/vnd.ibm.modcap"},
-    {"listafp", "application/vnd.ibm.modcap"},
-    {"lnk", "application/x-ms-shortcut"},
-    {"log", "text/plain"},
-    {"lostxml", "application/lost+xml"},
-    {"lrf", "application/octet-stream"},
-    {"lrm", "application/vnd.ms-lrm"},
-    {"ltf", "application/vnd.frogans.ltf"},
-    {"lvp", "audio/vnd.lucent.voice"},
-    {"lwp", "application/vnd.lotus-wordpro"},
-    {"lzh", "application/x-lzh-compressed"},
-    {"m13", "application/x-msmediaview"},
-    {"m14", "application/x-msmediaview"},
-    {"m1v", "video/mpeg"},
-    {"m21", "application/mp21"},
-    {"m2a", "audio/mpeg"},
-    {"m2v", "video/mpeg"},
-    {"m3a", "audio/mpeg"},
-    {"m3u", "audio/x-mpegurl"},
-    {"m3u8", "application/vnd.apple.mpegurl"},
-    {"m4a", "audio/mp4"},
-    {"m4u", "video/vnd.mpegurl"},
-    {"m4v", "video/x-m4v"},
-    {"ma", "application/mathematica"},
-    {"mads", "application/mads+xml"},
-    {"mag", "application/vnd.ecowin.chart"},
-    {"maker", "application/vnd.framemaker"},
-    {"man", "text/troff"},
-    {"mar", "application/octet-stream"},
-    {"mathml", "application/mathml+xml"},
-    {"mb", "application/mathematica"},
-    {"mbk", "application/vnd.mobius.mbk"},
-    {"mbox", "application/mbox"},
-    {"mc1", "application/vnd.medcalcdata"},
-    {"mcd", "application/vnd.mcd"},
-    {"mcurl", "text/vnd.curl.mcurl"},
-    {"mdb", "application/x-msaccess"},
-    {"mdi", "image/vnd.ms-modi"},
-    {"me", "text/troff"},
-    {"mesh", "model/mesh"},
-    {"meta4", "application/metalink4+xml"},
-    {"metalink", "application/metalink+xml"},
-    {"mets", "application/mets+xml"},
-    {"mfm", "application/vnd.mfmp"},
-    {"mft", "application/rpki-manifest"},
-    {"mgp", "application/vnd.osgeo.mapguide.package"},
-    {"mgz", "application/vnd.proteus.magazine"},
-    {"mid", "audio/midi"},
-    {"midi", "audio/midi"},
-    {"mie", "application/x-mie"},
-    {"mif", "application/vnd.mif"},
-    {"mime", "message/rfc822"},
-    {"mj2", "video/mj2"},
-    {"mjp2", "video/mj2"},
-    {"mk3d", "video/x-matroska"},
-    {"mka", "audio/x-matroska"},
-    {"mks", "video/x-matroska"},
-    {"mkv", "video/x-matroska"},
-    {"mlp", "application/vnd.dolby.mlp"},
-    {"mmd", "application/vnd.chipnuts.karaoke-mmd"},
-    {"mmf", "application/vnd.smaf"},
-    {"mmr", "image/vnd.fujixerox.edmics-mmr"},
-    {"mng", "video/x-mng"},
-    {"mny", "application/x-msmoney"},
-    {"mobi", "application/x-mobipocket-ebook"},
-    {"mods", "application/mods+xml"},
-    {"mov", "video/quicktime"},
-    {"movie", "video/x-sgi-movie"},
-    {"mp2", "audio/mpeg"},
-    {"mp21", "application/mp21"},
-    {"mp2a", "audio/mpeg"},
-    {"mp3", "audio/mpeg"},
-    {"mp4", "video/mp4"},
-    {"mp4a", "audio/mp4"},
-    {"mp4s", "application/mp4"},
-    {"mp4v", "video/mp4"},
-    {"mpc", "application/vnd.mophun.certificate"},
-    {"mpe", "video/mpeg"},
-    {"mpeg", "video/mpeg"},
-    {"mpg", "video/mpeg"},
-    {"mpg4", "video/mp4"},
-    {"mpga", "audio/mpeg"},
-    {"mpkg", "application/vnd.apple.installer+xml"},
-    {"mpm", "application/vnd.blueice.multipass"},
-    {"mpn", "application/vnd.mophun.application"},
-    {"mpp", "application/vnd.ms-project"},
-    {"mpt", "application/vnd.ms-project"},
-    {"mpy", "application/vnd.ibm.minipay"},
-    {"mqy", "application/vnd.mobius.mqy"},
-    {"mrc", "application/marc"},
-    {"mrcx", "application/marcxml+xml"},
-    {"ms", "text/troff"},
-    {"mscml", "application/mediaservercontrol+xml"},
-    {"mseed", "application/vnd.fdsn.mseed"},
-    {"mseq", "application/vnd.mseq"},
-    {"msf", "application/vnd.epson.msf"},
-    {"msh", "model/mesh"},
-    {"msi", "application/x-msdownload"},
-    {"msl", "application/vnd.mobius.msl"},
-    {"msty", "application/vnd.muvee.style"},
-    {"mts", "model/vnd.mts"},
-    {"mus", "application/vnd.musician"},
-    {"musicxml", "application/vnd.recordare.musicxml+xml"},
-    {"mvb", "application/x-msmediaview"},
-    {"mwf", "application/vnd.mfer"},
-    {"mxf", "application/mxf"},
-    {"mxl", "application/vnd.recordare.musicxml"},
-    {"mxml", "application/xv+xml"},
-    {"mxs", "application/vnd.triscape.mxs"},
-    {"mxu", "video/vnd.mpegurl"},
-    {"n-gage", "application/vnd.nokia.n-gage.symbian.install"},
-    {"n3", "text/n3"},
-    {"nb", "application/mathematica"},
-    {"nbp", "application/vnd.wolfram.player"},
-    {"nc", "application/x-netcdf"},
-    {"ncx", "application/x-dtbncx+xml"},
-    {"nfo", "text/x-nfo"},
-    {"ngdat", "application/vnd.nokia.n-gage.data"},
-    {"nitf", "application/vnd.nitf"},
-    {"nlu", "application/vnd.neurolanguage.nlu"},
-    {"nml", "application/vnd.enliven"},
-    {"nnd", "application/vnd.noblenet-directory"},
-    {"nns", "application/vnd.noblenet-sealer"},
-    {"nnw", "application/vnd.noblenet-web"},
-    {"npx", "image/vnd.net-fpx"},
-    {"nsc", "application/x-conference"},
-    {"nsf", "application/vnd.lotus-notes"},
-    {"ntf", "application/vnd.nitf"},
-    {"nzb", "application/x-nzb"},
-    {"oa2", "application/vnd.fujitsu.oasys2"},
-    {"oa3", "application/vnd.fujitsu.oasys3"},
-    {"oas", "application/vnd.fujitsu.oasys"},
-    {"obd", "application/x-msbinder"},
-    {"obj", "application/x-tgif"},
-    {"oda", "application/oda"},
-    {"odb", "application/vnd.oasis.opendocument.database"},
-    {"odc", "application/vnd.oasis.opendocument.chart"},
-    {"odf", "application/vnd.oasis.opendocument.formula"},
-    {"odft", "application/vnd.oasis.opendocument.formula-template"},
-    {"odg", "application/vnd.oasis.opendocument.graphics"},
-    {"odi", "application/vnd.oasis.opendocument.image"},
-    {"odm", "application/vnd.oasis.opendocument.text-master"},
-    {"odp", "application/vnd.oasis.opendocument.presentation"},
-    {"ods", "application/vnd.oasis.opendocument.spreadsheet"},
-    {"odt", "application/vnd.oasis.opendocument.text"},
-    {"oga", "audio/ogg"},
-    {"ogg", "audio/ogg"},
-    {"ogv", "video/ogg"},
-    {"ogx", "application/ogg"},
-    {"omdoc", "application/omdoc+xml"},
-    {"onepkg", "application/onenote"},
-    {"onetmp", "application/onenote"},
-    {"onetoc", "application/onenote"},
-    {"onetoc2", "application/onenote"},
-    {"opf", "application/oebps-package+xml"},
-    {"opml", "text/x-opml"},
-    {"oprc", "application/vnd.palm"},
-    {"org", "application/vnd.lotus-organizer"},
-    {"osf", "application/vnd.yamaha.openscoreformat"},
-    {"osfpvg", "application/vnd.yamaha.openscoreformat.osfpvg+xml"},
-    {"otc", "application/vnd.oasis.opendocument.chart-template"},
-    {"otf", "application/x-font-otf"},
-    {"otg", "application/vnd.oasis.opendocument.graphics-template"},
-    {"oth", "application/vnd.oasis.opendocument.text-web"},
-    {"oti", "application/vnd.oasis.opendocument.image-template"},
-    {"otp", "application/vnd.oasis.opendocument.presentation-template"},
-    {"ots", "application/vnd.oasis.opendocument.spreadsheet-template"},
-    {"ott", "application/vnd.oasis.opendocument.text-template"},
-    {"oxps", "application/oxps"},
-    {"oxt", "application/vnd.openofficeorg.extension"},
-    {"p", "text/x-pascal"},
-    {"p10", "application/pkcs10"},
-    {"p12", "application/x-pkcs12"},
-    {"p7b", "application/x-pkcs7-certificates"},
-    {"p7c", "application/pkcs7-mime"},
-    {"p7m", "application/pkcs7-mime"},
-    {"p7r", "application/x-pkcs7-certreqresp"},
-    {"p7s", "application/pkcs7-signature"},
-    {"p8", "application/pkcs8"},
-    {"pas", "text/x-pascal"},
-    {"paw", "application/vnd.pawaafile"},
-    {"pbd", "application/vnd.powerbuilder6"},
-    {"pbm", "image/x-portable-bitmap"},
-    {"pcap", "application/vnd.tcpdump.pcap"},
-    {"pcf", "application/x-font-pcf"},
-    {"pcl", "application/vnd.hp-pcl"},
-    {"pclxl", "application/vnd.hp-pclxl"},
-    {"pct", "image/x-pict"},
-    {"pcurl", "application/vnd.curl.pcurl"},
-    {"pcx", "image/x-pcx"},
-    {"pdb", "application/vnd.palm"},
-    {"pdf", "application/pdf"},
-    {"pfa", "application/x-font-type1"},
-    {"pfb", "application/x-font-type1"},
-    {"pfm", "application/x-font-type1"},
-    {"pfr", "application/font-tdpfr"},
-    {"pfx", "application/x-pkcs12"},
-    {"pgm", "image/x-portable-graymap"},
-    {"pgn", "application/x-chess-pgn"},
-    {"pgp", "application/pgp-encrypted"},
-    {"pic", "image/x-pict"},
-    {"pkg", "application/octet-stream"},
-    {"pki", "application/pkixcmp"},
-    {"pkipath", "application/pkix-pkipath"},
-    {"plb", "application/vnd.3gpp.pic-bw-large"},
-    {"plc", "application/vnd.mobius.plc"},
-    {"plf", "application/vnd.pocketlearn"},
-    {"pls", "application/pls+xml"},
-    {"pml", "application/vnd.ctc-posml"},
-    {"png", "image/png"},
-    {"pnm", "image/x-portable-anymap"},
-    {"portpkg", "application/vnd.macports.portpkg"},
-    {"pot", "application/vnd.ms-powerpoint"},
-    {"potm", "application/vnd.ms-powerpoint.template.macroenabled.12"},
-    {"potx",
-     "application/vnd.openxmlformats-officedocument.presentationml.template"},
-    {"ppam", "application/vnd.ms-powerpoint.addin.macroenabled.12"},
-    {"ppd", "application/vnd.cups-ppd"},
-    {"ppm", "image/x-portable-pixmap"},
-    {"pps", "application/vnd.ms-powerpoint"},
-    {"ppsm", "application/vnd.ms-powerpoint.slideshow.macroenabled.12"},
-    {"ppsx",
-     "application/vnd.openxmlformats-officedocument.presentationml.slideshow"},
-    {"ppt", "application/vnd.ms-powerpoint"},
-    {"pptm", "application/vnd.ms-powerpoint.presentation.macroenabled.12"},
-    {"pptx",
-     "application/"
-     "vnd.openxmlformats-officedocument.presentationml.presentation"},
-    {"pqa", "application/vnd.palm"},
-    {"prc", "application/x-mobipocket-ebook"},
-    {"pre", "application/vnd.lotus-freelance"},
-    {"prf", "application/pics-rules"},
-    {"ps", "application/postscript"},
-    {"psb", "application/vnd.3gpp.pic-bw-small"},
-    {"psd", "image/vnd.adobe.photoshop"},
-    {"psf", "application/x-font-linux-psf"},
-    {"pskcxml", "application/pskc+xml"},
-    {"ptid", "application/vnd.pvi.ptid1"},
-    {"pub", "application/x-mspublisher"},
-    {"pvb", "application/vnd.3gpp.pic-bw-var"},
-    {"pwn", "application/vnd.3m.post-it-notes"},
-    {"pya", "audio/vnd.ms-playready.media.pya"},
-    {"pyv", "video/vnd.ms-playready.media.pyv"},
-    {"qam", "application/vnd.epson.quickanime"},
-    {"qbo", "application/vnd.intu.qbo"},
-    {"qfx", "application/vnd.intu.qfx"},
-    {"qps", "application/vnd.publishare-delta-tree"},
-    {"qt", "video/quicktime"},
-    {"qwd", "application/vnd.quark.quarkxpress"},
-    {"qwt", "application/vnd.quark.quarkxpress"},
-    {"qxb", "application/vnd.quark.quarkxpress"},
-    {"qxd", "application/vnd.quark.quarkxpress"},
-    {"qxl", "application/vnd.quark.quarkxpress"},
-    {"qxt", "application/vnd.quark.quarkxpress"},
-    {"ra", "audio/x-pn-realaudio"},
-    {"ram", "audio/x-pn-realaudio"},
-    {"rar", "application/x-rar-compressed"},
-    {"ras", "image/x-cmu-raster"},
-    {"rcprofile", "application/vnd.ipunplugged.rcprofile"},
-    {"rdf", "application/rdf+xml"},
-    {"rdz", "application/vnd.data-vision.rdz"},
-    {"rep", "application/vnd.businessobjects"},
-    {"res", "application/x-dtbresource+xml"},
-    {"rgb", "image/x-rgb"},
-    {"rif", "application/reginfo+xml"},
-    {"rip", "audio/vnd.rip"},
-    {"ris", "application/x-research-info-systems"},
-    {"rl", "application/resource-lists+xml"},
-    {"rlc", "image/vnd.fujixerox.edmics-rlc"},
-    {"rld", "application/resource-lists-diff+xml"},
-    {"rm", "application/vnd.rn-realmedia"},
-    {"rmi", "audio/midi"},
-    {"rmp", "audio/x-pn-realaudio-plugin"},
-    {"rms", "application/vnd.jcp.javame.midlet-rms"},
-    {"rmvb", "application/vnd.rn-realmedia-vbr"},
-    {"rnc", "application/relax-ng-compact-syntax"},
-    {"roa", "application/rpki-roa"},
-    {"roff", "text/troff"},
-    {"rp9", "application/vnd.cloanto.rp9"},
-    {"rpss", "application/vnd.nokia.radio-presets"},
-    {"rpst", "application/vnd.nokia.radio-preset"},
-    {"rq", "application/sparql-query"},
-    {"rs", "application/rls-services+xml"},
-    {"rsd", "application/rsd+xml"},
-    {"rss", "application/rss+xml"},
-    {"rtf", "application/rtf"},
-    {"rtx", "text/richtext"},
-    {"s", "text/x-asm"},
-    {"s3m", "audio/s3m"},
-    {"saf", "application/vnd.yamaha.smaf-audio"},
-    {"sbml", "application/sbml+xml"},
-    {"sc", "application/vnd.ibm.secure-container"},
-    {"scd", "application/x-msschedule"},
-    {"scm", "application/vnd.lotus-screencam"},
-    {"scq", "application/scvp-cv-request"},
-    {"scs", "application/scvp-cv-response"},
-    {"scurl", "text/vnd.curl.scurl"},
-    {"sda", "application/vnd.stardivision.draw"},
-    {"sdc", "application/vnd.stardivision.calc"},
-    {"sdd", "application/vnd.stardivision.impress"},
-    {"sdkd", "application/vnd.solent.sdkm+xml"},
-    {"sdkm", "application/vnd.solent.sdkm+xml"},
-    {"sdp", "application/sdp"},
-    {"sdw", "application/vnd.stardivision.writer"},
-    {"see", "application/vnd.seemail"},
-    {"seed", "application/vnd.fdsn.seed"},
-    {"sema", "application/vnd.sema"},
-    {"semd", "application/vnd.semd"},
-    {"semf", "application/vnd.semf"},
-    {"ser", "application/java-serialized-object"},
-    {"setpay", "application/set-payment-initiation"},
-    {"setreg", "application/set-registration-initiation"},
-    {"sfd-hdstx", "application/vnd.hydrostatix.sof-data"},
-    {"sfs", "application/vnd.spotfire.sfs"},
-    {"sfv", "text/x-sfv"},
-    {"sgi", "image/sgi"},
-    {"sgl", "application/vnd.stardivision.writer-global"},
-    {"sgm", "text/sgml"},
-    {"sgml", "text/sgml"},
-    {"sh", "application/x-sh"},
-    {"shar", "application/x-shar"},
-    {"shf", "application/shf+xml"},
-    {"sid", "image/x-mrsid-image"},
-    {"sig", "application/pgp-signature"},
-    {"sil", "audio/silk"},
-    {"silo", "model/mesh"},
-    {"sis", "application/vnd.symbian.install"},
-    {"sisx", "application/vnd.symbian.install"},
-    {"sit", "application/x-stuffit"},
-    {"sitx", "application/x-stuffitx"},
-    {"skd", "application/vnd.koan"},
-    {"skm", "application/vnd.koan"},
-    {"skp", "application/vnd.koan"},
-    {"skt", "application/vnd.koan"},
-    {"sldm", "application/vnd.ms-powerpoint.slide.macroenabled.12"},
-    {"sldx",
-     "application/vnd.openxmlformats-officedocument.presentationml.slide"},
-    {"slt", "application/vnd.epson.salt"},
-    {"sm", "application/vnd.stepmania.stepchart"},
-    {"smf", "application/vnd.stardivision.math"},
-    {"smi", "application/smil+xml"},
-    {"smil", "application/smil+xml"},
-    {"smv", "video/x-smv"},
-    {"smzip", "application/vnd.stepmania.package"},
-    {"snd", "audio/basic"},
-    {"snf", "application/x-font-snf"},
-    {"so", "application/octet-stream"},
-    {"spc", "application/x-pkcs7-certificates"},
-    {"spf", "application/vnd.yamaha.smaf-phrase"},
-    {"spl", "application/x-futuresplash"},
-    {"spot", "text/vnd.in3d.spot"},
-    {"spp", "application/scvp-vp-response"},
-    {"spq", "application/scvp-vp-request"},
-    {"spx", "audio/ogg"},
-    {"sql", "application/x-sql"},
-    {"src", "application/x-wais-source"},
-    {"srt", "application/x-subrip"},
-    {"sru", "application/sru+xml"},
-    {"srx", "application/sparql-results+xml"},
-    {"ssdl", "application/ssdl+xml"},
-    {"sse", "application/vnd.kodak-descriptor"},
-    {"ssf", "application/vnd.epson.ssf"},
-    {"ssml", "application/ssml+xml"},
-    {"st", "application/vnd.sailingtracker.track"},
-    {"stc", "application/vnd.sun.xml.calc.template"},
-    {"std", "application/vnd.sun.xml.draw.template"},
-    {"stf", "application/vnd.wt.stf"},
-    {"sti", "application/vnd.sun.xml.impress.template"},
-    {"stk", "application/hyperstudio"},
-    {"stl", "application/vnd.ms-pki.stl"},
-    {"str", "application/vnd.pg.format"},
-    {"stw", "application/vnd.sun.xml.writer.template"},
-    {"sub", "text/vnd.dvb.subtitle"},
-    {"sus", "application/vnd.sus-calendar"},
-    {"susp", "application/vnd.sus-calendar"},
-    {"sv4cpio", "application/x-sv4cpio"},
-    {"sv4crc", "application/x-sv4crc"},
-    {"svc", "application/vnd.dvb.service"},
-    {"svd", "application/vnd.svd"},
-    {"svg", "image/svg+xml"},
-    {"svgz", "image/svg+xml"},
-    {"swa", "application/x-director"},
-    {"swf", "application/x-shockwave-flash"},
-    {"swi", "application/vnd.aristanetworks.swi"},
-    {"sxc", "application/vnd.sun.xml.calc"},
-    {"sxd", "application/vnd.sun.xml.draw"},
-    {"sxg", "application/vnd.sun.xml.writer.global"},
-    {"sxi", "application/vnd.sun.xml.impress"},
-    {"sxm", "application/vnd.sun.xml.math"},
-    {"sxw", "application/vnd.sun.xml.writer"},
-    {"t", "text/troff"},
-    {"t3", "application/x-t3vm-image"},
-    {"taglet", "application/vnd.mynfc"},
-    {"tao", "application/vnd.tao.intent-module-archive"},
-    {"tar", "application/x-tar"},
-    {"tcap", "application/vnd.3gpp2.tcap"},
-    {"tcl", "application/x-tcl"},
-    {"teacher", "application/vnd.smart.teacher"},
-    {"tei", "application/tei+xml"},
-    {"teicorpus", "application/tei+xml"},
-    {"tex", "application/x-tex"},
-    {"texi", "application/x-texinfo"},
-    {"texinfo", "application/x-texinfo"},
-    {"text", "text/plain"},
-    {"tfi", "application/thraud+xml"},
-    {"tfm", "application/x-tex-tfm"},
-    {"tga", "image/x-tga"},
-    {"thmx", "application/vnd.ms-officetheme"},
-    {"tif", "image/tiff"},
-    {"tiff", "image/tiff"},
-    {"tmo", "application/vnd.tmobile-livetv"},
-    {"torrent", "application/x-bittorrent"},
-    {"tpl", "application/vnd.groove-tool-template"},
-    {"tpt", "application/vnd.trid.tpt"},
-    {"tr", "text/troff"},
-    {"tra", "application/vnd.trueapp"},
-    {"trm", "application/x-msterminal"},
-    {"tsd", "application/timestamped-data"},
-    {"tsv", "text/tab-separated-values"},
-    {"ttc", "application/x-font-ttf"},
-    {"ttf", "application/x-font-ttf"},
-    {"ttl", "text/turtle"},
-    {"twd", "application/vnd.simtech-mindmapper"},
-    {"twds", "application/vnd.simtech-mindmapper"},
-    {"txd", "application/vnd.genomatix.tuxedo"},
-    {"txf", "application/vnd.mobius.txf"},
-    {"txt", "text/plain"},
-    {"u32", "application/x-authorware-bin"},
-    {"udeb", "application/x-debian-package"},
-    {"ufd", "application/vnd.ufdl"},
-    {"ufdl", "application/vnd.ufdl"},
-    {"ulx", "application/x-glulx"},
-    {"umj", "application/vnd.umajin"},
-    {"unityweb", "application/vnd.unity"},
-    {"uoml", "application/vnd.uoml+xml"},
-    {"uri", "text/uri-list"},
-    {"uris", "text/uri-list"},
-    {"urls", "text/uri-list"},
-    {"ustar", "application/x-ustar"},
-    {"utz", "application/vnd.uiq.theme"},
-    {"uu", "text/x-uuencode"},
-    {"uva", "audio/vnd.dece.audio"},
-    {"uvd", "application/vnd.dece.data"},
-    {"uvf", "application/vnd.dece.data"},
-    {"uvg", "image/vnd.dece.graphic"},
-    {"uvh", "video/vnd.dece.hd"},
-    {"uvi", "image/vnd.dece.graphic"},
-    {"uvm", "video/vnd.dece.mobile"},
-    {"uvp", "video/vnd.dece.pd"},
-    {"uvs", "video/vnd.dece.sd"},
-    {"uvt", "application/vnd.dece.ttml+xml"},
-    {"uvu", "video/vnd.uvvu.mp4"},
-    {"uvv", "video/vnd.dece.video"},
-    {"uvva", "audio/vnd.dece.audio"},
-    {"uvvd", "application/vnd.dece.data"},
-    {"uvvf", "application/vnd.dece.data"},
-    {"uvvg", "image/vnd.dece.graphic"},
-    {"uvvh", "video/vnd.dece.hd"},
-    {"uvvi", "image/vnd.dece.graphic"},
-    {"uvvm", "video/vnd.dece.mobile"},
-    {"uvvp", "video/vnd.dece.pd"},
-    {"uvvs", "video/vnd.dece.sd"},
-    {"uvvt", "application/vnd.dece.ttml+xml"},
-    {"uvvu", "video/vnd.uvvu.mp4"},
-    {"uvvv", "video/vnd.dece.video"},
-    {"uvvx", "application/vnd.dece.unspecified"},
-    {"uvvz", "application/vnd.dece.zip"},
-    {"uvx", "application/vnd.dece.unspecified"},
-    {"uvz", "application/vnd.dece.zip"},
-    {"vcard", "text/vcard"},
-    {"vcd", "application/x-cdlink"},
-    {"vcf", "text/x-vcard"},
-    {"vcg", "application/vnd.groove-vcard"},
-    {"vcs", "text/x-vcalendar"},
-    {"vcx", "application/vnd.vcx"},
-    {"vis", "application/vnd.visionary"},
-    {"viv", "video/vnd.vivo"},
-    {"vob", "video/x-ms-vob"},
-    {"vor", "application/vnd.stardivision.writer"},
-    {"vox", "application/x-authorware-bin"},
-    {"vrml", "model/vrml"},
-    {"vsd", "application/vnd.visio"},
-    {"vsf", "application/vnd.vsf"},
-    {"vss", "application/vnd.visio"},
-    {"vst", "application/vnd.visio"},
-    {"vsw", "application/vnd.visio"},
-    {"vtu", "model/vnd.vtu"},
-    {"vxml", "application/voicexml+xml"},
-    {"w3d", "application/x-director"},
-    {"wad", "application/x-doom"},
-    {"wav", "audio/x-wav"},
-    {"wax", "audio/x-ms-wax"},
-    {"wbmp", "image/vnd.wap.wbmp"},
-    {"wbs", "application/vnd.criticaltools.wbs+xml"},
-    {"wbxml", "application/vnd.wap.wbxml"},
-    {"wcm", "application/vnd.ms-works"},
-    {"wdb", "application/vnd.ms-works"},
-    {"wdp", "image/vnd.ms-photo"},
-    {"weba", "audio/webm"},
-    {"webm", "video/webm"},
-    {"webp", "image/webp"},
-    {"wg", "application/vnd.pmi.widget"},
-    {"wgt", "application/widget"},
-    {"wks", "application/vnd.ms-works"},
-    {"wm", "video/x-ms-wm"},
-    {"wma", "audio/x-ms-wma"},
-    {"wmd", "application/x-ms-wmd"},
-    {"wmf", "application/x-msmetafile"},
-    {"wml", "text/vnd.wap.wml"},
-    {"wmlc", "application/vnd.wap.wmlc"},
-    {"wmls", "text/vnd.wap.wmlscript"},
-    {"wmlsc", "application/vnd.wap.wmlscriptc"},
-    {"wmv", "video/x-ms-wmv"},
-    {"wmx", "video/x-ms-wmx"},
-    {"wmz", "application/x-msmetafile"},
-    {"woff", "application/font-woff"},
-    {"wpd", "application/vnd.wordperfect"},
-    {"wpl", "application/vnd.ms-wpl"},
-    {"wps", "application/vnd.ms-works"},
-    {"wqd", "application/vnd.wqd"},
-    {"wri", "application/x-mswrite"},
-    {"wrl", "model/vrml"},
-    {"wsdl", "application/wsdl+xml"},
-    {"wspolicy", "application/wspolicy+xml"},
-    {"wtb", "application/vnd.webturbo"},
-    {"wvx", "video/x-ms-wvx"},
-    {"x32", "application/x-authorware-bin"},
-    {"x3d", "model/x3d+xml"},
-    {"x3db", "model/x3d+binary"},
-    {"x3dbz", "model/x3d+binary"},
-    {"x3dv", "model/x3d+vrml"},
-    {"x3dvz", "model/x3d+vrml"},
-    {"x3dz", "model/x3d+xml"},
-    {"xaml", "application/xaml+xml"},
-    {"xap", "application/x-silverlight-app"},
-    {"xar", "application/vnd.xara"},
-    {"xbap", "application/x-ms-xbap"},
-    {"xbd", "application/vnd.fujixerox.docuworks.binder"},
-    {"xbm", "image/x-xbitmap"},
-    {"xdf", "application/xcap-diff+xml"},
-    {"xdm", "application/vnd.syncml.dm+xml"},
-    {"xdp", "application/vnd.adobe.xdp+xml"},
-    {"xdssc", "application/dssc+xml"},
-    {"xdw", "application/vnd.fujixerox.docuworks"},
-    {"xenc", "application/xenc+xml"},
-    {"xer", "application/patch-ops-error+xml"},
-    {"xfdf", "application/vnd.adobe.xfdf"},
-    {"xfdl", "application/vnd.xfdl"},
-    {"xht", "application/xhtml+xml"},
-    {"xhtml", "application/xhtml+xml"},
-    {"xhvml", "application/xv+xml"},
-    {"xif", "image/vnd.xiff"},
-    {"xla", "application/vnd.ms-excel"},
-    {"xlam", "application/vnd.ms-excel.addin.macroenabled.12"},
-    {"xlc", "application/vnd.ms-excel"},
-    {"xlf", "application/x-xliff+xml"},
-    {"xlm", "application/vnd.ms-excel"},
-    {"xls", "application/vnd.ms-excel"},
-    {"xlsb", "application/vnd.ms-excel.sheet.binary.macroenabled.12"},
-    {"xlsm", "application/vnd.ms-excel.sheet.macroenabled.12"},
-    {"xlsx",
-     "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet"},
-    {"xlt", "application/vnd.ms-excel"},
-    {"xltm", "application/vnd.ms-excel.template.macroenabled.12"},
-    {"xltx",
-     "application/vnd.openxmlformats-officedocument.spreadsheetml.template"},
-    {"xlw", "application/vnd.ms-excel"},
-    {"xm", "audio/xm"},
-    {"xml", "application/xml"},
-    {"xo", "application/vnd.olpc-sugar"},
-    {"xop", "application/xop+xml"},
-    {"xpi", "application/x-xpinstall"},
-    {"xpl", "application/xproc+xml"},
-    {"xpm", "image/x-xpixmap"},
-    {"xpr", "application/vnd.is-xpr"},
-    {"xps", "application/vnd.ms-xpsdocument"},
-    {"xpw", "application/vnd.intercon.formnet"},
-    {"xpx", "application/vnd.intercon.formnet"},
-    {"xsl", "application/xml"},
-    {"xslt", "application/xslt+xml"},
-    {"xsm", "application/vnd.syncml+xml"},
-    {"xspf", "application/xspf+xml"},
-    {"xul", "application/vnd.mozilla.xul+xml"},
-    {"xvm", "application/xv+xml"},
-    {"xvml", "application/xv+xml"},
-    {"xwd", "image/x-xwindowdump"},
-    {"xyz", "chemical/x-xyz"},
-    {"xz", "application/x-xz"},
-    {"yang", "application/yang"},
-    {"yin", "application/yin+xml"},
-    {"z1", "application/x-zmachine"},
-    {"z2", "application/x-zmachine"},
-    {"z3", "application/x-zmachine"},
-    {"z4", "application/x-zmachine"},
-    {"z5", "application/x-zmachine"},
-    {"z6", "application/x-zmachine"},
-    {"z7", "application/x-zmachine"},
-    {"z8", "application/x-zmachine"},
-    {"zaz", "application/vnd.zzazz.deck+xml"},
-    {"zip", "application/zip"},
-    {"zir", "application/vnd.zul"},
-    {"zirz", "application/vnd.zul"},
-    {"zmm", "application/vnd.handheld-entertainment+xml"}};
+struct ContentEncoding {
+  const char *name;
+  // The extension of the precompressed sibling file produced by the build.
+  const char *extension;
+};
 
-std::vector<std::string> kRoutingPages = {
-    "/welcome", "/accessibility", "/enjoy", "/settings", "/settings/history", "/settings/shortcuts", "/settings/privacy", "/settings/license", "/settings/tags", "/settings/about", "/settings/storage"
+// The supported encodings in the order of preference.
+const ContentEncoding kContentEncodings[] = {
+    {"br", ".br"},
+    {"gzip", ".gz"},
 };
 
-std::string getFileExtension(const std::string& file_path) {
-  auto extension = fs::path(file_path).extension().string();
-  if (!extension.empty() && extension[0] == '.') {
-    extension = extension.substr(1);
+std::string getFileExtension(std::string_view file_path) {
+  auto file_name = file_path.substr(file_path.rfind('/') + 1);
+  auto dot = file_name.rfind('.');
+  // A leading dot starts the name of a hidden file, not the extension.
+  if (dot == std::string_view::npos || dot == 0) {
+    return "";
   }
+  std::string extension(file_name.substr(dot + 1));
   std::ranges::transform(extension, extension.begin(), ::tolower);
   return extension;
 }
 
-bool endsWith(const std::string& str, const std::string& ending) {
-  if (str.length() >= ending.length()) {
-    return (0 == str.compare(str.length() - ending.length(), ending.length(), ending));
-  } else {
-    return false;
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+  return std::ranges::equal(a, b, [](char c1, char c2) {
+    return ::tolower(static_cast<unsigned char>(c1)) == ::tolower(static_cast<unsigned char>(c2));
+  });
+}
+
+std::string getRequestHeader(const mobrowser::UrlRequest &request, std::string_view name) {
+  for (const auto &header : request.headers) {
+    if (equalsIgnoreCase(header.name, name)) {
+      return header.value;
+    }
   }
+  return "";
 }
 
-bool isRoutingPage(const std::string& url) {
-  return std::ranges::any_of(kRoutingPages, [&url](const std::string& page) {
-    return endsWith(url, page);
-  });
+// Indicates if the Accept-Encoding header value allows the given encoding.
+bool acceptsEncoding(std::string_view accept_encoding, std::string_view encoding) {
+  while (!accept_encoding.empty()) {
+    auto comma = accept_encoding.find(',');
+    auto coding = accept_encoding.substr(0, comma);
+    auto semicolon = coding.find(';');
+    auto params = semicolon == std::string_view::npos ? std::string_view() : coding.substr(semicolon + 1);
+    coding = coding.substr(0, semicolon);
+    while (!coding.empty() && coding.front() == ' ') {
+      coding.remove_prefix(1);
+    }
+    while (!coding.empty() && coding.back() == ' ') {
+      coding.remove_suffix(1);
+    }
+    if (equalsIgnoreCase(coding, encoding)) {
+      // The encoding is explicitly disallowed with "q=0".
+      auto quality = params.find("q=");
+      return quality == std::string_view::npos ||
+             params.substr(quality + 2).find_first_not_of("0.") != std::string_view::npos;
+    }
+    if (comma == std::string_view::npos) {
+      break;
+    }
+    accept_encoding.remove_prefix(comma + 1);
+  }
+  return false;
+}
+
+// Formats the given time as an HTTP date, e.g. "Sun, 06 Nov 1994 08:49:37 GMT".
+std::string formatHttpDate(std::time_t time) {
+  std::tm tm{};
+  gmtime_r(&time, &tm);
+  char buffer[32];
+  std::strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+  return buffer;
+}
+
+// Parses an HTTP date in the IMF-fixdate format or returns -1 if the date is invalid.
+std::time_t parseHttpDate(const std::string &date) {
+  std::tm tm{};
+  if (strptime(date.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm) == nullptr) {
+    return -1;
+  }
+  return timegm(&tm);
+}
+
+// Indicates if the If-None-Match header value contains the given entity tag.
+bool matchesETag(std::string_view if_none_match, std::string_view etag) {
+  while (!if_none_match.empty()) {
+    auto comma = if_none_match.find(',');
+    auto tag = if_none_match.substr(0, comma);
+    while (!tag.empty() && tag.front() == ' ') {
+      tag.remove_prefix(1);
+    }
+    while (!tag.empty() && tag.back() == ' ') {
+      tag.remove_suffix(1);
+    }
+    // Weak comparison as required for If-None-Match.
+    if (tag.starts_with("W/")) {
+      tag.remove_prefix(2);
+    }
+    if (tag == "*" || tag == etag) {
+      return true;
+    }
+    if (comma == std::string_view::npos) {
+      break;
+    }
+    if_none_match.remove_prefix(comma + 1);
+  }
+  return false;
+}
+
+// Indicates if the client already has the current version of the resource.
+// The modification time is ignored if it is negative.
+bool isNotModified(const mobrowser::UrlRequest &request,
+                   const std::string &etag,
+                   std::time_t last_modified) {
+  auto if_none_match = getRequestHeader(request, "if-none-match");
+  if (!if_none_match.empty()) {
+    return matchesETag(if_none_match, etag);
+  }
+  auto if_modified_since = getRequestHeader(request, "if-modified-since");
+  if (!if_modified_since.empty() && last_modified >= 0) {
+    auto time = parseHttpDate(if_modified_since);
+    return time >= 0 && last_modified <= time;
+  }
+  return false;
+}
+
+enum class RangeType {
+  // No range or a range the server ignores, e.g. multiple ranges.
+  kNone,
+  kSatisfiable,
+  kUnsatisfiable
+};
+
+// Parses a single byte range from the Range header value. Requests with
+// multiple ranges are served in full, as allowed by RFC 9110.
+RangeType parseRange(std::string_view range, uintmax_t file_size, uintmax_t &first, uintmax_t &last) {
+  if (!range.starts_with("bytes=")) {
+    return RangeType::kNone;
+  }
+  range.remove_prefix(6);
+  if (range.find(',') != std::string_view::npos) {
+    return RangeType::kNone;
+  }
+  auto dash = range.find('-');
+  if (dash == std::string_view::npos) {
+    return RangeType::kNone;
+  }
+  auto parseNumber = [](std::string_view str, uintmax_t &value) {
+    if (str.empty()) {
+      return false;
+    }
+    auto result = std::from_chars(str.data(), str.data() + str.size(), value);
+    return result.ec == std::errc() && result.ptr == str.data() + str.size();
+  };
+  auto first_str = range.substr(0, dash);
+  auto last_str = range.substr(dash + 1);
+  if (first_str.empty()) {
+    // A suffix range, e.g. "bytes=-500" for the last 500 bytes.
+    uintmax_t suffix_length = 0;
+    if (!parseNumber(last_str, suffix_length)) {
+      return RangeType::kNone;
+    }
+    if (suffix_length == 0 || file_size == 0) {
+      return RangeType::kUnsatisfiable;
+    }
+    first = file_size - std::min(suffix_length, file_size);
+    last = file_size - 1;
+    return RangeType::kSatisfiable;
+  }
+  if (!parseNumber(first_str, first)) {
+    return RangeType::kNone;
+  }
+  last = file_size - 1;
+  if (!last_str.empty()) {
+    if (!parseNumber(last_str, last) || last < first) {
+      return RangeType::kNone;
+    }
+    last = std::min(last, file_size - 1);
+  }
+  if (first >= file_size) {
+    return RangeType::kUnsatisfiable;
+  }
+  return RangeType::kSatisfiable;
+}
+
+std::chrono::microseconds latencySince(std::chrono::steady_clock::time_point start_time) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start_time);
+}
+
+// The images in the blob store are named after their content, so a name
+// always refers to the same image and the browser may keep it in its cache
+// without revalidation. The legacy "image_<seconds>" names are not unique.
+bool isImmutableImage(std::string_view images_dir, std::string_view file_path) {
+  return file_path.starts_with(images_dir) && file_path.size() > images_dir.size() &&
+         FileBlobStore::isBlobName(file_path.substr(images_dir.size() + 1));
+}
+
+// Returns the value of the "w" query parameter or 0 if there is no valid one.
+int getRequestedWidth(std::string_view query) {
+  while (!query.empty()) {
+    auto end = query.find('&');
+    auto param = query.substr(0, end);
+    if (param.starts_with("w=")) {
+      int width = 0;
+      auto value = param.substr(2);
+      auto result = std::from_chars(value.data(), value.data() + value.size(), width);
+      if (result.ec == std::errc() && result.ptr == value.data() + value.size() && width > 0) {
+        return width;
+      }
+      return 0;
+    }
+    if (end == std::string_view::npos) {
+      break;
+    }
+    query.remove_prefix(end + 1);
+  }
+  return 0;
+}
+
+// Returns the path of the smallest downscaled copy of the image that is
+// not narrower than the given width or an empty string if there is no such
+// copy. The copies are not generated for the images that are narrower than
+// the level, so the original image is the best fit then.
+std::string findImageLevel(const std::string &file_path, int width) {
+  for (int level : kImagePyramidLevels) {
+    if (level < width) {
+      continue;
+    }
+    auto level_path = getImageLevelFileName(file_path, level);
+    struct stat level_stat{};
+    if (stat(level_path.c_str(), &level_stat) == 0 && S_ISREG(level_stat.st_mode)) {
+      return level_path;
+    }
+  }
+  return "";
 }
 
 UrlRequestInterceptor::UrlRequestInterceptor(std::string profile_path, std::string resources_dir) :
-    profile_path_(std::move(profile_path)), resources_dir_(std::move(resources_dir)) {}
+    profile_path_(std::move(profile_path)),
+    resources_dir_(std::move(resources_dir)),
+    images_dir_(profile_path_ + "/images"),
+    buffer_pool_(kChunkSize, kMaxPooledChunks),
+    resource_cache_(kResourceCacheSize),
+    io_pool_(kIoThreadsCount, kIoQueueSize) {}
+
+void UrlRequestInterceptor::preloadResources() {
+  resource_cache_.preload(resources_dir_);
+  LOG(INFO) << "Preloaded " << resource_cache_.sizeInBytes() << " bytes of app resources";
+}
+
+uint64_t UrlRequestInterceptor::resourceCacheHits() const {
+  return resource_cache_.hits();
+}
+
+uint64_t UrlRequestInterceptor::resourceCacheMisses() const {
+  return resource_cache_.misses();
+}
+
+const LatencyHistogram &UrlRequestInterceptor::ioLatency() const {
+  return io_pool_.latency();
+}
 
 void UrlRequestInterceptor::intercept(const mobrowser::InterceptUrlRequestArgs &args,
                                       mobrowser::InterceptUrlRequestAction action) {
+  auto start_time = std::chrono::steady_clock::now();
   URL url(args.request.url);
 
-  fs::path file_path;
-  auto url_path = url.pathItems();
+  std::string file_path;
+  auto url_path = url.path();
 
   auto host = url.host();
+  if (host == "metrics") {
+    serveMetrics(args, action);
+    return;
+  }
+
   if (host == "app") {
-    fs::path resources_dir = resources_dir_;
-    if (url_path.empty() || isRoutingPage(url.string())) {
-      file_path = resources_dir.append("index.html");
-    } else {
-      for (const auto& path_item : url_path) {
-        resources_dir.append(path_item);
+    if (isRoutingPage(url_path)) {
+      file_path = resources_dir_ + "/index.html";
+    } else if (!resolvePath(resources_dir_, url_path, file_path)) {
+      metrics_.proceeded++;
+      action.proceed();
+      return;
+    }
+    if (file_path == resources_dir_) {
+      file_path += "/index.html";
+    }
+
+    // The bundled app resources never change while the app is running,
+    // so serve them from memory without touching the file system.
+    auto accept_encoding = getRequestHeader(args.request, "accept-encoding");
+    bool cached = false;
+    for (const auto &encoding : kContentEncodings) {
+      if (acceptsEncoding(accept_encoding, encoding.name)) {
+        auto resource = findResource(file_path + encoding.extension, cached);
+        if (resource) {
+          serveResource(args, action, file_path, *resource, encoding.name, cached, start_time);
+          return;
+        }
       }
-      file_path = resources_dir;
+    }
+    auto resource = findResource(file_path, cached);
+    if (!resource) {
+      // Only the compressed file might be bundled.
+      auto compressed = findResource(file_path + ".gz", cached);
+      std::string data;
+      // The decompressed copy is only cached from now on.
+      cached = false;
+      if (compressed && gunzip(compressed->data, data)) {
+        resource = resource_cache_.add(file_path, std::move(data));
+      }
+    }
+    if (resource) {
+      serveResource(args, action, file_path, *resource, "", cached, start_time);
+      return;
     }
   }
 
   if (host == "images") {
-    fs::path profile_dir = profile_path_;
-    fs::path images_dir = profile_dir.append("images");
-    for (const auto& path_item : url_path) {
-      images_dir.append(path_item);
+    if (!resolvePath(images_dir_, url_path, file_path)) {
+      metrics_.proceeded++;
+      action.proceed();
+      return;
+    }
+    // A view that shows the image smaller than its size asks for the width
+    // it needs with the "?w=" parameter.
+    auto width = getRequestedWidth(url.query());
+    if (width > 0) {
+      auto level_path = findImageLevel(file_path, width);
+      if (!level_path.empty()) {
+        file_path = std::move(level_path);
+      }
     }
-    file_path = images_dir;
   }
 
-  if (!fs::exists(file_path) || fs::is_directory(file_path)) {
+  struct stat file_stat{};
+  if (file_path.empty() || stat(file_path.c_str(), &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+    metrics_.proceeded++;
     action.proceed();
     return;
   }
 
-  auto file_size = fs::file_size(file_path);
-  auto file_extension = getFileExtension(file_path);
-  const auto mime_type = kMimeTypes[file_extension];
+  auto &metrics = host == "app" ? metrics_.app : metrics_.images;
+  serveFile(args, action, file_path, file_stat, metrics, start_time);
+}
+
+std::shared_ptr<const Resource> UrlRequestInterceptor::findResource(const std::string &path, bool &cached) {
+  auto resource = resource_cache_.get(path);
+  cached = resource != nullptr;
+  if (!resource) {
+    resource = resource_cache_.load(path);
+  }
+  return resource;
+}
+
+void UrlRequestInterceptor::serveMetrics(const mobrowser::InterceptUrlRequestArgs &args,
+                                         mobrowser::InterceptUrlRequestAction &action) {
+  auto json = "{\"app\":" + metrics_.app.toJson() +
+              ",\"images\":" + metrics_.images.toJson() +
+              ",\"proceeded\":" + std::to_string(metrics_.proceeded.load()) +
+              ",\"resourceCache\":{\"hits\":" + std::to_string(resource_cache_.hits()) +
+              ",\"misses\":" + std::to_string(resource_cache_.misses()) +
+              ",\"bytes\":" + std::to_string(resource_cache_.sizeInBytes()) + "}" +
+              ",\"io\":" + latencyToJson(io_pool_.latency()) + "}";
+
+  std::vector<mobrowser::HttpHeader> headers;
+  headers.emplace_back("content-type", "application/json");
+  headers.emplace_back("cache-control", "no-store");
+  headers.emplace_back("content-length", std::to_string(json.size()));
+
+  auto job = args.job_factory->createJob(mobrowser::kOk, headers);
+  writeData(job, json.data(), json.size());
+  job->complete();
+  action.intercept(job);
+}
 
+void UrlRequestInterceptor::serveResource(const mobrowser::InterceptUrlRequestArgs &args,
+                                          mobrowser::InterceptUrlRequestAction &action,
+                                          const std::string &file_path,
+                                          const Resource &resource,
+                                          const std::string &content_encoding,
+                                          bool cached,
+                                          std::chrono::steady_clock::time_point start_time) {
+  if (cached) {
+    metrics_.app.cache_hits++;
+  }
   std::vector<mobrowser::HttpHeader> headers;
-  headers.emplace_back("content-type", mime_type);
   headers.emplace_back("cache-control", "no-cache");
-  headers.emplace_back("content-length", std::to_string(file_size));
+  headers.emplace_back("etag", resource.etag);
+  headers.emplace_back("vary", "accept-encoding");
+
+  if (isNotModified(args.request, resource.etag, -1)) {
+    auto job = args.job_factory->createJob(mobrowser::kNotModified, headers);
+    job->complete();
+    action.intercept(job);
+    metrics_.app.not_modified++;
+    metrics_.app.record(0, latencySince(start_time));
+    return;
+  }
+
+  headers.emplace_back("content-type", std::string(getMimeType(getFileExtension(file_path))));
+  headers.emplace_back("content-length", std::to_string(resource.data.size()));
+  if (!content_encoding.empty()) {
+    headers.emplace_back("content-encoding", content_encoding);
+  }
 
   auto job = args.job_factory->createJob(mobrowser::kOk, headers);
-  std::ifstream file(file_path, std::ios::binary);
-  if (file.is_open()) {
-    char* buffer = new char[file_size];
-    int buffer_size = static_cast<int>(file_size);
-    file.read(buffer, buffer_size);
-    job->write(buffer, buffer_size);
-    delete[] buffer;
-    file.close();
+  writeData(job, resource.data.data(), resource.data.size());
+  job->complete();
+  action.intercept(job);
+  metrics_.app.record(resource.data.size(), latencySince(start_time));
+}
+
+void UrlRequestInterceptor::serveFile(const mobrowser::InterceptUrlRequestArgs &args,
+                                      mobrowser::InterceptUrlRequestAction &action,
+                                      const std::string &file_path,
+                                      const struct stat &file_stat,
+                                      HostMetrics &metrics,
+                                      std::chrono::steady_clock::time_point start_time) {
+  auto file_size = static_cast<uintmax_t>(file_stat.st_size);
+  auto last_modified = file_stat.st_mtime;
+  // The size and the modification time identify the file version without
+  // reading its contents.
+  auto etag = "\"" + hashToHex(file_size) + "-" + hashToHex(last_modified) + "\"";
+
+  std::vector<mobrowser::HttpHeader> headers;
+  if (isImmutableImage(images_dir_, file_path)) {
+    headers.emplace_back("cache-control", "public, max-age=31536000, immutable");
+  } else {
+    headers.emplace_back("cache-control", "no-cache");
+  }
+  headers.emplace_back("etag", etag);
+  headers.emplace_back("last-modified", formatHttpDate(last_modified));
+
+  if (isNotModified(args.request, etag, last_modified)) {
+    auto job = args.job_factory->createJob(mobrowser::kNotModified, headers);
+    job->complete();
+    action.intercept(job);
+    metrics.not_modified++;
+    metrics.record(0, latencySince(start_time));
+    return;
+  }
+
+  // Serve a part of the file if requested and the file has not changed
+  // since the client got the first part of it.
+  uintmax_t first = 0;
+  uintmax_t last = file_size > 0 ? file_size - 1 : 0;
+  auto range_type = RangeType::kNone;
+  auto range = getRequestHeader(args.request, "range");
+  if (!range.empty()) {
+    auto if_range = getRequestHeader(args.request, "if-range");
+    if (if_range.empty() || if_range == etag) {
+      range_type = parseRange(range, file_size, first, last);
+    }
+  }
+
+  if (range_type == RangeType::kUnsatisfiable) {
+    headers.emplace_back("content-range", "bytes */" + std::to_string(file_size));
+    auto job = args.job_factory->createJob(mobrowser::kRangeNotSatisfiable, headers);
+    job->complete();
+    action.intercept(job);
+    metrics.record(0, latencySince(start_time));
+    return;
+  }
+
+  auto content_length = file_size > 0 ? last - first + 1 : 0;
+  auto file_extension = getFileExtension(file_path);
+  headers.emplace_back("content-type", std::string(getMimeType(file_extension)));
+  headers.emplace_back("content-length", std::to_string(content_length));
+  headers.emplace_back("accept-ranges", "bytes");
+
+  auto status = mobrowser::kOk;
+  if (range_type == RangeType::kSatisfiable) {
+    status = mobrowser::kPartialContent;
+    headers.emplace_back("content-range", "bytes " + std::to_string(first) + "-" +
+                                          std::to_string(last) + "/" + std::to_string(file_size));
+  }
+
+  auto job = args.job_factory->createJob(status, headers);
+  action.intercept(job);
+
+  // Read the file and complete the job on the I/O pool, so that concurrent
+  // requests, e.g. thumbnails of the visible history items, do not wait
+  // for each other on the calling thread.
+  auto write_body = [this, job, file_path, file_size, first, content_length, &metrics, start_time]() {
+    auto bytes_written = writeBody(job, file_path, file_size, first, content_length);
+    if (bytes_written < 0) {
+      metrics.failures++;
+    }
+    metrics.record(std::max<int64_t>(bytes_written, 0), latencySince(start_time));
+  };
+  if (!io_pool_.post(write_body)) {
+    // The queue is full, so apply back pressure to the calling thread.
+    write_body();
+  }
+}
+
+int64_t UrlRequestInterceptor::writeBody(const std::shared_ptr<mobrowser::UrlRequestJob> &job,
+                                         const std::string &file_path,
+                                         uintmax_t file_size,
+                                         uintmax_t offset,
+                                         uintmax_t length) {
+  int64_t bytes_written = -1;
+  if (length >= kMapFileThreshold) {
+    // Feed the mapped pages directly to the job to avoid copying large
+    // images into an intermediate buffer.
+    MappedFile mapped_file(file_path);
+    if (mapped_file.isValid() && mapped_file.size() == file_size) {
+      writeData(job, mapped_file.data() + offset, length);
+      bytes_written = static_cast<int64_t>(length);
+    }
+  }
+  if (bytes_written < 0) {
+    bytes_written = writeFile(job, file_path, offset, length);
+  }
+  if (bytes_written == static_cast<int64_t>(length)) {
     job->complete();
   } else {
     LOG(ERROR) << "Failed to read file " << file_path;
     job->fail();
   }
-  action.intercept(job);
+  return bytes_written;
+}
+
+void UrlRequestInterceptor::writeData(const std::shared_ptr<mobrowser::UrlRequestJob> &job,
+                                      const char *data,
+                                      std::size_t size) {
+  std::size_t offset = 0;
+  while (offset < size) {
+    auto chunk_size = std::min(size - offset, kChunkSize);
+    job->write(data + offset, static_cast<int>(chunk_size));
+    offset += chunk_size;
+  }
+}
+
+int64_t UrlRequestInterceptor::writeFile(const std::shared_ptr<mobrowser::UrlRequestJob> &job,
+                                         const std::string &file_path,
+                                         uintmax_t offset,
+                                         uintmax_t length) {
+  std::ifstream file(file_path, std::ios::binary);
+  if (!file.is_open()) {
+    return -1;
+  }
+  if (offset > 0 && !file.seekg(static_cast<std::streamoff>(offset))) {
+    return -1;
+  }
+  // Reuse a pooled buffer so the memory used by a request does not depend
+  // on the file size.
+  auto buffer = buffer_pool_.acquire();
+  int64_t bytes_written = 0;
+  auto bytes_left = length;
+  while (file && bytes_left > 0) {
+    auto bytes_to_read = std::min<uintmax_t>(bytes_left, buffer.size());
+    file.read(buffer.data(), static_cast<std::streamsize>(bytes_to_read));
+    auto bytes_read = file.gcount();
+    if (bytes_read <= 0) {
+      break;
+    }
+    job->write(buffer.data(), static_cast<int>(bytes_read));
+    bytes_written += bytes_read;
+    bytes_left -= bytes_read;
+  }
+  if (file.bad()) {
+    return -1;
+  }
+  return bytes_written;
 }
@@ -1,7 +1,17 @@
 #ifndef CLIPBOOK_URL_REQUEST_INTERCEPTOR_H_
 #define CLIPBOOK_URL_REQUEST_INTERCEPTOR_H_
 
+#include <sys/stat.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
 #include "mobrowser.hpp"
+#include "buffer_pool.h"
+#include "request_metrics.h"
+#include "resource_cache.h"
+#include "worker_pool.h"
 
 static std::string kClipBookScheme = "clipbook";
 
@@ -12,9 +22,73 @@ class UrlRequestInterceptor {
   virtual void intercept(const mobrowser::InterceptUrlRequestArgs &args,
                          mobrowser::InterceptUrlRequestAction action);
 
+  // Loads the bundled app resources into the memory cache.
+  void preloadResources();
+
+  [[nodiscard]] uint64_t resourceCacheHits() const;
+  [[nodiscard]] uint64_t resourceCacheMisses() const;
+
+  // The time between scheduling a file read and completing its job.
+  [[nodiscard]] const LatencyHistogram &ioLatency() const;
+
+ private:
+  // Returns the cached contents of the bundled file or loads it into the
+  // cache. Sets cached to indicate if the file was already in the cache.
+  std::shared_ptr<const Resource> findResource(const std::string &path, bool &cached);
+
+  // Serves the request metrics of the interceptor as JSON.
+  void serveMetrics(const mobrowser::InterceptUrlRequestArgs &args,
+                    mobrowser::InterceptUrlRequestAction &action);
+
+  void serveResource(const mobrowser::InterceptUrlRequestArgs &args,
+                     mobrowser::InterceptUrlRequestAction &action,
+                     const std::string &file_path,
+                     const Resource &resource,
+                     const std::string &content_encoding,
+                     bool cached,
+                     std::chrono::steady_clock::time_point start_time);
+
+  // Serves the file, the requested range of the file, or responds with 304
+  // if the browser has the same version of the file in its cache. The file
+  // is read on the I/O pool.
+  void serveFile(const mobrowser::InterceptUrlRequestArgs &args,
+                 mobrowser::InterceptUrlRequestAction &action,
+                 const std::string &file_path,
+                 const struct stat &file_stat,
+                 HostMetrics &metrics,
+                 std::chrono::steady_clock::time_point start_time);
+
+  // Writes the given part of the file to the job and completes it. Returns
+  // the number of bytes written or -1 if the file could not be read.
+  int64_t writeBody(const std::shared_ptr<mobrowser::UrlRequestJob> &job,
+                    const std::string &file_path,
+                    uintmax_t file_size,
+                    uintmax_t offset,
+                    uintmax_t length);
+
+  // Writes the given data to the job in chunks of the pool buffer size.
+  void writeData(const std::shared_ptr<mobrowser::UrlRequestJob> &job,
+                 const char *data,
+                 std::size_t size);
+
+  // Streams the given part of the file to the job in chunks of the pool
+  // buffer size and returns the number of bytes written or -1 if the file
+  // could not be read.
+  int64_t writeFile(const std::shared_ptr<mobrowser::UrlRequestJob> &job,
+                    const std::string &file_path,
+                    uintmax_t offset,
+                    uintmax_t length);
+
  private:
   std::string profile_path_;
   std::string resources_dir_;
+  std::string images_dir_;
+  BufferPool buffer_pool_;
+  ResourceCache resource_cache_;
+  RequestMetrics metrics_;
+  // Must be the last member so that the threads stop before the other
+  // members used by the pending jobs are destroyed.
+  WorkerPool io_pool_;
 };
 
 #endif  // CLIPBOOK_URL_REQUEST_INTERCEPTOR_H_
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdio>
 
 bool isEmptyOrSpaces(const std::string &str) {
   // Check if the string is empty or contains only spaces
@@ -30,3 +31,51 @@ long long getCurrentTimeMillis() {
   return duration_cast<std::chrono::milliseconds>(
       std::chrono::system_clock::now().time_since_epoch()).count();
 }
+
+std::string toJsonString(const std::string &str) {
+  std::string result;
+  result.reserve(str.size() + 2);
+  result += '"';
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      case '\r':
+        result += "\\r";
+        break;
+      case '\t':
+        result += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+          result += escaped;
+        } else {
+          result += c;
+        }
+        break;
+    }
+  }
+  result += '"';
+  return result;
+}
+
+std::string truncateUtf8(const std::string &str, std::size_t max_size) {
+  if (str.size() <= max_size) {
+    return str;
+  }
+  auto size = max_size;
+  // Skip back over the continuation bytes of the cut character.
+  while (size > 0 && (static_cast<unsigned char>(str[size]) & 0xC0) == 0x80) {
+    size--;
+  }
+  return str.substr(0, size);
+}
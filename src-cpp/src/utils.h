@@ -1,6 +1,7 @@
 #ifndef CLIPBOOK_UTILS_H_
 #define CLIPBOOK_UTILS_H_
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -16,4 +17,11 @@ std::string getAppDataDir();
 // Returns the current time in milliseconds since the UNIX epoch.
 long long getCurrentTimeMillis();
 
+// Returns the string as a quoted JSON string.
+std::string toJsonString(const std::string &str);
+
+// Returns the beginning of the UTF-8 string of at most max_size bytes that
+// does not end in the middle of a character.
+std::string truncateUtf8(const std::string &str, std::size_t max_size);
+
 #endif  // CLIPBOOK_UTILS_H_
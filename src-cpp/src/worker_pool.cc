@@ -0,0 +1,59 @@
+#include "worker_pool.h"
+
+#include <utility>
+
+WorkerPool::WorkerPool(std::size_t threads_count, std::size_t max_queue_size)
+    : max_queue_size_(max_queue_size) {
+  for (std::size_t i = 0; i < threads_count; ++i) {
+    threads_.emplace_back([this]() {
+      run();
+    });
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stopped_ = true;
+  }
+  condition_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+bool WorkerPool::post(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (stopped_ || tasks_.size() >= max_queue_size_) {
+      return false;
+    }
+    tasks_.push_back({std::move(task), std::chrono::steady_clock::now()});
+  }
+  condition_.notify_one();
+  return true;
+}
+
+const LatencyHistogram &WorkerPool::latency() const {
+  return latency_;
+}
+
+void WorkerPool::run() {
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this]() {
+        return stopped_ || !tasks_.empty();
+      });
+      if (stopped_ && tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task.run();
+    latency_.record(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - task.post_time));
+  }
+}
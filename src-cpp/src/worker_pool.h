@@ -0,0 +1,47 @@
+#ifndef CLIPBOOK_WORKER_POOL_H_
+#define CLIPBOOK_WORKER_POOL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "latency_histogram.h"
+
+// A fixed number of threads executing tasks from a bounded queue.
+class WorkerPool {
+ public:
+  WorkerPool(std::size_t threads_count, std::size_t max_queue_size);
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+  ~WorkerPool();
+
+  // Schedules the task for execution. Returns false if the queue is full
+  // and the task has not been scheduled.
+  bool post(std::function<void()> task);
+
+  // The time between posting a task and its completion.
+  [[nodiscard]] const LatencyHistogram &latency() const;
+
+ private:
+  struct Task {
+    std::function<void()> run;
+    std::chrono::steady_clock::time_point post_time;
+  };
+
+  void run();
+
+ private:
+  const std::size_t max_queue_size_;
+  bool stopped_ = false;
+  std::deque<Task> tasks_;
+  std::vector<std::thread> threads_;
+  LatencyHistogram latency_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+};
+
+#endif  // CLIPBOOK_WORKER_POOL_H_
@@ -0,0 +1,31 @@
+#ifndef CLIPBOOK_TESTS_BENCHMARK_H_
+#define CLIPBOOK_TESTS_BENCHMARK_H_
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+// Keeps the compiler from optimizing away the computation of the value.
+template <typename T>
+inline void doNotOptimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Runs the function the given number of times and prints the average time
+// of a run in nanoseconds and the number of runs per second.
+template <typename Function>
+void runBenchmark(const char *name, uint64_t iterations, Function &&function) {
+  // Warm up the caches and the branch predictors.
+  for (uint64_t i = 0; i < iterations / 10; ++i) {
+    function();
+  }
+  auto start_time = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < iterations; ++i) {
+    function();
+  }
+  auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_time);
+  auto ns_per_run = elapsed.count() / static_cast<double>(iterations);
+  std::printf("%-40s %10.1f ns/op %14.0f ops/s\n", name, ns_per_run, 1e9 / ns_per_run);
+}
+
+#endif  // CLIPBOOK_TESTS_BENCHMARK_H_
@@ -0,0 +1,30 @@
+#include "blob_store.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+
+namespace fs = std::filesystem;
+
+// Measures the reference count changes of a store with many blobs, which
+// used to rewrite the whole refs file every time.
+int main() {
+  auto dir = fs::temp_directory_path() / "clipbook_blob_store_benchmark";
+  fs::remove_all(dir);
+  FileBlobStore store(dir.string(), ".txt");
+  std::vector<std::string> names;
+  for (int i = 0; i < 10'000; ++i) {
+    names.push_back(store.add("key" + std::to_string(i), "data"));
+  }
+
+  std::size_t index = 0;
+  runBenchmark("retain + release of 10000 blobs", 20'000, [&]() {
+    const auto &name = names[index++ % names.size()];
+    store.retain(name);
+    store.release(name);
+  });
+  fs::remove_all(dir);
+  return 0;
+}
@@ -0,0 +1,154 @@
+#include "blob_store.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "test.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path makeTempDir(const std::string &name) {
+  auto dir = fs::temp_directory_path() / ("clipbook_" + name);
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  return dir;
+}
+
+bool hasBlob(const fs::path &dir, const std::string &name) {
+  return fs::is_regular_file(dir / name);
+}
+
+void testReferenceCounting() {
+  auto dir = makeTempDir("blob_store_refs");
+  FileBlobStore store(dir.string(), ".txt");
+  CHECK(store.add("a", "data").empty());
+  CHECK(store.add("ab/c", "data").empty());
+  CHECK(store.find("ab12").empty());
+
+  auto name = store.add("ab12", "data");
+  CHECK(name == "blobs/ab/ab12.txt");
+  CHECK(store.find("ab12") == name);
+  CHECK(store.add("ab12", "data") == name);
+  CHECK(store.retain(name));
+  CHECK(!store.retain("blobs/cd/cd34.txt"));
+  CHECK(!store.release("../outside.txt"));
+
+  CHECK(store.release(name));
+  CHECK(store.release(name));
+  CHECK(hasBlob(dir, name));
+  CHECK(store.release(name));
+  CHECK(!hasBlob(dir, name));
+  CHECK(store.find("ab12").empty());
+}
+
+void testReplace() {
+  auto dir = makeTempDir("blob_store_replace");
+  FileBlobStore store(dir.string(), ".txt");
+  auto name = store.add("ab12", "data");
+  CHECK(store.replace(name, "smaller"));
+  std::ifstream file(dir / name);
+  std::string content;
+  std::getline(file, content);
+  CHECK(content == "smaller");
+  // The released blob is not brought back.
+  CHECK(store.release(name));
+  CHECK(!store.replace(name, "data"));
+  CHECK(!hasBlob(dir, name));
+  CHECK(!store.replace("../outside.txt", "data"));
+}
+
+void testReload() {
+  auto dir = makeTempDir("blob_store_reload");
+  std::string name;
+  {
+    FileBlobStore store(dir.string(), ".txt");
+    name = store.add("ab12", "data");
+    CHECK(store.retain(name));
+  }
+  FileBlobStore store(dir.string(), ".txt");
+  CHECK(store.release(name));
+  CHECK(hasBlob(dir, name));
+  CHECK(store.release(name));
+  CHECK(!hasBlob(dir, name));
+}
+
+void testCompaction() {
+  auto dir = makeTempDir("blob_store_compaction");
+  std::string name;
+  {
+    FileBlobStore store(dir.string(), ".txt");
+    name = store.add("ab12", "data");
+    // Enough changes to compact the journal several times.
+    for (int i = 0; i < 5000; ++i) {
+      CHECK(store.retain(name));
+      CHECK(store.release(name));
+    }
+    CHECK(store.retain(name));
+  }
+  CHECK(fs::file_size(dir / "blobs" / "refs.journal") < 64 * 1024);
+  FileBlobStore store(dir.string(), ".txt");
+  CHECK(store.release(name));
+  CHECK(hasBlob(dir, name));
+  CHECK(store.release(name));
+  CHECK(!hasBlob(dir, name));
+}
+
+void testLostRefs() {
+  auto dir = makeTempDir("blob_store_lost");
+  std::string shared_name;
+  std::string name;
+  {
+    FileBlobStore store(dir.string(), ".txt");
+    shared_name = store.add("ab12", "shared");
+    CHECK(store.retain(shared_name));
+    // The journal is compacted, so the shared blob's count is only in the
+    // refs file.
+    name = store.add("cd34", "data");
+    for (int i = 0; i < 2000; ++i) {
+      CHECK(store.retain(name));
+      CHECK(store.release(name));
+    }
+  }
+  // The blob referenced by several clips is not removed with the first
+  // release once its reference count is lost.
+  fs::remove(dir / "blobs" / "refs");
+  {
+    FileBlobStore store(dir.string(), ".txt");
+    CHECK(store.release(shared_name));
+    CHECK(hasBlob(dir, shared_name));
+    // The counts still in the journal are kept.
+    CHECK(store.release(name));
+    CHECK(!hasBlob(dir, name));
+  }
+  // The refs stay marked as lost after the journal is compacted.
+  FileBlobStore store(dir.string(), ".txt");
+  CHECK(store.release(shared_name));
+  CHECK(hasBlob(dir, shared_name));
+}
+
+void testLegacyRefs() {
+  auto dir = makeTempDir("blob_store_legacy");
+  fs::create_directories(dir / "blobs" / "ab");
+  std::ofstream(dir / "blobs" / "ab" / "ab12.txt") << "data";
+  std::ofstream(dir / "blobs" / "refs") << "blobs/ab/ab12.txt 2\n";
+  FileBlobStore store(dir.string(), ".txt");
+  CHECK(store.release("blobs/ab/ab12.txt"));
+  CHECK(hasBlob(dir, "blobs/ab/ab12.txt"));
+  CHECK(store.release("blobs/ab/ab12.txt"));
+  CHECK(!hasBlob(dir, "blobs/ab/ab12.txt"));
+}
+
+}  // namespace
+
+int main() {
+  testReferenceCounting();
+  testReplace();
+  testReload();
+  testCompaction();
+  testLostRefs();
+  testLegacyRefs();
+  return 0;
+}
@@ -0,0 +1,143 @@
+#include "clip_log.h"
+
+#include <filesystem>
+#include <string>
+
+#include "test.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path makeLogPath(const std::string &name) {
+  auto dir = fs::temp_directory_path() / ("clipbook_" + name);
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  return dir / "clips.log";
+}
+
+std::string getClip(int index) {
+  return "{\"content\":\"clip " + std::to_string(index) + "\"}";
+}
+
+void testReopen() {
+  auto path = makeLogPath("clip_log_reopen");
+  {
+    ClipLog log(path.string());
+    for (int i = 1; i <= 10; ++i) {
+      CHECK(log.append(getClip(i)) == static_cast<uint64_t>(i));
+    }
+  }
+  ClipLog log(path.string());
+  CHECK(log.pendingCount() == 10);
+  auto entries = log.read(0, 100);
+  CHECK(entries.size() == 10);
+  for (int i = 0; i < 10; ++i) {
+    CHECK(entries[i].sequence == static_cast<uint64_t>(i + 1));
+    CHECK(entries[i].data == getClip(i + 1));
+  }
+  entries = log.read(7, 2);
+  CHECK(entries.size() == 2);
+  CHECK(entries[0].sequence == 8);
+  CHECK(log.append(getClip(11)) == 11);
+}
+
+void testTornRecord() {
+  auto path = makeLogPath("clip_log_torn");
+  {
+    ClipLog log(path.string());
+    for (int i = 1; i <= 3; ++i) {
+      log.append(getClip(i));
+    }
+  }
+  auto complete_size = fs::file_size(path);
+  {
+    ClipLog log(path.string());
+    log.append(getClip(4));
+  }
+  // Every cut inside the last record leaves the three complete ones.
+  auto full_size = fs::file_size(path);
+  for (auto size = complete_size; size < full_size; ++size) {
+    auto copy = path.string() + ".copy";
+    fs::copy_file(path, copy, fs::copy_options::overwrite_existing);
+    fs::resize_file(copy, size);
+    {
+      ClipLog log(copy);
+      auto entries = log.read(0, 100);
+      CHECK(entries.size() == 3);
+      CHECK(entries.back().data == getClip(3));
+      // The torn tail is truncated, so the next record is readable.
+      CHECK(log.append(getClip(5)) == 4);
+    }
+    // The new record takes the place of the torn one.
+    CHECK(fs::file_size(copy) == full_size);
+    ClipLog log(copy);
+    CHECK(log.read(3, 100).size() == 1);
+    CHECK(log.read(3, 100)[0].data == getClip(5));
+  }
+
+  // The file with a broken header is dropped.
+  fs::resize_file(path, 4);
+  ClipLog log(path.string());
+  CHECK(log.pendingCount() == 0);
+  CHECK(log.append(getClip(1)) == 1);
+}
+
+void testAcknowledge() {
+  auto path = makeLogPath("clip_log_acknowledge");
+  {
+    ClipLog log(path.string());
+    for (int i = 1; i <= 10; ++i) {
+      log.append(getClip(i));
+    }
+    log.acknowledge(4);
+    CHECK(log.pendingCount() == 6);
+    // The clips acknowledged before are not acknowledged again.
+    log.acknowledge(2);
+    CHECK(log.pendingCount() == 6);
+  }
+  ClipLog log(path.string());
+  auto entries = log.read(0, 100);
+  CHECK(entries.size() == 6);
+  CHECK(entries.front().sequence == 5);
+}
+
+void testCompaction() {
+  auto path = makeLogPath("clip_log_compaction");
+  uint64_t sequence = 0;
+  {
+    ClipLog log(path.string());
+    for (int i = 1; i <= 200; ++i) {
+      sequence = log.append(getClip(i));
+    }
+    auto size = fs::file_size(path);
+    // Most of the records become obsolete and the log is rewritten.
+    log.acknowledge(195);
+    CHECK(fs::file_size(path) < size / 10);
+    CHECK(!fs::exists(path.string() + ".tmp"));
+    CHECK(log.pendingCount() == 5);
+    CHECK(log.append(getClip(201)) == sequence + 1);
+  }
+  ClipLog log(path.string());
+  auto entries = log.read(0, 100);
+  CHECK(entries.size() == 6);
+  for (int i = 0; i < 6; ++i) {
+    CHECK(entries[i].sequence == static_cast<uint64_t>(196 + i));
+    CHECK(entries[i].data == getClip(196 + i));
+  }
+  // The sequence numbers are not reused after all the clips are
+  // acknowledged.
+  log.acknowledge(201);
+  CHECK(log.pendingCount() == 0);
+  CHECK(log.append(getClip(202)) == 202);
+}
+
+}  // namespace
+
+int main() {
+  testReopen();
+  testTornRecord();
+  testAcknowledge();
+  testCompaction();
+  return 0;
+}
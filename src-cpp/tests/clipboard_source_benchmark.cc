@@ -0,0 +1,58 @@
+#include "clipboard_source.h"
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+#include "benchmark.h"
+#include "fake_clipboard_source.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Prints how many times the idle clipboard is checked in a second.
+void measureIdleChecks(const char *name, PollSchedule schedule) {
+  auto source = std::make_shared<FakeClipboardSource>(false);
+  ClipboardWatcher watcher(source, schedule, []() {
+    return true;
+  });
+  watcher.start();
+  std::this_thread::sleep_for(1s);
+  watcher.stop();
+  std::printf("%-40s %10ld checks/s\n", name, source->checksCount());
+}
+
+// Measures the time from a copy to the handler call.
+void measureLatency(const char *name, bool notifies) {
+  auto source = std::make_shared<FakeClipboardSource>(notifies);
+  std::atomic<long> calls = 0;
+  ClipboardWatcher watcher(source, PollSchedule(100ms, 2000ms), [&calls]() {
+    calls++;
+    return true;
+  });
+  watcher.start();
+  long copies = 0;
+  runBenchmark(name, 20, [&]() {
+    source->copy();
+    copies++;
+    while (calls < copies) {
+      std::this_thread::sleep_for(100us);
+    }
+  });
+}
+
+}  // namespace
+
+int main() {
+  runBenchmark("PollSchedule::onCheck", 10'000'000, []() {
+    static PollSchedule schedule(100ms, 2000ms);
+    doNotOptimize(schedule.onCheck(false));
+  });
+  measureIdleChecks("idle, fixed 100 ms interval", PollSchedule(100ms, 100ms));
+  measureIdleChecks("idle, 100 ms backing off to 2 s", PollSchedule(100ms, 2000ms));
+  measureLatency("copy to handler, polled", false);
+  measureLatency("copy to handler, notified", true);
+  return 0;
+}
@@ -0,0 +1,132 @@
+#include "clipboard_source.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "fake_clipboard_source.h"
+#include "test.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Waits until the counter reaches the value or the timeout expires.
+bool waitFor(const std::atomic<int> &counter, int value, std::chrono::milliseconds timeout) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (counter < value) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(1ms);
+  }
+  return true;
+}
+
+void testPollSchedule() {
+  PollSchedule schedule(100ms, 1000ms);
+  CHECK(schedule.delay() == 100ms);
+  CHECK(schedule.onCheck(false) == 200ms);
+  CHECK(schedule.onCheck(false) == 400ms);
+  CHECK(schedule.onCheck(false) == 800ms);
+  CHECK(schedule.onCheck(false) == 1000ms);
+  CHECK(schedule.onCheck(false) == 1000ms);
+  CHECK(schedule.onCheck(true) == 100ms);
+  schedule.onCheck(false);
+  schedule.onActivity();
+  CHECK(schedule.delay() == 100ms);
+
+  // The maximum interval is never less than the minimum one.
+  PollSchedule fixed(100ms, 10ms);
+  CHECK(fixed.onCheck(false) == 100ms);
+}
+
+void testPolling() {
+  auto source = std::make_shared<FakeClipboardSource>(false);
+  // The content copied before the start is not reported.
+  source->copy();
+  std::atomic<int> calls = 0;
+  ClipboardWatcher watcher(source, PollSchedule(5ms, 20ms), [&calls]() {
+    calls++;
+    return true;
+  });
+  watcher.start();
+  std::this_thread::sleep_for(50ms);
+  CHECK(calls == 0);
+  CHECK(source->checksCount() > 1);
+  source->copy();
+  CHECK(waitFor(calls, 1, 1000ms));
+  std::this_thread::sleep_for(50ms);
+  CHECK(calls == 1);
+  watcher.stop();
+}
+
+void testNotification() {
+  auto source = std::make_shared<FakeClipboardSource>(true);
+  std::atomic<int> calls = 0;
+  // Without the notification the change would be found in a minute.
+  ClipboardWatcher watcher(source, PollSchedule(60s, 60s), [&calls]() {
+    calls++;
+    return true;
+  });
+  watcher.start();
+  source->copy();
+  CHECK(waitFor(calls, 1, 1000ms));
+  source->copy();
+  CHECK(waitFor(calls, 2, 1000ms));
+}
+
+void testHandlerRetry() {
+  auto source = std::make_shared<FakeClipboardSource>(false);
+  std::atomic<int> calls = 0;
+  // The same change is reported until the handler accepts it.
+  ClipboardWatcher watcher(source, PollSchedule(5ms, 5ms), [&calls]() {
+    return ++calls >= 3;
+  });
+  watcher.start();
+  source->copy();
+  CHECK(waitFor(calls, 3, 1000ms));
+  std::this_thread::sleep_for(50ms);
+  CHECK(calls == 3);
+}
+
+void testActivity() {
+  auto source = std::make_shared<FakeClipboardSource>(false);
+  std::atomic<int> calls = 0;
+  ClipboardWatcher watcher(source, PollSchedule(20ms, 60s), [&calls]() {
+    calls++;
+    return true;
+  });
+  watcher.start();
+  // The idle checks back off, the next one is seconds away.
+  std::this_thread::sleep_for(2600ms);
+  source->copy();
+  watcher.notifyActivity();
+  CHECK(waitFor(calls, 1, 1000ms));
+}
+
+void testStop() {
+  auto source = std::make_shared<FakeClipboardSource>(true);
+  std::atomic<int> calls = 0;
+  ClipboardWatcher watcher(source, PollSchedule(5ms, 5ms), [&calls]() {
+    calls++;
+    return true;
+  });
+  watcher.start();
+  watcher.stop();
+  source->copy();
+  std::this_thread::sleep_for(50ms);
+  CHECK(calls == 0);
+}
+
+}  // namespace
+
+int main() {
+  testPollSchedule();
+  testPolling();
+  testNotification();
+  testHandlerRetry();
+  testActivity();
+  testStop();
+  return 0;
+}
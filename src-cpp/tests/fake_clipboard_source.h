@@ -0,0 +1,50 @@
+#ifndef CLIPBOOK_TESTS_FAKE_CLIPBOARD_SOURCE_H_
+#define CLIPBOOK_TESTS_FAKE_CLIPBOARD_SOURCE_H_
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+#include "clipboard_source.h"
+
+// A clipboard whose content is changed by the test. It notifies about the
+// changes only if asked to, otherwise the watcher has to poll it.
+class FakeClipboardSource : public ClipboardSource {
+ public:
+  explicit FakeClipboardSource(bool notifies) : notifies_(notifies) {}
+
+  long changeCount() override {
+    checks_count_++;
+    return change_count_;
+  }
+
+  bool setChangeListener(std::function<void()> listener) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listener_ = std::move(listener);
+    return notifies_;
+  }
+
+  // Changes the content as a copy in another app does.
+  void copy() {
+    change_count_++;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (notifies_ && listener_) {
+      listener_();
+    }
+  }
+
+  // Returns the number of times the watcher checked the clipboard.
+  long checksCount() const {
+    return checks_count_;
+  }
+
+ private:
+  const bool notifies_;
+  std::atomic<long> change_count_ = 0;
+  std::atomic<long> checks_count_ = 0;
+  std::function<void()> listener_;
+  std::mutex mutex_;
+};
+
+#endif  // CLIPBOOK_TESTS_FAKE_CLIPBOARD_SOURCE_H_
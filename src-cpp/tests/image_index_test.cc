@@ -0,0 +1,184 @@
+#include "image_index.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "test.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+ImageMetadata makeImage(const std::string &file_name, uint64_t hash) {
+  ImageMetadata metadata;
+  metadata.file_name = file_name;
+  metadata.thumb_file_name = file_name + "_thumb";
+  metadata.width = 64;
+  metadata.height = 32;
+  metadata.hash = hash;
+  metadata.perceptual_hash = hash;
+  metadata.hashed = true;
+  return metadata;
+}
+
+fs::path makeTempDir(const std::string &name) {
+  auto dir = fs::temp_directory_path() / ("clipbook_" + name);
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  return dir;
+}
+
+void testSameHash() {
+  auto dir = makeTempDir("image_index");
+  {
+    ImageIndex index(dir.string());
+    CHECK(index.add(makeImage("image_1.png", 42)));
+    CHECK(index.find(42, 64, 32) == "image_1.png");
+    CHECK(index.find(42, 32, 64).empty());
+
+    // The identical image stored under another name takes over the hash,
+    // but the metadata of the first one is kept.
+    CHECK(index.add(makeImage("blobs/2a/2a.png", 42)));
+    CHECK(index.find(42, 64, 32) == "blobs/2a/2a.png");
+    ImageMetadata metadata;
+    CHECK(index.getMetadata("image_1.png", metadata));
+    CHECK(metadata.thumb_file_name == "image_1.png_thumb");
+    CHECK(index.list().size() == 2);
+
+    // The update of a removed image does not add it back.
+    auto removed = makeImage("blobs/2a/2a.png", 42);
+    removed.optimized = true;
+    index.remove("blobs/2a/2a.png");
+    CHECK(!index.update(removed));
+    CHECK(index.find(42, 64, 32).empty());
+    CHECK(index.getMetadata("image_1.png", metadata));
+    CHECK(index.findSimilar(43, 64, 32, 1) == "image_1.png");
+    metadata.has_text = true;
+    CHECK(index.update(metadata));
+  }
+  // The same state is restored from the records.
+  ImageIndex index(dir.string());
+  ImageMetadata metadata;
+  CHECK(index.getMetadata("image_1.png", metadata));
+  CHECK(metadata.has_text);
+  CHECK(!index.getMetadata("blobs/2a/2a.png", metadata));
+  CHECK(index.list().size() == 1);
+  fs::remove_all(dir);
+}
+
+void testMigration() {
+  auto dir = makeTempDir("image_index_migration");
+  std::ofstream(dir / "index") << "+ 2a 64 32 ff image_1.png\n"
+                                  "+ 3b 10 20 0f image 2.png\n"
+                                  "+ 4c 10 20 0f image_3.png\n"
+                                  "- image_3.png\n"
+                                  "+ broken\n";
+  std::ofstream(dir / "image_4.png") << "png";
+  std::ofstream(dir / "image_4.info") << "width: 640\nheight: 480\n";
+  // The image file of this one has been deleted.
+  std::ofstream(dir / "image_5.info") << "width: 1\nheight: 1\n";
+  {
+    ImageIndex index(dir.string());
+    CHECK(index.list().size() == 3);
+    CHECK(index.find(0x2a, 64, 32) == "image_1.png");
+    CHECK(index.find(0x3b, 10, 20) == "image 2.png");
+    CHECK(index.findSimilar(0x0e, 10, 20, 1) == "image 2.png");
+    CHECK(!index.contains("image_3.png"));
+    ImageMetadata metadata;
+    CHECK(index.getMetadata("image_4.png", metadata));
+    CHECK(metadata.width == 640 && metadata.height == 480);
+    CHECK(metadata.size_in_bytes == 3);
+    CHECK(!metadata.hashed);
+    // The images without a pixel hash are not found by the hash lookups.
+    CHECK(!index.contains("image_4.png"));
+    CHECK(!index.getMetadata("image_5.png", metadata));
+  }
+  CHECK(!fs::exists(dir / "index"));
+  CHECK(!fs::exists(dir / "image_4.info"));
+  CHECK(!fs::exists(dir / "image_5.info"));
+  CHECK(fs::exists(dir / "image_4.png"));
+  // The migrated table is read back without the legacy files.
+  ImageIndex index(dir.string());
+  CHECK(index.list().size() == 3);
+  CHECK(index.find(0x2a, 64, 32) == "image_1.png");
+  fs::remove_all(dir);
+}
+
+void testTornRecord() {
+  auto dir = makeTempDir("image_index_torn");
+  auto index_path = dir / "index.bin";
+  {
+    ImageIndex index(dir.string());
+    for (uint64_t i = 1; i <= 3; ++i) {
+      CHECK(index.add(makeImage("image_" + std::to_string(i) + ".png", i)));
+    }
+  }
+  auto size = fs::file_size(index_path);
+  // Cut the last 256-byte record in the middle.
+  fs::resize_file(index_path, size - 100);
+  {
+    ImageIndex index(dir.string());
+    CHECK(index.list().size() == 2);
+    CHECK(index.find(2, 64, 32) == "image_2.png");
+    CHECK(index.find(3, 64, 32).empty());
+    CHECK(fs::file_size(index_path) == size - 256);
+    // The next record is appended after the complete ones.
+    CHECK(index.add(makeImage("image_4.png", 4)));
+  }
+  ImageIndex index(dir.string());
+  CHECK(index.list().size() == 3);
+  CHECK(index.find(4, 64, 32) == "image_4.png");
+
+  // The file with a broken header is dropped.
+  fs::resize_file(index_path, 8);
+  ImageIndex broken_index(dir.string());
+  CHECK(broken_index.list().empty());
+  fs::remove_all(dir);
+}
+
+void testCompaction() {
+  auto dir = makeTempDir("image_index_compaction");
+  auto index_path = dir / "index.bin";
+  {
+    ImageIndex index(dir.string());
+    for (uint64_t i = 1; i <= 100; ++i) {
+      CHECK(index.add(makeImage("image_" + std::to_string(i) + ".png", i)));
+    }
+    for (uint64_t i = 1; i <= 90; ++i) {
+      index.remove("image_" + std::to_string(i) + ".png");
+    }
+    auto image = makeImage("image_100.png", 100);
+    image.optimized = true;
+    image.saved_bytes = 1234;
+    CHECK(index.update(image));
+  }
+  // Most of the records are obsolete, so the table is rewritten on load.
+  auto size = fs::file_size(index_path);
+  {
+    ImageIndex index(dir.string());
+    CHECK(index.list().size() == 10);
+    CHECK(fs::file_size(index_path) < size);
+    CHECK(!fs::exists(dir / "index.bin.tmp"));
+    CHECK(index.add(makeImage("image_101.png", 101)));
+  }
+  ImageIndex index(dir.string());
+  CHECK(index.list().size() == 11);
+  CHECK(index.find(1, 64, 32).empty());
+  CHECK(index.find(95, 64, 32) == "image_95.png");
+  CHECK(index.find(101, 64, 32) == "image_101.png");
+  ImageMetadata metadata;
+  CHECK(index.getMetadata("image_100.png", metadata));
+  CHECK(metadata.optimized && metadata.saved_bytes == 1234);
+  fs::remove_all(dir);
+}
+
+}  // namespace
+
+int main() {
+  testSameHash();
+  testMigration();
+  testTornRecord();
+  testCompaction();
+  return 0;
+}
@@ -0,0 +1,34 @@
+#include "mime_types.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+
+// Compares the perfect hash table with the std::map it replaced.
+int main() {
+  std::map<std::string, std::string> map;
+  forEachMimeType([&map](std::string_view extension, std::string_view mime_type) {
+    map.emplace(extension, mime_type);
+  });
+  // The extensions of the files served by the app, a few unknown ones
+  // included.
+  std::vector<std::string> extensions = {"html", "js", "css", "png", "svg", "woff2",
+                                         "json", "ico", "jpg", "map", "foo", "txt"};
+  std::size_t index = 0;
+
+  runBenchmark("std::map::find", 10'000'000, [&]() {
+    auto it = map.find(extensions[index++ % extensions.size()]);
+    doNotOptimize(it);
+  });
+  runBenchmark("std::map::operator[]", 10'000'000, [&]() {
+    auto &mime_type = map[extensions[index++ % extensions.size()]];
+    doNotOptimize(mime_type);
+  });
+  runBenchmark("getMimeType", 10'000'000, [&]() {
+    auto mime_type = getMimeType(extensions[index++ % extensions.size()]);
+    doNotOptimize(mime_type);
+  });
+  return 0;
+}
@@ -0,0 +1,30 @@
+#include "mime_types.h"
+
+#include <set>
+#include <string>
+
+#include "test.h"
+
+int main() {
+  std::set<std::string> extensions;
+  forEachMimeType([&extensions](std::string_view extension, std::string_view mime_type) {
+    CHECK(extensions.insert(std::string(extension)).second);
+    CHECK(getMimeType(extension) == mime_type);
+  });
+  // The number of the entries of the original std::map.
+  CHECK(extensions.size() == 982);
+
+  CHECK(getMimeType("html") == "text/html");
+  CHECK(getMimeType("png") == "image/png");
+  CHECK(getMimeType("docx") == "application/vnd.openxmlformats-officedocument.wordprocessingml.document");
+  CHECK(getMimeType("pptx") == "application/vnd.openxmlformats-officedocument.presentationml.presentation");
+  CHECK(getMimeType("xltx") == "application/vnd.openxmlformats-officedocument.spreadsheetml.template");
+
+  // The lookup is case-sensitive and the extension has no leading dot.
+  CHECK(getMimeType("").empty());
+  CHECK(getMimeType("PNG").empty());
+  CHECK(getMimeType(".png").empty());
+  CHECK(getMimeType("pngx").empty());
+  CHECK(getMimeType("unknown").empty());
+  return 0;
+}
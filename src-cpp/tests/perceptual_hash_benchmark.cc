@@ -0,0 +1,62 @@
+#include "perceptual_hash.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+
+// Measures the lookups of the similar images in a history of 30000 images
+// compared with the scan of all the hashes.
+int main() {
+  std::mt19937_64 random(42);
+  std::vector<uint64_t> hashes;
+  for (int i = 0; i < 30'000; ++i) {
+    hashes.push_back(random());
+  }
+  HammingTree tree;
+  for (std::size_t i = 0; i < hashes.size(); ++i) {
+    tree.insert(hashes[i], std::to_string(i));
+  }
+
+  // The queries are the stored hashes with a few changed bits.
+  std::vector<uint64_t> queries;
+  for (int i = 0; i < 1000; ++i) {
+    auto query = hashes[random() % hashes.size()];
+    for (int j = 0; j < 4; ++j) {
+      query ^= uint64_t{1} << (random() % 64);
+    }
+    queries.push_back(query);
+  }
+
+  std::size_t index = 0;
+  runBenchmark("HammingTree::findClosest(5)", 20'000, [&]() {
+    auto value = tree.findClosest(queries[index++ % queries.size()], 5);
+    doNotOptimize(value);
+  });
+  runBenchmark("HammingTree::findClosest(10)", 2'000, [&]() {
+    auto value = tree.findClosest(queries[index++ % queries.size()], 10);
+    doNotOptimize(value);
+  });
+  runBenchmark("scan of 30000 hashes", 20'000, [&]() {
+    auto query = queries[index++ % queries.size()];
+    int closest_distance = 6;
+    std::size_t closest = hashes.size();
+    for (std::size_t i = 0; i < hashes.size(); ++i) {
+      int distance = hammingDistance(hashes[i], query);
+      if (distance < closest_distance) {
+        closest_distance = distance;
+        closest = i;
+      }
+    }
+    doNotOptimize(closest);
+  });
+  runBenchmark("HammingTree of 30000 hashes", 20, [&]() {
+    HammingTree new_tree;
+    for (std::size_t i = 0; i < hashes.size(); ++i) {
+      new_tree.insert(hashes[i], std::to_string(i));
+    }
+    doNotOptimize(new_tree);
+  });
+  return 0;
+}
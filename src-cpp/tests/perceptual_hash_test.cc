@@ -0,0 +1,149 @@
+#include "perceptual_hash.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+namespace {
+
+// Returns the hash with the given number of random bits flipped.
+uint64_t flipBits(uint64_t hash, int count, std::mt19937_64 &random) {
+  for (int i = 0; i < count; ++i) {
+    hash ^= uint64_t{1} << (random() % 64);
+  }
+  return hash;
+}
+
+void testFindClosest() {
+  std::mt19937_64 random(42);
+  HammingTree tree;
+  std::vector<uint64_t> hashes;
+  // Clusters of similar hashes, so that the queries have many candidates.
+  for (int i = 0; i < 3000; ++i) {
+    auto hash = i % 4 == 0 || hashes.empty() ? random() : flipBits(hashes.back(), 3, random);
+    tree.insert(hash, std::to_string(i));
+    hashes.push_back(hash);
+  }
+  CHECK(tree.size() == hashes.size());
+
+  for (int i = 0; i < 2000; ++i) {
+    auto query = i % 2 == 0 ? flipBits(hashes[random() % hashes.size()], i % 12, random) : random();
+    int max_distance = i % 16;
+    int expected_distance = max_distance + 1;
+    for (auto hash : hashes) {
+      expected_distance = std::min(expected_distance, hammingDistance(hash, query));
+    }
+    auto value = tree.findClosest(query, max_distance);
+    if (expected_distance > max_distance) {
+      CHECK(value.empty());
+    } else {
+      // Any of the values at the same distance can be found.
+      CHECK(!value.empty());
+      CHECK(hammingDistance(hashes[std::stoul(value)], query) == expected_distance);
+    }
+  }
+  CHECK(HammingTree().findClosest(0, 64).empty());
+  CHECK(tree.findClosest(hashes[0], -1).empty());
+}
+
+void testRemove() {
+  std::mt19937_64 random(7);
+  HammingTree tree;
+  std::vector<uint64_t> hashes;
+  for (int i = 0; i < 300; ++i) {
+    hashes.push_back(random());
+    tree.insert(hashes.back(), std::to_string(i));
+  }
+  // The removed values are only marked, but they are not found anymore.
+  for (int i = 0; i < 10; ++i) {
+    tree.remove(std::to_string(i));
+    CHECK(tree.findClosest(hashes[i], 0).empty());
+  }
+  tree.remove("unknown");
+  CHECK(tree.size() == 290);
+
+  // The value inserted again replaces its old hash.
+  tree.insert(~hashes[10], "10");
+  CHECK(tree.findClosest(hashes[10], 0).empty());
+  CHECK(tree.findClosest(~hashes[10], 0) == "10");
+  CHECK(tree.size() == 290);
+
+  // Removing most of the values rebuilds the tree with the live ones.
+  for (int i = 11; i < 250; ++i) {
+    tree.remove(std::to_string(i));
+  }
+  CHECK(tree.size() == 51);
+  CHECK(tree.findClosest(~hashes[10], 0) == "10");
+  for (int i = 0; i < 300; ++i) {
+    auto value = tree.findClosest(hashes[i], 0);
+    if (i < 250) {
+      CHECK(value.empty());
+    } else {
+      CHECK(value == std::to_string(i));
+    }
+  }
+  tree.insert(hashes[0], "0");
+  CHECK(tree.findClosest(hashes[0], 0) == "0");
+  CHECK(tree.size() == 52);
+}
+
+void testDifferenceHash() {
+  const int width = 97;
+  const int height = 61;
+  const std::size_t bytes_per_row = 100;
+  std::mt19937 random(1);
+  std::vector<uint8_t> pixels(bytes_per_row * height);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      pixels[y * bytes_per_row + x] = static_cast<uint8_t>(random() % 256);
+    }
+  }
+  auto hash = computeDifferenceHash(pixels.data(), width, height, bytes_per_row);
+
+  // The padding at the end of the rows is not a part of the image.
+  auto padded = pixels;
+  for (int y = 0; y < height; ++y) {
+    padded[y * bytes_per_row + width] = 255;
+  }
+  CHECK(computeDifferenceHash(padded.data(), width, height, bytes_per_row) == hash);
+
+  // A pixel changes the average of one cell, so at most the bits comparing
+  // the cell with its left and right neighbours.
+  for (int i = 0; i < 100; ++i) {
+    auto changed = pixels;
+    auto &pixel = changed[(random() % height) * bytes_per_row + random() % width];
+    pixel = pixel < 128 ? 255 : 0;
+    CHECK(hammingDistance(computeDifferenceHash(changed.data(), width, height, bytes_per_row), hash) <= 2);
+  }
+
+  // The gradient getting darker to the right has all the bits set and
+  // the mirrored one has none of them.
+  std::vector<uint8_t> gradient(width * height);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      gradient[y * width + x] = static_cast<uint8_t>(255 - x * 2);
+    }
+  }
+  CHECK(computeDifferenceHash(gradient.data(), width, height, width) == ~uint64_t{0});
+  for (auto &pixel : gradient) {
+    pixel = static_cast<uint8_t>(255 - pixel);
+  }
+  CHECK(computeDifferenceHash(gradient.data(), width, height, width) == 0);
+
+  // The images smaller than the grid.
+  uint8_t pixel = 200;
+  CHECK(computeDifferenceHash(&pixel, 1, 1, 1) == 0);
+  CHECK(computeDifferenceHash(nullptr, 1, 1, 1) == 0);
+}
+
+}  // namespace
+
+int main() {
+  testFindClosest();
+  testRemove();
+  testDifferenceHash();
+  return 0;
+}
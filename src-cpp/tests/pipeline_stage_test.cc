@@ -0,0 +1,74 @@
+#include "pipeline_stage.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "test.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Posts the tasks behind a slow one and destroys the stage while they wait.
+int runQueuedTasks(bool drain) {
+  std::atomic<int> done = 0;
+  {
+    PipelineStage stage("test", 8, drain);
+    stage.post([]() {
+      std::this_thread::sleep_for(50ms);
+    });
+    for (int i = 0; i < 5; ++i) {
+      stage.post([&done]() {
+        done++;
+      });
+    }
+  }
+  return done;
+}
+
+void testOrder() {
+  std::vector<int> order;
+  {
+    PipelineStage stage("test", 2, true);
+    for (int i = 0; i < 100; ++i) {
+      stage.post([&order, i]() {
+        order.push_back(i);
+      });
+    }
+  }
+  CHECK(order.size() == 100);
+  for (int i = 0; i < 100; ++i) {
+    CHECK(order[i] == i);
+  }
+}
+
+void testChainedStages() {
+  // The stages are destroyed in order, so the tasks drained from the first
+  // stage are posted to the second one and drained too.
+  std::atomic<int> done = 0;
+  auto first = std::make_unique<PipelineStage>("first", 4, true);
+  auto second = std::make_unique<PipelineStage>("second", 4, true);
+  for (int i = 0; i < 10; ++i) {
+    first->post([&second, &done]() {
+      std::this_thread::sleep_for(1ms);
+      second->post([&done]() {
+        done++;
+      });
+    });
+  }
+  first.reset();
+  second.reset();
+  CHECK(done == 10);
+}
+
+}  // namespace
+
+int main() {
+  CHECK(runQueuedTasks(true) == 5);
+  CHECK(runQueuedTasks(false) == 0);
+  testOrder();
+  testChainedStages();
+  return 0;
+}
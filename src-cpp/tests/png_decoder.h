@@ -0,0 +1,115 @@
+#ifndef CLIPBOOK_TESTS_PNG_DECODER_H_
+#define CLIPBOOK_TESTS_PNG_DECODER_H_
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// A decoded non-interlaced PNG image, independent of the encoder under test.
+struct DecodedPng {
+  int width = 0;
+  int height = 0;
+  int bit_depth = 0;
+  int color_type = 0;
+  std::size_t row_size = 0;
+  // The unfiltered rows without the filter type bytes.
+  std::vector<uint8_t> rows;
+  // The chunks other than IHDR, IDAT and IEND in the file order.
+  std::vector<std::pair<std::string, std::string>> chunks;
+};
+
+inline uint32_t readPngUint32(const char *data) {
+  auto bytes = reinterpret_cast<const uint8_t *>(data);
+  return (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) | (uint32_t(bytes[2]) << 8) | bytes[3];
+}
+
+inline bool decodePng(std::string_view png, DecodedPng &image) {
+  if (!png.starts_with(std::string_view("\x89PNG\r\n\x1a\n", 8))) {
+    return false;
+  }
+  std::string compressed;
+  int channels = 0;
+  std::size_t pos = 8;
+  while (pos + 12 <= png.size()) {
+    auto length = readPngUint32(png.data() + pos);
+    if (length > png.size() - pos - 12) {
+      return false;
+    }
+    std::string type(png.substr(pos + 4, 4));
+    std::string data(png.substr(pos + 8, length));
+    auto crc = crc32(0, reinterpret_cast<const Bytef *>(png.data() + pos + 4), length + 4);
+    if (crc != readPngUint32(png.data() + pos + 8 + length)) {
+      return false;
+    }
+    pos += 12 + length;
+    if (type == "IHDR") {
+      image.width = static_cast<int>(readPngUint32(data.data()));
+      image.height = static_cast<int>(readPngUint32(data.data() + 4));
+      image.bit_depth = static_cast<uint8_t>(data[8]);
+      image.color_type = static_cast<uint8_t>(data[9]);
+      channels = image.color_type == 6 ? 4 : image.color_type == 2 ? 3 : image.color_type == 4 ? 2 : 1;
+    } else if (type == "IDAT") {
+      compressed += data;
+    } else if (type == "IEND") {
+      break;
+    } else {
+      image.chunks.emplace_back(type, data);
+    }
+  }
+  if (channels == 0) {
+    return false;
+  }
+  image.row_size = (static_cast<std::size_t>(image.width) * channels * image.bit_depth + 7) / 8;
+  std::size_t bpp = std::max<std::size_t>(1, channels * image.bit_depth / 8);
+  std::vector<uint8_t> data((image.row_size + 1) * image.height);
+  auto size = static_cast<uLongf>(data.size());
+  if (uncompress(data.data(), &size, reinterpret_cast<const Bytef *>(compressed.data()),
+                 static_cast<uLong>(compressed.size())) != Z_OK || size != data.size()) {
+    return false;
+  }
+  image.rows.assign(image.row_size * image.height, 0);
+  for (int y = 0; y < image.height; ++y) {
+    const uint8_t *source = data.data() + y * (image.row_size + 1);
+    uint8_t *row = image.rows.data() + y * image.row_size;
+    const uint8_t *up = y > 0 ? row - image.row_size : nullptr;
+    for (std::size_t x = 0; x < image.row_size; ++x) {
+      int a = x >= bpp ? row[x - bpp] : 0;
+      int b = up ? up[x] : 0;
+      int c = up && x >= bpp ? up[x - bpp] : 0;
+      int predictor = 0;
+      switch (source[0]) {
+        case 0:
+          break;
+        case 1:
+          predictor = a;
+          break;
+        case 2:
+          predictor = b;
+          break;
+        case 3:
+          predictor = (a + b) / 2;
+          break;
+        case 4: {
+          int p = a + b - c;
+          int pa = std::abs(p - a);
+          int pb = std::abs(p - b);
+          int pc = std::abs(p - c);
+          predictor = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+          break;
+        }
+        default:
+          return false;
+      }
+      row[x] = static_cast<uint8_t>(source[1 + x] + predictor);
+    }
+  }
+  return true;
+}
+
+#endif  // CLIPBOOK_TESTS_PNG_DECODER_H_
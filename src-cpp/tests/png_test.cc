@@ -0,0 +1,130 @@
+#include "png.h"
+
+#include <zlib.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "png_decoder.h"
+#include "test.h"
+
+namespace {
+
+// Encodes the rows without filtering or compression, as a PNG that the
+// optimization is expected to make smaller.
+std::string encodeStoredPng(int width, int height, int color_type, const std::vector<uint8_t> &rows,
+                            const std::vector<std::pair<std::string, std::string>> &chunks) {
+  int channels = color_type == 6 ? 4 : 3;
+  std::size_t row_size = static_cast<std::size_t>(width) * channels;
+  std::vector<uint8_t> data;
+  for (int y = 0; y < height; ++y) {
+    data.push_back(0);
+    data.insert(data.end(), rows.begin() + y * row_size, rows.begin() + (y + 1) * row_size);
+  }
+  std::vector<uint8_t> compressed(compressBound(data.size()));
+  auto compressed_size = static_cast<uLongf>(compressed.size());
+  CHECK(compress2(compressed.data(), &compressed_size, data.data(), data.size(), Z_NO_COMPRESSION) == Z_OK);
+
+  std::string png("\x89PNG\r\n\x1a\n", 8);
+  uint8_t header[13] = {};
+  header[0] = static_cast<uint8_t>(width >> 24);
+  header[1] = static_cast<uint8_t>(width >> 16);
+  header[2] = static_cast<uint8_t>(width >> 8);
+  header[3] = static_cast<uint8_t>(width);
+  header[4] = static_cast<uint8_t>(height >> 24);
+  header[5] = static_cast<uint8_t>(height >> 16);
+  header[6] = static_cast<uint8_t>(height >> 8);
+  header[7] = static_cast<uint8_t>(height);
+  header[8] = 8;
+  header[9] = static_cast<uint8_t>(color_type);
+  appendPngChunk(png, "IHDR", header, sizeof(header));
+  for (const auto &[type, chunk] : chunks) {
+    appendPngChunk(png, type.c_str(), chunk.data(), chunk.size());
+  }
+  // The image data is split into several chunks, like some encoders do.
+  std::size_t half = compressed_size / 2;
+  appendPngChunk(png, "IDAT", compressed.data(), half);
+  appendPngChunk(png, "IDAT", compressed.data() + half, compressed_size - half);
+  appendPngChunk(png, "tEXt", "Comment\0after", 13);
+  appendPngChunk(png, "IEND", nullptr, 0);
+  return png;
+}
+
+// A gradient with noise in some areas, so all the filters are useful.
+std::vector<uint8_t> makePixels(int width, int height, int channels) {
+  std::mt19937 random(42);
+  std::vector<uint8_t> pixels(static_cast<std::size_t>(width) * height * channels);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      for (int c = 0; c < channels; ++c) {
+        auto value = (x * 3 + y * 5 + c * 40) & 0xff;
+        if (y > height / 2 && x < width / 3) {
+          value = random() & 0xff;
+        }
+        pixels[(static_cast<std::size_t>(y) * width + x) * channels + c] = static_cast<uint8_t>(value);
+      }
+    }
+  }
+  return pixels;
+}
+
+void testOptimizePng(int width, int height, int color_type) {
+  int channels = color_type == 6 ? 4 : 3;
+  auto pixels = makePixels(width, height, channels);
+  std::vector<std::pair<std::string, std::string>> chunks = {
+      {"gAMA", std::string("\x00\x00\xb1\x8f", 4)},
+      {"tEXt", std::string("Title\0Clip", 10)},
+      // A private chunk that is safe to copy and one that is not.
+      {"prVt", "kept"},
+      {"iDOT", "dropped"},
+  };
+  auto png = encodeStoredPng(width, height, color_type, pixels, chunks);
+
+  std::string optimized;
+  CHECK(optimizePng(png, optimized));
+  CHECK(optimized.size() < png.size());
+
+  DecodedPng original_image;
+  DecodedPng optimized_image;
+  CHECK(decodePng(png, original_image));
+  CHECK(decodePng(optimized, optimized_image));
+  CHECK(original_image.rows == pixels);
+  CHECK(optimized_image.width == width && optimized_image.height == height);
+  CHECK(optimized_image.color_type == color_type && optimized_image.bit_depth == 8);
+  CHECK(optimized_image.rows == original_image.rows);
+
+  // The chunks are kept in place, except the one that refers to the old
+  // image data.
+  auto expected_chunks = original_image.chunks;
+  std::erase_if(expected_chunks, [](const auto &chunk) {
+    return chunk.first == "iDOT";
+  });
+  CHECK(expected_chunks.size() == 4);
+  CHECK(optimized_image.chunks == expected_chunks);
+
+  // The optimized image cannot be made smaller again.
+  std::string result;
+  CHECK(!optimizePng(optimized, result));
+}
+
+void testInvalidPng() {
+  auto png = encodeStoredPng(4, 4, 6, makePixels(4, 4, 4), {});
+  std::string result;
+  CHECK(!optimizePng("", result));
+  CHECK(!optimizePng(png.substr(0, png.size() / 2), result));
+  auto corrupted = png;
+  corrupted[40] ^= 1;
+  CHECK(!optimizePng(corrupted, result));
+}
+
+}  // namespace
+
+int main() {
+  testOptimizePng(97, 61, 6);
+  testOptimizePng(1, 1, 2);
+  testOptimizePng(300, 7, 2);
+  testInvalidPng();
+  return 0;
+}
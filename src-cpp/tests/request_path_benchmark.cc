@@ -0,0 +1,73 @@
+#include "request_path.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "url.h"
+
+namespace fs = std::filesystem;
+
+// The route matching and the path building the interceptor used before:
+// a linear scan with endsWith() over the whole URL and fs::path appends.
+const std::vector<std::string> kOldRoutingPages = {
+    "/welcome", "/accessibility", "/enjoy", "/settings", "/settings/history", "/settings/shortcuts",
+    "/settings/privacy", "/settings/license", "/settings/tags", "/settings/about", "/settings/storage"
+};
+
+bool endsWith(const std::string &str, const std::string &ending) {
+  return str.length() >= ending.length() &&
+         str.compare(str.length() - ending.length(), ending.length(), ending) == 0;
+}
+
+bool oldIsRoutingPage(const std::string &url) {
+  return std::ranges::any_of(kOldRoutingPages, [&url](const std::string &page) {
+    return endsWith(url, page);
+  });
+}
+
+// A mix of the requests made while the history window renders: the bundle,
+// the thumbnails and images, and the settings routes.
+const std::vector<std::string> kUrls = {
+    "clipbook://app/",
+    "clipbook://app/assets/index-4f2a9c1b.js",
+    "clipbook://app/assets/index-0b7de2aa.css",
+    "clipbook://app/assets/Inter-Regular.woff2",
+    "clipbook://images/blobs/3f/3fa1c07e9b2d4e15_thumb.png",
+    "clipbook://images/blobs/a0/a07e9b2d4e153fa1.png?w=512",
+    "clipbook://images/image_1700000000.png",
+    "clipbook://images/image_1700000000_thumb.png",
+    "clipbook://images/blobs/7c/7c12e9b2d4e15a0f_thumb.png",
+    "clipbook://images/blobs/19/19a07e9b2d4e153f_thumb.png",
+    "clipbook://app/settings/history",
+    "clipbook://app/settings/shortcuts",
+};
+
+int main() {
+  std::size_t index = 0;
+  std::string file_path;
+
+  runBenchmark("endsWith scan + fs::path", 2'000'000, [&]() {
+    const auto &url_string = kUrls[index++ % kUrls.size()];
+    URL url(url_string);
+    fs::path path = "/Applications/ClipBook.app/Contents/Resources/app";
+    if (oldIsRoutingPage(url_string)) {
+      path.append("index.html");
+    } else {
+      for (auto item : url.pathItems()) {
+        path.append(item);
+      }
+    }
+    doNotOptimize(path);
+  });
+  runBenchmark("isRoutingPage + resolvePath", 2'000'000, [&]() {
+    URL url(kUrls[index++ % kUrls.size()]);
+    if (!isRoutingPage(url.path())) {
+      resolvePath("/Applications/ClipBook.app/Contents/Resources/app", url.path(), file_path);
+    }
+    doNotOptimize(file_path);
+  });
+  return 0;
+}
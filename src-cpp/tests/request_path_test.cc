@@ -0,0 +1,33 @@
+#include "request_path.h"
+
+#include "test.h"
+
+int main() {
+  CHECK(isRoutingPage("settings"));
+  CHECK(isRoutingPage("settings/history"));
+  CHECK(isRoutingPage("settings/history/"));
+  CHECK(isRoutingPage("welcome"));
+  CHECK(!isRoutingPage(""));
+  CHECK(!isRoutingPage("index.html"));
+  CHECK(!isRoutingPage("assets/settings"));
+  CHECK(!isRoutingPage("settings/unknown"));
+
+  std::string path;
+  CHECK(resolvePath("/res", "assets/index.js", path));
+  CHECK(path == "/res/assets/index.js");
+  CHECK(resolvePath("/res", "", path));
+  CHECK(path == "/res");
+  CHECK(resolvePath("/res", "a//./b/", path));
+  CHECK(path == "/res/a/b");
+  CHECK(resolvePath("/res", "a/...", path));
+  CHECK(path == "/res/a/...");
+
+  // The traversal segments, including the percent-encoded ones.
+  CHECK(!resolvePath("/res", "..", path));
+  CHECK(!resolvePath("/res", "a/../../etc/passwd", path));
+  CHECK(!resolvePath("/res", "%2e%2e/etc", path));
+  CHECK(!resolvePath("/res", ".%2E/etc", path));
+  CHECK(!resolvePath("/res", "a\\..\\b", path));
+  CHECK(!resolvePath("/res", std::string_view("a\0b", 3), path));
+  return 0;
+}
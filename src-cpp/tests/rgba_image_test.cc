@@ -0,0 +1,170 @@
+#include "rgba_image.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "png.h"
+#include "png_decoder.h"
+#include "test.h"
+
+namespace {
+
+RgbaImage makeRandomImage(int width, int height, std::mt19937 &random) {
+  RgbaImage image;
+  image.width = width;
+  image.height = height;
+  image.pixels.resize(static_cast<std::size_t>(width) * height * 4);
+  for (auto &value : image.pixels) {
+    value = static_cast<uint8_t>(random() % 256);
+  }
+  return image;
+}
+
+// The plain box filter averaging the source pixels covered by every target
+// pixel, independent of the vectorized row accumulation.
+std::vector<uint8_t> resizeScalar(const RgbaImage &image, int width, int height) {
+  std::vector<uint8_t> pixels(static_cast<std::size_t>(width) * height * 4);
+  for (int ty = 0; ty < height; ++ty) {
+    int y0 = ty * image.height / height;
+    int y1 = std::max((ty + 1) * image.height / height, y0 + 1);
+    for (int tx = 0; tx < width; ++tx) {
+      int x0 = tx * image.width / width;
+      int x1 = (tx + 1) * image.width / width;
+      for (int c = 0; c < 4; ++c) {
+        uint32_t sum = 0;
+        for (int y = y0; y < y1; ++y) {
+          for (int x = x0; x < x1; ++x) {
+            sum += image.pixels[(static_cast<std::size_t>(y) * image.width + x) * 4 + c];
+          }
+        }
+        auto area = static_cast<uint32_t>((y1 - y0) * (x1 - x0));
+        pixels[(static_cast<std::size_t>(ty) * width + tx) * 4 + c] = static_cast<uint8_t>((sum + area / 2) / area);
+      }
+    }
+  }
+  return pixels;
+}
+
+void testResize() {
+  std::mt19937 random(3);
+  // The odd widths leave a single pixel after the pairs accumulated at once.
+  const int sizes[][4] = {
+      {37, 23, 10, 10}, {101, 7, 33, 33}, {3, 99, 2, 50}, {255, 255, 17, 17},
+      {1001, 3, 97, 97}, {9, 9, 4, 4}, {640, 480, 123, 91},
+  };
+  for (const auto &size : sizes) {
+    auto image = makeRandomImage(size[0], size[1], random);
+    auto result = resizeImage(image, size[2], size[3]);
+    CHECK(result.width <= size[2] && result.height <= size[3]);
+    CHECK(result.width == size[2] || result.height == size[3]);
+    CHECK(result.pixels == resizeScalar(image, result.width, result.height));
+  }
+
+  // The image that already fits is returned as is.
+  auto image = makeRandomImage(31, 17, random);
+  image.premultiplied = true;
+  auto result = resizeImage(image, 31, 100);
+  CHECK(result.width == 31 && result.height == 17);
+  CHECK(result.premultiplied);
+  CHECK(result.pixels == image.pixels);
+  CHECK(resizeImage(image, 0, 10).pixels == image.pixels);
+}
+
+void testExtremeAspectRatio() {
+  RgbaImage wide;
+  wide.width = 10'001;
+  wide.height = 2;
+  wide.pixels.resize(static_cast<std::size_t>(wide.width) * wide.height * 4);
+  for (std::size_t i = 0; i < wide.pixels.size(); i += 4) {
+    wide.pixels[i] = 10;
+    wide.pixels[i + 1] = 20;
+    wide.pixels[i + 2] = 30;
+    wide.pixels[i + 3] = 255;
+  }
+  auto result = resizeImage(wide, 100, 100);
+  CHECK(result.width == 100 && result.height == 1);
+  CHECK(result.pixels == resizeScalar(wide, 100, 1));
+  CHECK(result.pixels[0] == 10 && result.pixels[398] == 30 && result.pixels[399] == 255);
+
+  RgbaImage tall = wide;
+  tall.width = 2;
+  tall.height = 10'001;
+  result = resizeImage(tall, 100, 100);
+  CHECK(result.width == 1 && result.height == 100);
+  CHECK(result.pixels == resizeScalar(tall, 1, 100));
+
+  RgbaImage line = wide;
+  line.width = 20'002;
+  line.height = 1;
+  result = resizeImage(line, 3, 3);
+  CHECK(result.width == 3 && result.height == 1);
+}
+
+// Returns the straight alpha channels of the premultiplied pixel.
+void unpremultiply(const uint8_t *pixel, uint8_t *result) {
+  uint32_t alpha = pixel[3];
+  for (int c = 0; c < 3; ++c) {
+    result[c] = alpha == 0 ? 0 : static_cast<uint8_t>(std::min<uint32_t>(255, (pixel[c] * 255 + alpha / 2) / alpha));
+  }
+  result[3] = pixel[3];
+}
+
+void testPngRoundTrip() {
+  // A smooth premultiplied image with the transparent, translucent and
+  // opaque areas, which compresses better with the optimizer.
+  RgbaImage image;
+  image.width = 203;
+  image.height = 121;
+  image.premultiplied = true;
+  image.pixels.resize(static_cast<std::size_t>(image.width) * image.height * 4);
+  for (int y = 0; y < image.height; ++y) {
+    for (int x = 0; x < image.width; ++x) {
+      uint8_t *pixel = &image.pixels[(static_cast<std::size_t>(y) * image.width + x) * 4];
+      auto alpha = static_cast<uint8_t>(x < 20 ? 0 : x > 180 ? 255 : x);
+      pixel[0] = static_cast<uint8_t>(alpha * y / image.height);
+      pixel[1] = static_cast<uint8_t>(alpha / 2);
+      pixel[2] = static_cast<uint8_t>(alpha * (x % 7) / 7);
+      pixel[3] = alpha;
+    }
+  }
+  std::vector<uint8_t> expected(image.pixels.size());
+  for (std::size_t i = 0; i < image.pixels.size(); i += 4) {
+    unpremultiply(&image.pixels[i], &expected[i]);
+  }
+
+  std::string png;
+  CHECK(encodePng(image, png));
+  DecodedPng decoded;
+  CHECK(decodePng(png, decoded));
+  CHECK(decoded.width == image.width && decoded.height == image.height);
+  CHECK(decoded.bit_depth == 8 && decoded.color_type == 6);
+  CHECK(decoded.rows == expected);
+
+  std::string optimized;
+  CHECK(optimizePng(png, optimized));
+  CHECK(optimized.size() < png.size());
+  DecodedPng decoded_optimized;
+  CHECK(decodePng(optimized, decoded_optimized));
+  CHECK(decoded_optimized.width == image.width && decoded_optimized.height == image.height);
+  CHECK(decoded_optimized.color_type == 6);
+  CHECK(decoded_optimized.rows == expected);
+
+  // The straight alpha pixels are encoded as is.
+  image.premultiplied = false;
+  CHECK(encodePng(image, png));
+  DecodedPng straight;
+  CHECK(decodePng(png, straight));
+  CHECK(straight.rows == image.pixels);
+  CHECK(!encodePng(RgbaImage(), png));
+}
+
+}  // namespace
+
+int main() {
+  testResize();
+  testExtremeAspectRatio();
+  testPngRoundTrip();
+  return 0;
+}
@@ -0,0 +1,18 @@
+#ifndef CLIPBOOK_TESTS_TEST_H_
+#define CLIPBOOK_TESTS_TEST_H_
+
+#include <cstdio>
+#include <cstdlib>
+
+// Fails the test with the location of the failed condition. Unlike assert()
+// it's not disabled in the release builds.
+#define CHECK(condition)                                                   \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+                   #condition);                                            \
+      std::exit(1);                                                        \
+    }                                                                      \
+  } while (false)
+
+#endif  // CLIPBOOK_TESTS_TEST_H_
@@ -0,0 +1,60 @@
+#include "text_scanner.h"
+
+#include <string>
+
+#include "test.h"
+
+namespace {
+
+bool hasTextType(std::string_view text, TextSpanType expected) {
+  TextSpanType type;
+  return getTextType(text, type) && type == expected;
+}
+
+}  // namespace
+
+int main() {
+  auto spans = findTextSpans("See https://clipbook.app or mail hi@clipbook.app, #ff0000.");
+  CHECK(spans.size() == 3);
+  CHECK(spans[0].type == TextSpanType::kLink);
+  CHECK(spans[0].begin == 4 && spans[0].length == 20);
+  CHECK(spans[1].type == TextSpanType::kEmail);
+  CHECK(spans[1].begin == 33 && spans[1].length == 15);
+  CHECK(spans[2].type == TextSpanType::kColor);
+  CHECK(spans[2].begin == 50 && spans[2].length == 7);
+  CHECK(findTextSpans("").empty());
+  CHECK(findTextSpans("no matches here").empty());
+
+  // A match past the SIMD blocks of a long text.
+  std::string text(1000, 'a');
+  text += " rgb(1, 2, 3)";
+  spans = findTextSpans(text);
+  CHECK(spans.size() == 1);
+  CHECK(spans[0].type == TextSpanType::kColor);
+  CHECK(spans[0].begin == 1001 && spans[0].length == 12);
+
+  CHECK(hasTextType("https://clipbook.app/docs?q=1", TextSpanType::kLink));
+  CHECK(hasTextType("hi@clipbook.app", TextSpanType::kEmail));
+  CHECK(hasTextType("#abc", TextSpanType::kColor));
+  CHECK(hasTextType("rgba(0, 0, 0, 0.5)", TextSpanType::kColor));
+  TextSpanType type;
+  CHECK(!getTextType("", type));
+  CHECK(!getTextType("plain text", type));
+  CHECK(!getTextType("open https://clipbook.app", type));
+  CHECK(!getTextType("#abc #def", type));
+  CHECK(!getTextType("#abcde", type));
+  CHECK(!getTextType("https://clipbook.app https://clipbook.app", type));
+  CHECK(!getTextType("rgb(1, 2, 3) ", type));
+  CHECK(!getTextType(" hi@clipbook.app", type));
+
+  // The long texts that are not a single match.
+  std::string links;
+  for (int i = 0; i < 10'000; ++i) {
+    links += "https://clipbook.app/" + std::to_string(i) + " ";
+  }
+  CHECK(!getTextType(links, type));
+  std::string link = "https://clipbook.app/?q=" + std::string(100'000, 'a');
+  CHECK(hasTextType(link, TextSpanType::kLink));
+  CHECK(!getTextType(link + "\n", type));
+  return 0;
+}
@@ -0,0 +1,51 @@
+#include "utils.h"
+
+#include <string>
+
+#include "test.h"
+
+namespace {
+
+void testTruncateAscii() {
+  CHECK(truncateUtf8("hello", 10) == "hello");
+  CHECK(truncateUtf8("hello", 5) == "hello");
+  CHECK(truncateUtf8("hello", 3) == "hel");
+  CHECK(truncateUtf8("hello", 0).empty());
+  CHECK(truncateUtf8("", 0).empty());
+}
+
+// Cuts the text "a<character>b" at every byte of the character.
+void checkSplitCharacter(const std::string &character) {
+  auto text = "a" + character + "b";
+  for (std::size_t size = 1; size <= character.size(); ++size) {
+    CHECK(truncateUtf8(text, size) == "a");
+  }
+  CHECK(truncateUtf8(text, character.size() + 1) == "a" + character);
+  CHECK(truncateUtf8(text, text.size()) == text);
+  // The text starting with the character.
+  CHECK(truncateUtf8(character + character, character.size() + 1) == character);
+  CHECK(truncateUtf8(character, character.size() - 1).empty());
+}
+
+void testTruncateMultiByte() {
+  // "é", "€" and "😀".
+  checkSplitCharacter("\xC3\xA9");
+  checkSplitCharacter("\xE2\x82\xAC");
+  checkSplitCharacter("\xF0\x9F\x98\x80");
+
+  std::string text;
+  for (int i = 0; i < 1000; ++i) {
+    text += "\xE2\x82\xAC";
+  }
+  auto preview = truncateUtf8(text, 1000);
+  CHECK(preview.size() == 999);
+  CHECK(text.compare(0, preview.size(), preview) == 0);
+}
+
+}  // namespace
+
+int main() {
+  testTruncateAscii();
+  testTruncateMultiByte();
+  return 0;
+}
@@ -0,0 +1,96 @@
+#include "worker_pool.h"
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#include "test.h"
+
+using namespace std::chrono_literals;
+
+void testLatencyHistogram() {
+  LatencyHistogram histogram;
+  CHECK(histogram.percentile(50) == 0us);
+  for (int i = 0; i < 90; ++i) {
+    histogram.record(10us);
+  }
+  for (int i = 0; i < 10; ++i) {
+    histogram.record(1000us);
+  }
+  CHECK(histogram.count() == 100);
+  CHECK(histogram.total() == 10900us);
+  // The percentiles are the upper bounds of the power-of-two buckets.
+  CHECK(histogram.percentile(50) == 16us);
+  CHECK(histogram.percentile(95) == 1024us);
+  CHECK(histogram.percentile(99) == 1024us);
+}
+
+void testQueueDepth() {
+  WorkerPool pool(1, 2);
+  std::atomic<bool> blocked = true;
+  std::atomic<int> started = 0;
+  CHECK(pool.post([&]() {
+    started++;
+    while (blocked) {
+      std::this_thread::yield();
+    }
+  }));
+  while (started == 0) {
+    std::this_thread::yield();
+  }
+  // The thread is busy, so only the queue depth tasks can wait.
+  CHECK(pool.post([]() {}));
+  CHECK(pool.post([]() {}));
+  CHECK(!pool.post([]() {}));
+  blocked = false;
+}
+
+// Posts a burst of file reads much larger than the pool, so most of them
+// wait in the queue or are rejected, and checks the reported percentiles.
+void testBurstLatency() {
+  const int kRequestsCount = 256;
+  WorkerPool pool(4, 64);
+  std::atomic<int> completed = 0;
+  int posted = 0;
+  for (int i = 0; i < kRequestsCount; ++i) {
+    auto task = [&completed]() {
+      std::this_thread::sleep_for(200us);
+      completed++;
+    };
+    if (pool.post(task)) {
+      posted++;
+    } else {
+      // The interceptor serves the request on the calling thread then.
+      task();
+    }
+  }
+  while (completed < kRequestsCount) {
+    std::this_thread::sleep_for(1ms);
+  }
+  // The latency is recorded right after a task completes.
+  while (pool.latency().count() < static_cast<uint64_t>(posted)) {
+    std::this_thread::sleep_for(1ms);
+  }
+  auto &latency = pool.latency();
+  CHECK(posted >= 64);
+  CHECK(latency.count() == static_cast<uint64_t>(posted));
+  auto p50 = latency.percentile(50);
+  auto p95 = latency.percentile(95);
+  auto p99 = latency.percentile(99);
+  std::printf("burst of %d requests, %d queued: p50 %lld us, p95 %lld us, p99 %lld us\n", kRequestsCount, posted,
+              static_cast<long long>(p50.count()), static_cast<long long>(p95.count()),
+              static_cast<long long>(p99.count()));
+  // A task waits at least for its own run.
+  CHECK(p50 >= 128us);
+  CHECK(p50 <= p95);
+  CHECK(p95 <= p99);
+  // The last queued tasks wait for about 64 / 4 runs of the others.
+  CHECK(p99 >= 1024us);
+}
+
+int main() {
+  testLatencyHistogram();
+  testQueueDepth();
+  testBurstLatency();
+  return 0;
+}
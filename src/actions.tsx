@@ -90,6 +90,7 @@ export type Events = {
   UpdateLinkPreview: void;
   UpdateLanguage: void;
   RenameItemModeEnabled: boolean;
+  ThumbnailReady: string;
 };
 
 export const emitter: Emitter<Events> = mitt<Events>();
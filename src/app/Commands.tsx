@@ -78,7 +78,7 @@ import {
   getActiveHistoryItemIndex,
   getHistoryItem
 } from "@/data";
-import {ClipType, getHTML, getImageText, getRTF} from "@/db";
+import {ClipType, getImageText, hasHTML, hasRTF} from "@/db";
 import {HidePreviewPaneIcon, ShowPreviewPaneIcon} from "@/app/Icons";
 import {Tooltip, TooltipContent, TooltipTrigger} from "@/components/ui/tooltip";
 import {DialogTitle} from "@/components/ui/dialog";
@@ -403,7 +403,7 @@ export default function Commands(props: CommandsProps) {
       let index = getActiveHistoryItemIndex()
       let item = getHistoryItem(index)
       if (item && item.type === ClipType.Text) {
-        return getRTF(item).length > 0 || getHTML(item).length > 0
+        return hasRTF(item) || hasHTML(item)
       }
     }
     return false
@@ -32,7 +32,7 @@ import {
   prefGetToggleFavoriteShortcut,
 } from "@/pref";
 import {CommandShortcut} from "@/components/ui/command";
-import {Clip, ClipType, getHTML, getImageText, getRTF, updateClip} from "@/db";
+import {Clip, ClipType, getImageText, hasHTML, hasRTF, updateClip} from "@/db";
 import {
   AppInfo,
   fileExists,
@@ -327,7 +327,7 @@ const HistoryItemContextMenu = (props: HistoryItemContextMenuProps) => {
       return false
     }
     if (props.item.type === ClipType.Text) {
-      return getRTF(props.item).length > 0 || getHTML(props.item).length > 0
+      return hasRTF(props.item) || hasHTML(props.item)
     }
     return false
   }
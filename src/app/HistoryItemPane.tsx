@@ -46,6 +46,7 @@ const HistoryItemPane = (props: HistoryItemPaneProps) => {
   const [itemTags, setItemTags] = useState(getTags(props.item.tags))
   const [originalItemName, setOriginalItemName] = useState(props.item.name ? props.item.name : "")
   const [pasteOnClick, setPasteOnClick] = useState(prefShouldPasteOnClick())
+  const [thumbVersion, setThumbVersion] = useState(0)
 
   useEffect(() => {
     function handleUpdateItemByIdEvent(itemId?: number) {
@@ -72,6 +73,26 @@ const HistoryItemPane = (props: HistoryItemPaneProps) => {
     };
   }, [])
 
+  useEffect(() => {
+    // Thumbnails are generated in the background, reload the image when
+    // its file is written.
+    function handleThumbnailReadyEvent(fileName: string) {
+      if (fileName === props.item.imageThumbFileName || fileName === props.item.filePathThumbFileName) {
+        setThumbVersion(version => version + 1)
+      }
+    }
+
+    emitter.on("ThumbnailReady", handleThumbnailReadyEvent)
+    return () => {
+      emitter.off("ThumbnailReady", handleThumbnailReadyEvent)
+    };
+  }, [props.item])
+
+  function getThumbUrl(fileName: string) {
+    let url = "clipbook://images/" + fileName
+    return thumbVersion > 0 ? url + "?v=" + thumbVersion : url
+  }
+
   function isItemSelected() {
     return props.selectedItemIndices.includes(props.index)
   }
@@ -202,11 +223,11 @@ const HistoryItemPane = (props: HistoryItemPaneProps) => {
       return <MailIcon className="h-5 w-5 text-primary-foreground"/>
     }
     if (props.item.type === ClipType.File) {
-      return <img src={"clipbook://images/" + props.item.filePathThumbFileName}
+      return <img src={getThumbUrl(props.item.filePathThumbFileName)}
                   alt={props.item.filePathThumbFileName} className="h-5 w-5 object-contain"/>
     }
     if (props.item.type === ClipType.Image) {
-      return <img src={"clipbook://images/" + props.item.imageThumbFileName}
+      return <img src={getThumbUrl(props.item.imageThumbFileName)}
                   alt={props.item.imageThumbFileName} className="h-5 w-5 object-contain"/>
     }
     return <FileIcon className="h-5 w-5 text-primary-foreground"/>
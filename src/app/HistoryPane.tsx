@@ -11,6 +11,7 @@ import {
   AppInfo,
   clear,
   clearSelection,
+  deleteCapturedTexts,
   deleteHistoryItem,
   findItem,
   getDefaultApp,
@@ -52,7 +53,9 @@ import {
   setSelectionMode,
   getActiveHistoryItemIndex,
   setActiveHistoryItemIndex,
-  isSelectionModeEnabled
+  isSelectionModeEnabled,
+  setImageText,
+  setText
 } from "@/data";
 import {isQuickPasteShortcut, isShortcutMatch} from "@/lib/shortcuts";
 import {
@@ -111,6 +114,7 @@ import {
   getImageFileName,
   getImageText,
   getRTF,
+  getText,
 } from "@/db";
 import {formatText, getClipType, isUrl} from "@/lib/utils";
 import {ClipboardIcon} from "lucide-react";
@@ -144,14 +148,50 @@ declare const saveImageAsFile: (imageFilePath: string, imageWidth: number, image
 declare const hideAppWindow: () => void;
 declare const openInApp: (filePath: string, appPath: string) => void;
 declare const notifyAppReadyToQuit: () => void;
+declare const readClips: (afterSequence: number) => string;
+declare const acknowledgeClips: (sequence: number) => void;
 
 type HistoryPaneProps = {
   appName: string
   appIcon: string
 }
 
+// A clip captured by the app and written to the native clip log.
+type CapturedClip = {
+  merge: boolean
+  content: string
+  sourceAppPath: string
+  imageFileName: string
+  imageThumbFileName: string
+  imageWidth: number
+  imageHeight: number
+  imageSizeInBytes: number
+  imageText: string
+  filePath: string
+  filePathFileName: string
+  filePathThumbFileName: string
+  fileSizeInBytes: number
+  isFolder: boolean
+  rtf: string
+  html: string
+  rtfFileName: string
+  htmlFileName: string
+  textFileName: string
+  textType: string
+}
+
+// The text recognized in the image of a clip written to the clip log before.
+type CapturedImageText = {
+  update: "imageText"
+  fileName: string
+  text: string
+}
+
 let treatDigitNumbersAsColor = prefShouldTreatDigitNumbersAsColor()
 let renameItemMode = false
+// The sequence number of the last captured clip added to the history.
+let lastClipSequence = 0
+let addingCapturedClips = false
 
 export default function HistoryPane(props: HistoryPaneProps) {
   const { t } = useTranslation()
@@ -188,6 +228,8 @@ export default function HistoryPane(props: HistoryPaneProps) {
       resetFilter()
       setHistory(getHistoryItems())
       activateApp(true)
+      // Add the clips captured while the history was loading.
+      handleClipsAvailable()
     })
   }, []);
 
@@ -205,9 +247,14 @@ export default function HistoryPane(props: HistoryPaneProps) {
                                   fileSizeInBytes: number,
                                   isFolder: boolean,
                                   rtf: string,
-                                  html: string) {
-    let item = findItem(content, imageFileName, filePath)
+                                  html: string,
+                                  rtfFileName: string,
+                                  htmlFileName: string,
+                                  textFileName: string,
+                                  textType: string) {
+    let item = findItem(content, imageFileName, filePath, textFileName)
     if (item) {
+      deleteCapturedTexts(rtfFileName, htmlFileName, textFileName)
       item.numberOfCopies++
       item.lastTimeCopy = new Date()
       await trackSequence(item, false)
@@ -228,7 +275,11 @@ export default function HistoryPane(props: HistoryPaneProps) {
           fileSizeInBytes,
           isFolder,
           rtf,
-          html)
+          html,
+          rtfFileName,
+          htmlFileName,
+          textFileName,
+          textType)
     }
     setHistory([...getHistoryItems()])
 
@@ -308,9 +359,87 @@ export default function HistoryPane(props: HistoryPaneProps) {
         fileSizeInBytes,
         isFolder,
         "",
+        "",
+        "",
+        "",
+        "",
         "")
   }
 
+  async function addCapturedClip(clip: CapturedClip) {
+    if (clip.merge) {
+      await mergeClipboardData(clip.content,
+          clip.sourceAppPath,
+          clip.imageFileName,
+          clip.imageThumbFileName,
+          clip.imageWidth,
+          clip.imageHeight,
+          clip.imageSizeInBytes,
+          clip.imageText,
+          clip.filePath,
+          clip.filePathFileName,
+          clip.filePathThumbFileName,
+          clip.fileSizeInBytes,
+          clip.isFolder)
+      return
+    }
+    await addClipboardData(clip.content,
+        clip.sourceAppPath,
+        clip.imageFileName,
+        clip.imageThumbFileName,
+        clip.imageWidth,
+        clip.imageHeight,
+        clip.imageSizeInBytes,
+        clip.imageText,
+        clip.filePath,
+        clip.filePathFileName,
+        clip.filePathThumbFileName,
+        clip.fileSizeInBytes,
+        clip.isFolder,
+        clip.rtf,
+        clip.html,
+        clip.rtfFileName,
+        clip.htmlFileName,
+        clip.textFileName,
+        clip.textType)
+  }
+
+  async function addCapturedImageText(imageText: CapturedImageText) {
+    if (await setImageText(imageText.fileName, imageText.text)) {
+      setHistory([...getHistoryItems()])
+    }
+  }
+
+  // Adds the clips captured since the last added one to the history. The
+  // clips are read from the native clip log in batches and acknowledged once
+  // they are added, so the log can drop them.
+  async function handleClipsAvailable() {
+    if (addingCapturedClips) {
+      return
+    }
+    addingCapturedClips = true
+    try {
+      while (true) {
+        let entries: { sequence: number, clip: CapturedClip | CapturedImageText }[] =
+            JSON.parse(readClips(lastClipSequence))
+        if (entries.length === 0) {
+          break
+        }
+        for (const entry of entries) {
+          if ("update" in entry.clip) {
+            await addCapturedImageText(entry.clip)
+          } else {
+            await addCapturedClip(entry.clip)
+          }
+          lastClipSequence = entry.sequence
+        }
+        acknowledgeClips(lastClipSequence)
+      }
+    } finally {
+      addingCapturedClips = false
+    }
+  }
+
   async function clearHistory() {
     let keepFavorites = prefGetKeepFavoritesOnClearHistory()
     let items = await clear(keepFavorites)
@@ -991,7 +1120,7 @@ export default function HistoryPane(props: HistoryPaneProps) {
 
     let rtf = pasteObject ? getRTF(item) : ""
     let html = pasteObject ? getHTML(item) : ""
-    pasteItemInFrontApp(item.content, rtf, html, getImageFileName(item), getFilePath(item))
+    pasteItemInFrontApp(getText(item), rtf, html, getImageFileName(item), getFilePath(item))
 
     setHistory([...getHistoryItems()])
 
@@ -1138,10 +1267,15 @@ export default function HistoryPane(props: HistoryPaneProps) {
     }
     for (const item of items) {
       if (isTextItem(item)) {
+        // The transformed text is pasted, but the item keeps its original
+        // content and the stored large text.
         let originalContent = item.content
-        item.content = formatText(originalContent, operation)
+        let originalTextFileName = item.textFileName
+        item.content = formatText(getText(item), operation)
+        item.textFileName = undefined
         await pasteItem(item, false)
         item.content = originalContent
+        item.textFileName = originalTextFileName
         await updateHistoryItem(item.id!, item)
       }
     }
@@ -1190,10 +1324,10 @@ export default function HistoryPane(props: HistoryPaneProps) {
     let indices = getSelectedHistoryItemIndices()
     for (let index of indices) {
       let item = getHistoryItem(index)
-      content += item.content + "\n"
+      content += getText(item) + "\n"
     }
     await handleDeleteItems()
-    await addClipboardData(content, "ClipBook.app", "", "", 0, 0, 0, "", "", "", "", 0, false, "", "")
+    await addClipboardData(content, "ClipBook.app", "", "", 0, 0, 0, "", "", "", "", 0, false, "", "", "", "", "", "")
     focusSearchField()
   }
 
@@ -1258,7 +1392,7 @@ export default function HistoryPane(props: HistoryPaneProps) {
     let item = getHistoryItem(index)
     if (item && isTextItem(item)) {
       // Check if the item content has text with line breaks and has at least two lines.
-      let text = item.content
+      let text = getText(item)
       let lines = text.split(/\r?\n/).filter(line => line.trim() !== "")
       if (lines.length > 1) {
         let items = []
@@ -1302,7 +1436,7 @@ export default function HistoryPane(props: HistoryPaneProps) {
       }
     }
     items.forEach(item => {
-      item.content = formatText(item.content, args.operation)
+      setText(item, formatText(getText(item), args.operation))
     })
     await handleEditHistoryItems(items)
   }
@@ -1359,7 +1493,7 @@ export default function HistoryPane(props: HistoryPaneProps) {
 
     let rtf = pasteObject ? getRTF(item) : ""
     let html = pasteObject ? getHTML(item) : ""
-    copyToClipboard(item.content, rtf, html, getImageFileName(item), getFilePath(item), true)
+    copyToClipboard(getText(item), rtf, html, getImageFileName(item), getFilePath(item), true)
 
     setHistory([...getHistoryItems()])
 
@@ -1729,7 +1863,7 @@ export default function HistoryPane(props: HistoryPaneProps) {
         hideAppWindow()
       }
     } else {
-      pasteItemInFrontApp(item.content, "", "", getImageFileName(item), getFilePath(item))
+      pasteItemInFrontApp(getText(item), "", "", getImageFileName(item), getFilePath(item))
     }
   }
 
@@ -1811,6 +1945,10 @@ export default function HistoryPane(props: HistoryPaneProps) {
     renameItemMode = enabled
   }
 
+  function handleThumbnailReady(fileName: string) {
+    emitter.emit("ThumbnailReady", fileName)
+  }
+
   async function handleClipBookArchiveDidImport() {
     await reloadHistory()
     resetFilter()
@@ -1831,8 +1969,7 @@ export default function HistoryPane(props: HistoryPaneProps) {
     setSelectedItemIndices(getSelectedHistoryItemIndices())
   }
 
-  (window as any).addClipboardData = addClipboardData;
-  (window as any).mergeClipboardData = mergeClipboardData;
+  (window as any).onClipsAvailable = handleClipsAvailable;
   (window as any).copyToClipboardAfterMerge = copyToClipboardAfterMerge;
   (window as any).clearHistory = clearHistory;
   (window as any).clearTextOlderThan = clearTextOlderThan;
@@ -1845,6 +1982,7 @@ export default function HistoryPane(props: HistoryPaneProps) {
   (window as any).pasteNextItemToActiveApp = pasteNextItemToActiveApp;
   (window as any).pasteNextRichItemToActiveApp = pasteNextRichItemToActiveApp;
   (window as any).clipBookArchiveDidImport = handleClipBookArchiveDidImport;
+  (window as any).onThumbnailReady = handleThumbnailReady;
 
   if (isHistoryEmpty()) {
     return (
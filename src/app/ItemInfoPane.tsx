@@ -1,6 +1,6 @@
 import '../app.css';
 import {useEffect, useState} from "react";
-import {Clip, ClipType, getFilePath, getHTML, getRTF} from "@/db";
+import {Clip, ClipType, getFilePath, hasHTML, hasRTF} from "@/db";
 import {fileExists, formatDateTime, getHistoryItemById, toBase64Icon} from "@/data";
 import ItemTags from "@/app/ItemTags";
 import {getTags, Tag} from "@/tags";
@@ -22,8 +22,8 @@ export default function ItemInfoPane(props: ItemInfoPaneProps) {
   const {t} = useTranslation()
   const [type, setType] = useState<ClipType>(props.item.type)
   const [content, setContent] = useState<string>(props.item.content)
-  const [rtf, setRtf] = useState<string>(getRTF(props.item))
-  const [html, setHtml] = useState<string>(getHTML(props.item))
+  const [rtf, setRtf] = useState<boolean>(hasRTF(props.item))
+  const [html, setHtml] = useState<boolean>(hasHTML(props.item))
   const [imageWidth, setImageWidth] = useState<number>(props.item.imageWidth)
   const [imageHeight, setImageHeight] = useState<number>(props.item.imageHeight)
   const [imageSizeInBytes, setImageSizeInBytes] = useState<number>(props.item.imageSizeInBytes)
@@ -39,8 +39,8 @@ export default function ItemInfoPane(props: ItemInfoPaneProps) {
   function updateItem(item: Clip) {
     setType(item.type)
     setContent(item.content)
-    setRtf(getRTF(props.item))
-    setHtml(getHTML(props.item))
+    setRtf(hasRTF(props.item))
+    setHtml(hasHTML(props.item))
     setSourceApp(item.sourceApp)
     setFileFolder(item.fileFolder)
     setImageWidth(item.imageWidth)
@@ -88,10 +88,10 @@ export default function ItemInfoPane(props: ItemInfoPaneProps) {
     }
     if (type === ClipType.Text) {
       let result = [t("app.itemInfoPane.text")]
-      if (html.length > 0) {
+      if (html) {
         result.push(t("app.itemInfoPane.html"))
       }
-      if (rtf.length > 0) {
+      if (rtf) {
         result.push(t("app.itemInfoPane.rtf"))
       }
       return result
@@ -1,4 +1,6 @@
 import '../app.css';
+import {useEffect, useState} from "react";
+import {emitter} from "@/actions";
 
 type PreviewFilePaneProps = {
   filePath: string
@@ -8,9 +10,31 @@ type PreviewFilePaneProps = {
 }
 
 export default function PreviewFilePane(props: PreviewFilePaneProps) {
+  const [previewVersion, setPreviewVersion] = useState(0)
+
+  useEffect(() => {
+    // The preview is generated in the background, reload it when its file
+    // is written.
+    function handleThumbnailReadyEvent(fileName: string) {
+      if (fileName === props.imageFileName) {
+        setPreviewVersion(version => version + 1)
+      }
+    }
+
+    emitter.on("ThumbnailReady", handleThumbnailReadyEvent)
+    return () => {
+      emitter.off("ThumbnailReady", handleThumbnailReadyEvent)
+    };
+  }, [props.imageFileName])
+
+  let imageUrl = "clipbook://images/" + props.imageFileName
+  if (previewVersion > 0) {
+    imageUrl += "?v=" + previewVersion
+  }
+
   return (
       <div className="flex flex-grow mx-4 mb-4 items-center justify-center overflow-auto">
-          <img src={"clipbook://images/" + props.imageFileName} className="w-full h-full object-contain"
+          <img src={imageUrl} className="w-full h-full object-contain"
                alt="Application icon"/>
       </div>
   )
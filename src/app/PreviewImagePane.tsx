@@ -1,16 +1,41 @@
 import '../app.css';
+import {useEffect, useRef, useState} from "react";
 import {Clip} from "@/db";
+import {emitter} from "@/actions";
+import {getImageUrl, useElementWidth} from "@/lib/utils";
 
 type PreviewImagePaneProps = {
   item: Clip
 }
 
 export default function PreviewImagePane(props: PreviewImagePaneProps) {
+  const paneRef = useRef<HTMLDivElement>(null)
+  const paneWidth = useElementWidth(paneRef)
+  const [imageVersion, setImageVersion] = useState(0)
+
+  useEffect(() => {
+    // The downscaled copies of the image are generated in the background,
+    // request the best fit again when they are written.
+    function handleThumbnailReadyEvent(fileName: string) {
+      if (fileName === props.item.imageFileName) {
+        setImageVersion(version => version + 1)
+      }
+    }
+
+    emitter.on("ThumbnailReady", handleThumbnailReadyEvent)
+    return () => {
+      emitter.off("ThumbnailReady", handleThumbnailReadyEvent)
+    };
+  }, [props.item.imageFileName])
+
   return (
-      <div
+      <div ref={paneRef}
           className="flex flex-grow m-4 mt-0.5 items-center justify-center outline-none resize-none overflow-hidden">
-        <img src={"clipbook://images/" + props.item.imageFileName} alt={props.item.content}
-             className="max-h-full max-w-full object-contain"/>
+        {
+            paneWidth > 0 &&
+            <img src={getImageUrl(props.item.imageFileName, paneWidth, imageVersion)} alt={props.item.content}
+                 className="max-h-full max-w-full object-contain"/>
+        }
       </div>
   )
 }
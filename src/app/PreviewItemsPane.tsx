@@ -1,12 +1,16 @@
 import '../app.css';
-import {useEffect} from "react";
+import {useEffect, useRef} from "react";
 import {Clip, ClipType} from "@/db";
+import {getImageUrl, useElementWidth} from "@/lib/utils";
 
 type PreviewItemsPaneProps = {
   items: Clip[]
 }
 
 export default function PreviewItemsPane(props: PreviewItemsPaneProps) {
+  const paneRef = useRef<HTMLDivElement>(null)
+  const paneWidth = useElementWidth(paneRef)
+
   useEffect(() => {
     let element = document.getElementById("last")
     element?.scrollIntoView({behavior: 'smooth', block: 'nearest'})
@@ -36,14 +40,17 @@ export default function PreviewItemsPane(props: PreviewItemsPaneProps) {
         <div key={index}
              id={last ? "last" : ""}
              className={`flex flex-grow m-0 items-center justify-center outline-none resize-none overflow-hidden ${last ? "" : "border-b border-b-preview-border"}`}>
-          <img src={"clipbook://images/" + item.imageFileName} alt={item.content}
-               className="max-h-full max-w-full object-contain"/>
+          {
+              paneWidth > 0 &&
+              <img src={getImageUrl(item.imageFileName, paneWidth)} alt={item.content}
+                   className="max-h-full max-w-full object-contain"/>
+          }
         </div>
     )
   }
 
   return (
-      <div className="flex flex-col h-full border-t border-t-preview-border overflow-y-auto">
+      <div ref={paneRef} className="flex flex-col h-full border-t border-t-preview-border overflow-y-auto">
         {
           props.items.map((item, index) => (
               <div key={index} className="flex flex-col">
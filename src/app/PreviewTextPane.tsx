@@ -1,11 +1,11 @@
 import '../app.css';
 import React, {useEffect, useRef, useState} from "react";
-import {Clip, getHTML, getRTF} from "@/db";
+import {Clip, getHTML, getRTF, getText} from "@/db";
 import {getClipTypeFromText} from "@/lib/utils";
 import {isShortcutMatch} from "@/lib/shortcuts";
 import {prefGetEditHistoryItemShortcut} from "@/pref";
 import {emitter} from "@/actions";
-import {getHistoryItemById, TextType} from "@/data";
+import {getHistoryItemById, setText, TextType} from "@/data";
 
 type PreviewTextPaneProps = {
   item: Clip
@@ -16,7 +16,7 @@ type PreviewTextPaneProps = {
 
 export default function PreviewTextPane(props: PreviewTextPaneProps) {
   // I need this state to keep caret position when editing the content.
-  const [content, setContent] = useState(props.item.content)
+  const [content, setContent] = useState(() => getText(props.item))
   const [selectedTextType, setSelectedTextType] = useState<TextType>(TextType.Text)
   const textareaRef = useRef<HTMLTextAreaElement>(null)
 
@@ -37,7 +37,7 @@ export default function PreviewTextPane(props: PreviewTextPaneProps) {
   useEffect(() => {
     function handleSwitchTextType(type: TextType) {
       if (type === TextType.Text) {
-        setContent(props.item.content)
+        setContent(getText(props.item))
       }
       if (type === TextType.HTML) {
         setContent(getHTML(props.item))
@@ -68,7 +68,7 @@ export default function PreviewTextPane(props: PreviewTextPaneProps) {
   function applyContentFromTextareaValue(newContent: string) {
     setContent(newContent)
     if (selectedTextType === TextType.Text) {
-      props.item.content = newContent
+      setText(props.item, newContent)
     }
     if (selectedTextType === TextType.HTML) {
       props.item.html = newContent
@@ -190,7 +190,7 @@ export default function PreviewTextPane(props: PreviewTextPaneProps) {
   }
 
   function updateItem() {
-    setContent(props.item.content)
+    setContent(getText(props.item))
     setSelectedTextType(TextType.Text)
   }
 
@@ -4,7 +4,10 @@ import {
   Clip,
   ClipType,
   getAllClips,
+  getHTML,
   getLinkPreviewDetails,
+  getRTF,
+  getText,
   LinkPreviewDetails,
   saveLinkPreviewDetails,
   updateClip
@@ -215,8 +218,8 @@ async function archiveItem(clip: Clip, tags: Tag[], assetRequests: ArchiveAssetR
     kind,
     title: clip.name || undefined,
     text: archiveText(clip),
-    rtfBase64: clip.rtf ? encodeBase64(clip.rtf) : undefined,
-    html: clip.html || undefined,
+    rtfBase64: getRTF(clip) ? encodeBase64(getRTF(clip)) : undefined,
+    html: getHTML(clip) || undefined,
     assetPath: imageAssetPath,
     filePaths: clip.type === ClipType.File ? [clip.filePath || clip.content].filter(Boolean) : [],
     sourceAppName: sourceAppName(clip.sourceApp),
@@ -374,7 +377,7 @@ function archiveText(clip: Clip): string | undefined {
   if (clip.type === ClipType.File) {
     return undefined;
   }
-  return clip.content || undefined;
+  return getText(clip) || undefined;
 }
 
 function archiveContent(archiveItem: ArchiveItem): string {
@@ -394,7 +397,7 @@ function archiveByteSize(clip: Clip): number {
   if (clip.type === ClipType.File) {
     return clip.fileSizeInBytes;
   }
-  return clip.content.length;
+  return getText(clip).length;
 }
 
 function findExistingClip(clips: Clip[], importedClip: Clip): Clip | undefined {
@@ -6,10 +6,10 @@ import {
   deleteClip,
   getAllClips,
   getFilePath, 
-  getHTML,
+  hasHTML,
+  hasRTF,
   getImageFileName,
   getImageText, 
-  getRTF,
   deleteLinkPreviewDetails,
   updateClip,
   getLinkPreviewDetails
@@ -29,6 +29,8 @@ declare const getAllAppsInfo: () => string;
 declare const isFileExists: (filePath: string) => boolean;
 declare const deleteImage: (imageFileName: string) => void;
 declare const deleteLinkImage: (imageFileName: string) => void;
+declare const deleteText: (textFileName: string) => void;
+declare const getCanonicalUrl: (url: string) => string;
 
 export let FinderIcon = "iVBORw0KGgoAAAANSUhEUgAAAEAAAABACAYAAACqaXHeAAAAAXNSR0IArs4c6QAAAHhlWElmTU0AKgAAAAgABAEaAAUAAAABAAAAPgEbAAUAAAABAAAARgEoAAMAAAABAAIAAIdpAAQAAAABAAAATgAAAAAAAACQAAAAAQAAAJAAAAABAAOgAQADAAAAAQABAACgAgAEAAAAAQAAAECgAwAEAAAAAQAAAEAAAAAAlNz6EQAAAAlwSFlzAAAWJQAAFiUBSVIk8AAAE7tJREFUeAHtW3+MXcV1Pve9t7tvf3vttWOv7cU2BhwMgTUBm+IAEYnSQCiISAS1xf8QRUkrov5Q1ShVEuKSpgE1IWmpRJCDKpQUCPmhVkrcJkRAkRswBbdAG0hSAoYYG9sbvOvdfb/7fd/Mue++t/sWx02rSvWs587MmTNnzvnOmblz7302O5VOIXAKgVMI/D9GIDlJ20923ElOd8LDGifMGRl/GUPIy5wbe+C5scbKte9Jij0XWyN3huUaq9C1hH0oiyh7E2vgL4j3upfoTxNp9WrZdo7O2I7VRZst16xWq6k/yeUDX6NuSSJZDZS/YL3RaBxH+Xq9Xn8J9cenp6e/Pz4+vg8D6sgE4oTACBqGaRa7wjDLL//bfed0rdn46aSneGWjYfkklzGyjnoO4jg9uVl6am+DLiOSoGPP8SnbuyUBaomVKjWDKEAH+ILRaFBASJxCCbSUJ9ar1epTBw8e3Llp06bvgqeK/KZANCUHsQtdydM1tvvAH3RtOPvxpLvnahpPxkY9Ggxj5W032ssoLaFF8CITlWaC1wJI1ar9+mDZhrq7rQoWeDT0kSeY2OSHDI8qyYPh4oEsyisUClvWrFnzbYBw18033zyAgdTdIZOc9kuMsXZy2qaA7lXfO/KXyeCSP4a8vDUSS6j8AiVtY19wbCzBJ16K1BjyeB2VUsluGa/bWE/eypWqvE9jkuj1NAo4PtrC4Uku+E6AIlJkpcY0rLu7+/zt27dvPXTo0Lf37dtX0dAOl8XQkedXfufVj+eHV3yyEcNV4UhnshellgEjoS1RMY5JYDSuYBQzirhsOL5WtzXVX9hjF/cBh5rNlavi9SjRMgEYORiriMEQLQGGvIwm4hGITNtBm546du+qVas+hGFlZGo9L4XR88gCND/65R9syw+95U9oQFKDERQRs4c1l0EwkVxQiKEewz2dEm2Nx6qUIexnvVqzq4dr1qg1rAowvI9lkBaAdeOppujsjzyueks7zj8wOHTj3r17rwJPAXm+l0BcDIDu7nUTn8QenaenlBpAPq5nKk3vyqMAgW0aLBq9HvcHp1NxAuP9lJdUSnbNWBfEYxau/QyU5G3Uw91AU8JgphYwQMvuGYEhyon86zec/mnQu5EXtHUhIpHKj37m3rOsp/9yekphTIOpSTSSpVDHRKSTRzSCwcmjsSl/9IoDkuBWtzE3Z5uGitr8CEJ7ckCc7m3Kz4LCftclSyetp6dn8+7du7eBhfsdbWtJnQAo5NddeCVcEvpjANAYz26wgyKjCQ7BiMtFNAxhSZoygSKtUrGrlwZDcPuSQfI6wWN/1DUrI3SEpUJ6O08Ww+y409affgXGLrgMSGxP1LCQDC69SJ7XRJhKioVJZTyYuPq5K8lA1H1SCYQd4gOEooPV+xNEU6NcsitWhvB377cb1KoYBHBJ+KaniErgj7AhUhsmyYCuvoGyHBrouxBdvxwAuXzXOoUvBTPcUYSdNxgCc8Nk1IlrPu740iIaTQ4LyxhknubYETw4ho35nCWDOvmF9R8ONgITSntKQQONxnkP6/RJejAiIJAf+EMUOQhd3T3jkHdCAFA+c95yhVFtfhFxgpCZXZPxzoaYxwUTEgSWJHG/iMaKgM1TmsaNLsGmetlIDH/U6UUBI2ZKgwpxzyCpBQRFYmCk8eojqJiPGijplhj7QM/n86OgYxJZQPsiY0BFY9ouGJbrr+sWRwPDSFglg2lzKoE0tDW57KB89ssMdASvKOypMXjrlTm7ZCnCF4Aw/IOBYZzkZIyXMMqD4ZSYehw0rXnw8pwABmdVyZZHAPr70CQA81KnPSDXqCW5pIBJBQJKzJxQsRjSKdoCIyifBUKbo6ZD6KPUcwLvKISuXLFLVvamR9+sVhG2LCmtUw6NTueOXic4NDabAqigMBpy+R7WYs6yLYwKOSAzr1sgZ6SHqyhhAOstGU0aW/n6Z6364U1WfeDPwyEneoy8OhO48Wiv767YSBHHC9wKU0UhR8uA45C9LjLbSHd84fP2a1vfrtI3Q+/nGM+MLKlNMS4vACA52cuCYQEGAJrvTRlphAAMAgUAOqUoAUGq/t1fWb5assp37gwE0uMBSrdGep4A4pa3ZQAKIpJ0AMooSaU9tcwHIufadfddODKX7J6v7AI+ATyOcSOlDwUgMjx5n7fbyyZnew8NkMIoUfcI0K2NfaRlj8dYHgMDeACDgerDpiheymCKY3j/P3c4rH96iilVnHUGeNNrLXXyc44KZKR8WhBxTBzr0dMOoiZru3QGgIoH/VqHREPSPm+Dq69/IBjjNB+PUidASiqVbctot7yvx9/odVeWyjO5gWqwDVCYfA5vu7HZSFC9DUgNXuDSGQBndmM8GhyYLB31/sFhW71uvfUODYfIYT+XQBzn0dBTq9hbl/WG8PcIcM/FOR0MgeAeRjkI2ZxjaHhJCpDzcGgKSqx728sovqXoDACVpxEZg9PdlyK8Dx7jGh96/8esZ3iZLbnuY2EC9teieN09QEC5rreOV0kNAZAaGr27kOeovBvwux/9fRseWWa/c/PvieZ9XnJ8jeeROIalZEb5QbHWa+u9A8sa3V3IS1ffP3uglTW00tsN7QF7+lqMQOCW40YplHkAYmKBfm5cVw0dsS9eNmLTs2WbqxClk0+cL9UHYjR7pDndeVYsW4L3lnYUmS9I4sLrfBBaeP1rJEykoUIV3uG5AG2JpFidDFEqBQOTKvgJLV54nNYfvELPMFFOUx5FBdntpe/sNNLHcDw3Rr0wke8oj3gH4ZTBlDpFrdbLQgehwNHmHD/vsxMqiMeVbKLFsAiTBiHxCpLG18q2cajQco+mYZTG7MZJ4Ri2NJZtHsJEJ0AUSzqy6xA0arbJwqSxYUQgtF0XBUBT8Z4qu4KodLwUiobF12Xk8OSKsS0TuDYrDRvtzclrnW6BPj4rK8iIsrnUJNPbESAoyecBhYA8z37kCKTLbS8XBUBhhxCTMoCYUzFFH6guWiCnfeR3XhFxURtnhOV9iAD+UR6Vy4Q8ed2raV0jg7EE1ZcOJQpkzBWh0FiqwpiiHD0jUNAiaVEAqLQLb10CnLRpdTA3csILabi2Tcy7xdLeAjZDjICCepaPHhIY4PfShzY1WKAvjiVv0CaCArpHoJcur73sCACVbU0IPZCyCnl/lpYFzfvTErt+MR+XAMXHZcR+9yZnIAhsexIoDO9swlglD3s08ASrqHdgKYE5+wSpMZlLRwD8KZC8LR7ODJ5Hxx1AkcJpM3XnoyG9XYnNlNrAhRHCQ4ZzHYclwnFK0XgBE2kEXf1xf+JyxdOBziT8pNbkJVcTzIz6qnYEgKe4sKmE+7sb4Uq5AqLHTTBhaLticVLvFwtkPn/guI0OFGxyctLK5bI2RGqCjxk2ODhoXV08hoSUKg5gPKU0EFSXYBiYiRpFDOavkwY+vy26jGzZEQB5EhugQhHzhw8jqoR12rJ5Zd7GMDQz4cvJ0m0q320f/ubP7PoNdRttHLXq7DE8O+FjCBQdGRmxs895mxWLRYFCm+XFlnkCzQ0QuBFopxEqLLLgCOHCveZkIoB2cGBGEZ+EU4SXpKGf4d6Ipz5NRS2QBJrwCArkCn22f2653fYvB81msRk2BptHCPJ/70n7j89cYaVqTh9JKUO3Sy6RKDNIolqh5iCJFzxc74oAAMdtLDgwDiZTW+oYAXx6841IxtKrNJQTB8mpqOBhTMJNTW+O4BuGn0dCnD9Juizft9ySrkE8Xlcghg8aEMszAkK5cXzSenu68KYIj7vRYsrQcEVW60YYDCUtbJwqqR/GtN6JTgIAKsWZgyKoB9NbjJKR+EQOq2mH+DUOVY+eQEcYkEXRABCKWOckZTc3KF3D+wV6MLtrh/kxB3kJMAXGOqveT8cILPIAPD8eE8d8/JBK/vbUMQKooBLn5rRSljXUYx8fhPS0CII8T3oOl9gvpcgT2yopBy8CFEm6hhq9RgOZaECkqh2JKOgIJEVHrLOZ0l0upqTKnBDz+alTY9sunQGo1RmfhXSaWEm461JPGdKw2Xuu0abTs+MbeI7EJ7gQ1fK4zhKMjmiY5uZjNhPIIcogT23QPZICJXoXfAQnQ+MboY/cdKMou+69X6UiAXwsnV/ACEwfPb+EGh1SrT7X4jkqTkOoP3M0pF6atq7J5638/Z3NdwcU6Xw+hsAwk46kV2wOBgnsQ9sfkWUQ6UiKCBoiz5vddecX7ac/+bHNzMyIRg/TWHqdJflIY9vHh9r8aycAeO8IyQ1hy41gHXS+Exy69ku29nT8TOiZ+6y850tNw91YL9vlxLbeK5KHCbQKPpmH5RaNiQbJMNQfuO9r9vX7vmr46mufuvVzKShapgQ7RpvAQt1BCxPMv3YCIHC6kgxB1H2Dc3AovDa62d6Y+CN76znnWf2xz1vpB38KoNwijIFPmDwsfWyYIHhXdc6FhN9IpUbIGBqE5cZX6Hfecbvdcfuf2VmbN9sHP/JRO3PT2Rrj3mfDI0D1GDWLgdB5D6AN6Q9oqB1NUYxRdjAMa5a3r+mVl9vBrqJt6ftre2rPLpt58RErvvc2y6+ckELk11hWMsnBodJMBHhqtmJL+6EWZUe0fvTcM/bZnZ9Q2G/d/g77wA032tZt+IGalkRzf3DRLi+0eT+Ka8EZMmVHAJJGrdaohxNeq8AwmjTtslCaExwb2WYvbl5uW4bvsdeeedT233uNFTa+y7rP32HJ2ndg01t4qhbZMHq6hFMi3q7zjPDk3ifswfu/Zv/08EO2enytXXfDb9p177/B1q3f0GISgWCEuSz3OGnhIJXMZGxuqbbDxzYP40tWf+rw00m+OEaxwdhQtoxGw9F1HgBnK4/uthUHd9t/PvuUHXh1vzWKI9az4Z2WH5uwZOlZlhsYE82KtBQyylN4WTJl9UP/br912o/t8Ms/socfedQmjx6xlWNr7NyJCbvs8ncjQ0Y+Dct2VdT2peYgkFirVo+ce+b4ZlQnkd/0nSDjpZGUS68nPT1jqKdG6r4PhXXE5W2QdfTyhMgaOnDN289H3meHhi+3FSv32CXHnrD60Rds/4tP2cv/+CDFLZruhtfWnrbeNp37NsMPG2zi/AvsgrdfaH19/L4Z58tImOcgLYsmA/UrleYOa6iUbPaxtnBcwrR6aWZ/rmv4PLHTQBjM+3p4TKat8UGJthMEJAHDFrCoJn12YOjd9vPhd1lx1WFbcvpPbKL0svVWDlp3+SjOSzOWr81qXA1f4WpJr5ULQ3b2+FK7dGKjrVw9boPDI+rn3I24u6c20AHc5cUBvdhGkkNUCTqTZ65c2Q+SNGVXNrUDIO+DoV6fPvRkrv8t7wvM9DYFNjcU3b7QGU6AVCAuAj4SEzDsHwIJ4MzlRu21Pnyi79umjU5fiuPurp3ejSlN2dYzjtn2i5fbGzMVm8U7RC2xaHxqHOb1s34aAZEn6BuAoFs45sjh159GVfcXkZwJZYAtQ4gM1eMvfPMh2IHfrWIynihQ+g+cvNQwP8ygX7z0CcfEkvVs1trkGPJEuTpUkQ+b4KuTNZ3j07UsSZQWokxzkjW2WToIrHsmn+8DTz+x52E0HQBUm6kTAJWph//ixdrU64/y1qQnQ+72yFKcJdDhBOr3kr/94VNkhs95aCzpninHeVMaVuT+SfAx0pA5Ns3RYKpOmspII47Op47IQ9rU1LFnbvnEx/8NpJbNz/k6AUC0Zqf/9W9ux3fsshtEhTU5vYXPXv51mCXpqSHRwykvjY0vQj0aJBNiXKZ4sRR+eigYxydCjwKVCHHyiI/jCEKkoZkm74+ExkP/8N3PoT6HzJNNEB47WSx6Tym99Mh075lXFvK9q/A7O1oNz+i1F4yVLChEKj0ey0hRO7IEYLgzRr7QiaurwxIZ0q00N2PXTuStrzuPD8k4CrWtbR9LDTirG+xguWbse2X/Sw/e9NvX70J1CpkRQCNa0kIRQAaqxAFTB79y6Z2VIy/cp90fBnBCGsw2xcl4lopD3BkY6m1ZG13kIb8y+UnL/MaA9Bz+u8Hzr8ziGR51ugdR4Uai1UzufW6gzEjiA53OOXrk8D9/aMcHdoJM40vImG1+WjQC4qDG9NNffrw4fmmpMDB2AZQsMPqEv8KQWDE0AQjXLqZRXYaqS3CSxiBAJ/+hZJuCOA7/AIjG1Uq2dnDGLjpjAD8lqul3RGQXn/hpbJgr0GgX4w7yBESjsf/ln33r+t94zx/iZ/OH0DmNvGD4g77oEpCa4OF+UDv+7FefbVSOPdK1bPOKXM/AODqzL27AEg1STSoGzKGrPB1eAKAR+kiWT2CU6pHO387kKm/YtRctwbtB/PaIT4eUDROZeA31oJ4MJw3GY8N7fvfff+uWD+644e65ubkjIHvoh8EgtCefu52ebRNyHo97kQeQB/s3XjXed95N7ywMbTg/1zs8jp8TLcdZv5jkC/3w7IIyg6JuRNagZh2ycdwoW3HuFfvhrWvsOH5Cf2xu/iMtzvflWq1aKpdKk7OzswcOvnbgub0/3PPYF2679UmIoNHHkHn+93X/3wIAcnRe4HJxIPpRZ+b5lP9HiHQeqmJ8ovY/l4LrQ2QytLm+aexxZIY7j5ekedh3NB48HY/C7MumsNCakxJZTsLM3+D9XwCAIND4N/U6eNK0YLimvQtX6GVGAz3uhmu/Rpt9/xvJo4COoadpNPMJeR18aToZADiY45izIX+ysijvZJKHtoORLU9Y3q9K6V+VnBNWPMPoQGRIp6onjMB/AUz+r5rlodoQAAAAAElFTkSuQmCC"
 
@@ -305,7 +307,10 @@ export function isFileItem(item: Clip): boolean {
   return item && item.type === ClipType.File
 }
 
-export function findItem(content: string, imageFileName: string, fileName: string): Clip | undefined {
+export function findItem(content: string,
+                         imageFileName: string,
+                         fileName: string,
+                         textFileName: string = ""): Clip | undefined {
   if (fileName.length > 0) {
     // Content is a file path in this case.
     return findItemByFilePath(content)
@@ -313,9 +318,22 @@ export function findItem(content: string, imageFileName: string, fileName: strin
   if (imageFileName.length > 0) {
     return findItemByImageFileName(imageFileName)
   }
+  if (textFileName.length > 0) {
+    // The stored texts are named by their content.
+    return findItemByTextFileName(textFileName)
+  }
   return findItemByContent(content)
 }
 
+function findItemByTextFileName(textFileName: string): Clip | undefined {
+  for (let i = 0; i < history.length; i++) {
+    if (history[i].textFileName === textFileName) {
+      return history[i]
+    }
+  }
+  return undefined
+}
+
 function findItemByContent(content: string): Clip | undefined {
   for (let i = 0; i < history.length; i++) {
     if (isTextItem(history[i])) {
@@ -480,6 +498,18 @@ export async function trackSequence(item: Clip, isNewItem: boolean = true): Prom
   }
 }
 
+function getCapturedTextType(textType: string): ClipType | undefined {
+  switch (textType) {
+    case "link":
+      return ClipType.Link
+    case "email":
+      return ClipType.Email
+    case "color":
+      return ClipType.Color
+  }
+  return undefined
+}
+
 export async function addHistoryItem(content: string,
                                      sourceAppPath: string,
                                      imageFileName: string,
@@ -494,12 +524,29 @@ export async function addHistoryItem(content: string,
                                      fileSizeInBytes: number,
                                      isFolder: boolean,
                                      rtf: string,
-                                     html: string): Promise<Clip> {
+                                     html: string,
+                                     rtfFileName: string = "",
+                                     htmlFileName: string = "",
+                                     textFileName: string = "",
+                                     textType: string = ""): Promise<Clip> {
   let type = getClipType(content, imageFileName, filePath)
+  // The app classifies the whole text, the content might only be its beginning.
+  if (type !== ClipType.Image && type !== ClipType.File) {
+    type = getCapturedTextType(textType) ?? type
+  }
   let item = new Clip(type, content, sourceAppPath)
   item.content = content
   item.rtf = rtf
   item.html = html
+  if (rtfFileName) {
+    item.rtfFileName = rtfFileName
+  }
+  if (htmlFileName) {
+    item.htmlFileName = htmlFileName
+  }
+  if (textFileName) {
+    item.textFileName = textFileName
+  }
   item.imageFileName = imageFileName
   item.filePath = filePath
   item.filePathFileName = filePathFileName
@@ -521,7 +568,68 @@ export async function addHistoryItem(content: string,
   return item
 }
 
-export async function deleteItemImages(item: Clip) {
+// Attaches the text recognized in the image to the clip with the given
+// image file name or file path. The text comes from the clip log after the
+// clip, so the clip is missing only if it has been deleted or merged since.
+export async function setImageText(fileName: string, text: string): Promise<boolean> {
+  const item = findItemByImageFileName(fileName) || findItemByFilePath(fileName)
+  if (!item) {
+    return false
+  }
+  item.imageText = text
+  await updateHistoryItem(item.id!, item)
+  return true
+}
+
+// Replaces the whole text of the item. The stored large text is deleted,
+// so the item keeps the new text as its content.
+export function setText(item: Clip, text: string) {
+  if (item.textFileName) {
+    deleteText(item.textFileName)
+    item.textFileName = undefined
+  }
+  item.content = text
+}
+
+// The canonical URLs of the links by their URL, so each link goes through
+// the bridge once and not on every delete.
+const canonicalUrls = new Map<string, string>()
+
+function getLinkCanonicalUrl(url: string): string {
+  let canonicalUrl = canonicalUrls.get(url)
+  if (canonicalUrl === undefined) {
+    canonicalUrl = getCanonicalUrl(url)
+    canonicalUrls.set(url, canonicalUrl)
+  }
+  return canonicalUrl
+}
+
+// Returns the canonical URLs of the links in the history. The links pointing
+// to the same page share the link preview, so it's only deleted with the last
+// of them. A bulk delete collects them once for all the deleted items.
+function getHistoryLinkUrls(): Set<string> {
+  const urls = new Set<string>()
+  for (const clip of history) {
+    if (clip.type === ClipType.Link) {
+      urls.add(getLinkCanonicalUrl(clip.content))
+    }
+  }
+  return urls
+}
+
+// Releases the texts stored for a captured clip that is not added to the
+// history, e.g. a copy of an existing item, which keeps its own references.
+export function deleteCapturedTexts(rtfFileName: string, htmlFileName: string, textFileName: string) {
+  for (const fileName of [rtfFileName, htmlFileName, textFileName]) {
+    if (fileName) {
+      deleteText(fileName)
+    }
+  }
+}
+
+// The item must be removed from the history. The history link URLs are
+// collected when they are not given.
+export async function deleteItemImages(item: Clip, historyLinkUrls?: Set<string>) {
   // Delete the image and thumbnail files.
   if (item.type === ClipType.Image) {
     if (item.imageFileName) {
@@ -539,9 +647,25 @@ export async function deleteItemImages(item: Clip) {
       deleteImage(item.filePathThumbFileName)
     }
   }
+  // Delete the stored rich text.
+  if (item.rtfFileName) {
+    deleteText(item.rtfFileName)
+  }
+  if (item.htmlFileName) {
+    deleteText(item.htmlFileName)
+  }
+  if (item.textFileName) {
+    deleteText(item.textFileName)
+  }
   // Delete the link preview images.
   if (item.type === ClipType.Link) {
     const url = item.content
+    const canonicalUrl = getLinkCanonicalUrl(url)
+    const linkUrls = historyLinkUrls ?? getHistoryLinkUrls()
+    if (linkUrls.has(canonicalUrl)) {
+      return
+    }
+    canonicalUrls.delete(url)
     const details = await getLinkPreviewDetails(url)
     if (details?.imageFileName) {
       deleteLinkImage(details.imageFileName)
@@ -575,22 +699,26 @@ export async function clear(keepFavorites: boolean): Promise<Clip[]> {
   if (keepFavorites) {
     let favorites = getFavoriteItems()
     if (favorites.length > 0) {
-      for (const clip of history) {
+      const clips = history
+      history = favorites
+      const linkUrls = getHistoryLinkUrls()
+      for (const clip of clips) {
         if (!isFavoriteOrTagged(clip)) {
-          await deleteItemImages(clip)
+          await deleteItemImages(clip, linkUrls)
           await deleteClip(clip.id!)
         }
       }
-      history = favorites
       requestHistoryUpdate()
       return getHistoryItems()
     }
   }
   // Delete the images and link preview images.
-  for (const clip of history) {
-    await deleteItemImages(clip)
-  }
+  const clips = history
   history = []
+  const linkUrls = new Set<string>()
+  for (const clip of clips) {
+    await deleteItemImages(clip, linkUrls)
+  }
   requestHistoryUpdate()
   await deleteAllClips()
   return getHistoryItems()
@@ -847,6 +975,10 @@ export async function updateHistoryItemTypes(): Promise<boolean> {
   let historyUpdated = false
   for (let i = 0; i < history.length; i++) {
     let clip = history[i];
+    // The large text was classified by the app as a whole when captured.
+    if (clip.textFileName) {
+      continue
+    }
     let oldType = clip.type;
     let newType = getClipType(clip.content, getImageFileName(clip), getFilePath(clip))
     clip.type = newType
@@ -955,10 +1087,10 @@ export function isFilterActive(): boolean {
 export function getSelectedItemTextTypes(item: Clip | undefined): TextType[] {
   if (item && item.type === ClipType.Text) {
     let types: TextType[] = [TextType.Text]
-    if (getHTML(item).length > 0) {
+    if (hasHTML(item)) {
       types.push(TextType.HTML)
     }
-    if (getRTF(item).length > 0) {
+    if (hasRTF(item)) {
       types.push(TextType.RTF)
     }
     return types
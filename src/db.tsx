@@ -1,5 +1,8 @@
 import Dexie, { Table } from "dexie";
 
+declare const getCanonicalUrl: (url: string) => string;
+declare const readText: (textFileName: string) => string;
+
 export enum ClipType {
   Text,
   Link,
@@ -56,6 +59,11 @@ export class Clip {
   fileFolder: boolean = false;
   rtf: string = "";
   html: string = "";
+  // The large rich text is stored in a file and read when it's needed.
+  rtfFileName?: string;
+  htmlFileName?: string;
+  // The large text is stored in a file and the content is its beginning.
+  textFileName?: string;
   sequenceId?: number;
   sequenceOrder?: number;
 
@@ -109,19 +117,34 @@ export async function deleteAllClips() {
   await db.history.clear();
 }
 
+// The link previews are stored by the canonical URL, so the links that point
+// to the same page, e.g. "HTTPS://X.com/a/" and "https://x.com/a?utm_source=y",
+// share the same preview. The rows saved before are stored by the original URL.
+function getLinkPreviewKeys(url: string): string[] {
+  const canonicalUrl = getCanonicalUrl(url);
+  return canonicalUrl === url ? [url] : [canonicalUrl, url];
+}
+
 export async function saveLinkPreviewDetails(details: LinkPreviewDetails) {
-  await db.linkPreviews.where("url").equals(details.url).delete();
-  await db.linkPreviews.add(details);
+  const keys = getLinkPreviewKeys(details.url);
+  await db.linkPreviews.where("url").anyOf(keys).delete();
+  await db.linkPreviews.add({...details, url: keys[0]});
 }
 
 export async function deleteLinkPreviewDetails(url: string) {
-  await db.linkPreviews.where("url").equals(url).delete();
+  await db.linkPreviews.where("url").anyOf(getLinkPreviewKeys(url)).delete();
 }
 
 export async function getLinkPreviewDetails(
   url: string,
 ): Promise<LinkPreviewDetails | undefined> {
-  return db.linkPreviews.where("url").equals(url).first();
+  for (const key of getLinkPreviewKeys(url)) {
+    const details = await db.linkPreviews.where("url").equals(key).first();
+    if (details) {
+      return details;
+    }
+  }
+  return undefined;
 }
 
 export function getImageText(item: Clip): string {
@@ -136,10 +159,38 @@ export function getFilePath(item: Clip): string {
   return item && (item.filePath || "");
 }
 
+// Returns the whole text of the item. The stored large text is read every
+// time, so it's never kept in the history.
+export function getText(item: Clip): string {
+  if (item && item.textFileName) {
+    return readText(item.textFileName) || item.content;
+  }
+  return item && (item.content || "");
+}
+
+// Returns the RTF of the item. Like the large text, the stored RTF is read
+// every time, so it's never written back to the history with the item.
 export function getRTF(item: Clip): string {
+  if (item && !item.rtf && item.rtfFileName) {
+    return readText(item.rtfFileName);
+  }
   return item && (item.rtf || "");
 }
 
+// Returns the HTML of the item, the stored HTML is read every time.
 export function getHTML(item: Clip): string {
+  if (item && !item.html && item.htmlFileName) {
+    return readText(item.htmlFileName);
+  }
   return item && (item.html || "");
 }
+
+// Indicates if the item has RTF without reading the stored one.
+export function hasRTF(item: Clip): boolean {
+  return !!item && (!!item.rtf || !!item.rtfFileName);
+}
+
+// Indicates if the item has HTML without reading the stored one.
+export function hasHTML(item: Clip): boolean {
+  return !!item && (!!item.html || !!item.htmlFileName);
+}
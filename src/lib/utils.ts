@@ -2,7 +2,7 @@ import {type ClassValue, clsx} from "clsx"
 import {twMerge} from "tailwind-merge"
 import {ClipType} from "@/db";
 import {prefShouldTreatDigitNumbersAsColor} from "@/pref";
-import {MouseEvent} from "react";
+import {MouseEvent, RefObject, useEffect, useState} from "react";
 import {TextFormatOperation} from "@/data";
 
 export function cn(...inputs: ClassValue[]) {
@@ -114,6 +114,11 @@ export function toCSSColor(str: string): string {
     return getCSSColor(str)
   }
 
+  const rgbaRegex = /^rgba\(\s*(\d{1,3})\s*,\s*(\d{1,3})\s*,\s*(\d{1,3})\s*,\s*([\d.]{1,4})\s*\)$/
+  if (rgbaRegex.test(str)) {
+    return getCSSColor(str)
+  }
+
   const hslRegex = /^hsl\(\s*(\d{1,3})\s*,\s*(\d{1,3})%\s*,\s*(\d{1,3})%\s*\)$/
   if (hslRegex.test(str)) {
     return getCSSColor(str)
@@ -157,3 +162,43 @@ export function formatText(text: string, operation: TextFormatOperation) {
 export function getFileNameFromPath(path: string) {
   return path.replace(/^.*[\\/]/, '')
 }
+
+// The widths of the downscaled copies of the stored images generated by the
+// app, see kImagePyramidLevels in thumbnail_pipeline.h.
+const imagePyramidLevels = [256, 1024]
+
+// Returns the URL of the stored image displayed with the given width in CSS
+// pixels. The app serves the smallest downscaled copy of the image that is
+// not narrower, so a large screenshot is not decoded in full size to be
+// shown in a small pane. The version makes the view reload the image.
+export function getImageUrl(imageFileName: string, displayWidth: number, version: number = 0): string {
+  let params: string[] = []
+  let width = Math.ceil(displayWidth * window.devicePixelRatio)
+  let level = imagePyramidLevels.find(level => level >= width)
+  if (width > 0 && level) {
+    params.push("w=" + level)
+  }
+  if (version > 0) {
+    params.push("v=" + version)
+  }
+  let url = "clipbook://images/" + imageFileName
+  return params.length > 0 ? url + "?" + params.join("&") : url
+}
+
+// Returns the current width of the element in CSS pixels.
+export function useElementWidth(ref: RefObject<HTMLElement>): number {
+  const [width, setWidth] = useState(0)
+
+  useEffect(() => {
+    if (!ref.current) {
+      return
+    }
+    const observer = new ResizeObserver(entries => {
+      setWidth(Math.round(entries[0].contentRect.width))
+    })
+    observer.observe(ref.current)
+    return () => observer.disconnect()
+  }, [ref])
+
+  return width
+}
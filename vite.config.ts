@@ -1,9 +1,38 @@
+import fs from "fs"
 import path from "path"
+import zlib from "zlib"
 import react from "@vitejs/plugin-react"
-import { defineConfig } from "vite"
+import { defineConfig, Plugin } from "vite"
+
+// Writes the brotli and gzip compressed copies of the bundled assets next to
+// the original files, so the app can serve them without compressing at runtime.
+function precompress(): Plugin {
+  return {
+    name: "clipbook-precompress",
+    apply: "build",
+    writeBundle(options, bundle) {
+      const outDir = options.dir ?? path.resolve(__dirname, "dist")
+      for (const fileName of Object.keys(bundle)) {
+        if (!/\.(html|js|css|svg|json)$/.test(fileName)) {
+          continue
+        }
+        const filePath = path.resolve(outDir, fileName)
+        const data = fs.readFileSync(filePath)
+        // Small files do not benefit from compression.
+        if (data.length < 1024) {
+          continue
+        }
+        fs.writeFileSync(filePath + ".br", zlib.brotliCompressSync(data, {
+          params: {[zlib.constants.BROTLI_PARAM_QUALITY]: zlib.constants.BROTLI_MAX_QUALITY},
+        }))
+        fs.writeFileSync(filePath + ".gz", zlib.gzipSync(data, {level: zlib.constants.Z_BEST_COMPRESSION}))
+      }
+    },
+  }
+}
 
 export default defineConfig({
-  plugins: [react()],
+  plugins: [react(), precompress()],
   resolve: {
     alias: {
       "@": path.resolve(__dirname, "./src"),